@@ -0,0 +1,238 @@
+/**
+ * @file frontCoding.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the frontCoding module
+ **/
+
+#include "frontCoding.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+/* === Constants === */
+
+/** @brief Size of the blocks in which spilled runs are read back */
+#define SPILL_BLOCK (1 << 16)
+
+/** @brief Maximum number of bytes of an encoded variable length integer */
+#define VARINT_BYTES (10)
+
+/* === Prototypes === */
+
+/**
+ * @brief Appends value as LEB128 variable length integer at dest.
+ * @return The number of bytes written.
+ */
+static size_t putVarint(unsigned char *dest, size_t value);
+
+/**
+ * @brief Makes the next block of a spilled run available at cursor->pos.
+ * @return 0 on success, -1 if the run is exhausted or on a read error.
+ */
+static int refill(struct RunCursor *cursor);
+
+/**
+ * @brief Decodes a variable length integer at the position of the cursor.
+ * @return 0 on success, -1 otherwise.
+ */
+static int getVarint(struct RunCursor *cursor, size_t *value);
+
+/**
+ * @brief Copies the next n bytes of the run to dest.
+ * @return 0 on success, -1 otherwise.
+ */
+static int getBytes(struct RunCursor *cursor, char *dest, size_t n);
+
+
+/* === Implementations === */
+
+static size_t putVarint(unsigned char *dest, size_t value)
+{
+	size_t n = 0;
+
+	while (value >= 0x80) {
+		dest[n++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	dest[n++] = (unsigned char)value;
+	return n;
+}
+
+int encodeRun(struct FrontCodedRun *run, char **lines, size_t count, FILE *spill)
+{
+	size_t capacity = 0;
+	size_t previousLength = 0;
+	const char *previous = "";
+
+	memset(run, 0, sizeof *run);
+	run->count = count;
+
+	for (size_t i = 0; i < count; i++) {
+		size_t length = strlen(lines[i]);
+		size_t shared = 0;
+		size_t limit = (length < previousLength) ? length : previousLength;
+
+		while (shared < limit && lines[i][shared] == previous[shared]) {
+			shared++;
+		}
+		if (run->size + 2 * VARINT_BYTES + (length - shared) > capacity) {
+			unsigned char *grown;
+			capacity = 2 * capacity + 2 * VARINT_BYTES + (length - shared);
+			if ( (grown = realloc(run->data, capacity)) == NULL) {
+				freeRun(run);
+				return -1;
+			}
+			run->data = grown;
+		}
+		run->size += putVarint(run->data + run->size, shared);
+		run->size += putVarint(run->data + run->size, length - shared);
+		(void) memcpy(run->data + run->size, lines[i] + shared, length - shared);
+		run->size += length - shared;
+		run->rawSize += length + 1;
+
+		previous = lines[i];
+		previousLength = length;
+	}
+
+	if (spill != NULL) {
+		if (fseeko(spill, 0, SEEK_END) != 0 || (run->offset = ftello(spill)) < 0 ||
+		    fwrite(run->data, 1, run->size, spill) != run->size || fflush(spill) != 0) {
+			freeRun(run);
+			return -1;
+		}
+		free(run->data);
+		run->data = NULL;
+		run->spill = spill;
+	} else if (run->size < capacity && run->size > 0) {
+		/* give back the slack of the geometric growth */
+		unsigned char *shrunk = realloc(run->data, run->size);
+		if (shrunk != NULL) {
+			run->data = shrunk;
+		}
+	}
+	return 0;
+}
+
+void freeRun(struct FrontCodedRun *run)
+{
+	free(run->data);
+	run->data = NULL;
+}
+
+int openCursor(struct RunCursor *cursor, const struct FrontCodedRun *run)
+{
+	memset(cursor, 0, sizeof *cursor);
+	cursor->run = run;
+	cursor->remaining = run->count;
+
+	if (run->spill != NULL) {
+		if ( (cursor->block = malloc(SPILL_BLOCK)) == NULL) {
+			return -1;
+		}
+		cursor->next = run->offset;
+		cursor->last = run->offset + (off_t)run->size;
+		cursor->pos = cursor->end = cursor->block;
+	} else {
+		cursor->pos = run->data;
+		cursor->end = run->data + run->size;
+	}
+	return 0;
+}
+
+static int refill(struct RunCursor *cursor)
+{
+	const struct FrontCodedRun *run = cursor->run;
+	size_t n;
+	ssize_t r;
+
+	if (run->spill == NULL || cursor->next >= cursor->last) {
+		errno = EINVAL;
+		return -1;
+	}
+	n = (cursor->last - cursor->next < SPILL_BLOCK) ? (size_t)(cursor->last - cursor->next) : SPILL_BLOCK;
+	do {
+		r = pread(fileno(run->spill), cursor->block, n, cursor->next);
+	} while (r < 0 && errno == EINTR);
+	if (r <= 0) {
+		return -1;
+	}
+	cursor->next += r;
+	cursor->pos = cursor->block;
+	cursor->end = cursor->block + r;
+	return 0;
+}
+
+static int getVarint(struct RunCursor *cursor, size_t *value)
+{
+	unsigned int shift = 0;
+
+	*value = 0;
+	for (int i = 0; i < VARINT_BYTES; i++) {
+		if (cursor->pos == cursor->end && refill(cursor) != 0) {
+			return -1;
+		}
+		unsigned char b = *cursor->pos++;
+		*value |= (size_t)(b & 0x7f) << shift;
+		if ((b & 0x80) == 0) {
+			return 0;
+		}
+		shift += 7;
+	}
+	errno = EINVAL;
+	return -1;
+}
+
+static int getBytes(struct RunCursor *cursor, char *dest, size_t n)
+{
+	while (n > 0) {
+		if (cursor->pos == cursor->end && refill(cursor) != 0) {
+			return -1;
+		}
+		size_t available = (size_t)(cursor->end - cursor->pos);
+		size_t chunk = (n < available) ? n : available;
+		(void) memcpy(dest, cursor->pos, chunk);
+		cursor->pos += chunk;
+		dest += chunk;
+		n -= chunk;
+	}
+	return 0;
+}
+
+int nextLine(struct RunCursor *cursor)
+{
+	size_t shared, suffix;
+
+	if (cursor->remaining == 0) {
+		return 0;
+	}
+	if (getVarint(cursor, &shared) != 0 || getVarint(cursor, &suffix) != 0) {
+		return -1;
+	}
+	if (shared + suffix + 1 > cursor->capacity) {
+		size_t capacity = 2 * (shared + suffix + 1);
+		char *grown = realloc(cursor->line, capacity);
+		if (grown == NULL) {
+			return -1;
+		}
+		cursor->line = grown;
+		cursor->capacity = capacity;
+	}
+	/* the shared prefix is still in place from the previous line */
+	if (getBytes(cursor, cursor->line + shared, suffix) != 0) {
+		return -1;
+	}
+	cursor->line[shared + suffix] = '\0';
+	cursor->remaining--;
+	return 1;
+}
+
+void closeCursor(struct RunCursor *cursor)
+{
+	free(cursor->block);
+	free(cursor->line);
+	cursor->block = NULL;
+	cursor->line = NULL;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file frontCoding.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Module for storing sorted runs of lines front-coded (prefix-compressed).
+ * @details Every line of a run is stored as the length of the prefix it shares with its predecessor, the
+ * length of the remaining suffix (both as variable length integers) and the suffix itself. Sorted lines
+ * of similar content, e.g. log files, share long prefixes and shrink considerably. A run is kept either
+ * in memory or in a spill file and is decoded lazily, one line at a time, through a struct RunCursor.
+ **/
+
+#ifndef FRONTCODING_H
+#define FRONTCODING_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+/**
+ * @brief A front-coded run of lines
+ */
+struct FrontCodedRun
+{
+	unsigned char *data;	/**< The encoded run, NULL if it has been spilled */
+	size_t size;		/**< Size of the encoded run in bytes */
+	size_t count;		/**< Number of lines in the run */
+	size_t rawSize;		/**< Size of the lines including a terminator each, before encoding */
+	FILE *spill;		/**< The spill file the run has been written to, NULL if it is kept in memory */
+	off_t offset;		/**< Offset of the run inside the spill file */
+};
+
+/**
+ * @brief A cursor decoding a front-coded run line by line
+ */
+struct RunCursor
+{
+	const struct FrontCodedRun *run;	/**< The run being decoded */
+	unsigned char *block;	/**< Read buffer, only used for spilled runs */
+	const unsigned char *pos;	/**< Next byte to decode */
+	const unsigned char *end;	/**< End of the bytes available at pos */
+	off_t next;		/**< Offset of the next block to read from the spill file */
+	off_t last;		/**< End of the run inside the spill file */
+	size_t remaining;	/**< Number of lines not decoded yet */
+	char *line;		/**< The current line, valid after nextLine returned 1 */
+	size_t capacity;	/**< Allocated size of line */
+};
+
+/**
+ * @brief Front-codes a sorted array of lines into a run.
+ * @details The lines themselves are not changed and may be freed afterwards.
+ * @param *run The run to fill.
+ * @param **lines The lines, in the order they shall be decoded.
+ * @param count The number of lines.
+ * @param *spill If not NULL, the encoded run is appended to this file instead of being kept in memory.
+ * @return A value different from 0 if an error occurs, 0 otherwise.
+ */
+int encodeRun(struct FrontCodedRun *run, char **lines, size_t count, FILE *spill);
+
+/**
+ * @brief Frees the memory of a run. A spill file is not closed.
+ * @param *run The run.
+ */
+void freeRun(struct FrontCodedRun *run);
+
+/**
+ * @brief Prepares a cursor for decoding a run from its beginning.
+ * @param *cursor The cursor.
+ * @param *run The run to decode.
+ * @return A value different from 0 if an error occurs, 0 otherwise.
+ */
+int openCursor(struct RunCursor *cursor, const struct FrontCodedRun *run);
+
+/**
+ * @brief Decodes the next line of the run into cursor->line.
+ * @param *cursor The cursor.
+ * @return 1 if a line has been decoded, 0 at the end of the run, -1 on error.
+ */
+int nextLine(struct RunCursor *cursor);
+
+/**
+ * @brief Frees the resources of a cursor.
+ * @param *cursor The cursor.
+ */
+void closeCursor(struct RunCursor *cursor);
+
+#endif /* FRONTCODING_H */
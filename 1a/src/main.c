@@ -9,6 +9,12 @@
  **/
 
 #include "bufferedFileRead.h"
+#include "partition.h"
+#include "sampleSort.h"
+#include "recordSort.h"
+#include "parallelWrite.h"
+#include "runSort.h"
+#include "sortDaemon.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,9 +22,34 @@
 #include <stdarg.h>
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <setjmp.h>
+#include <malloc.h>
 
 /* === Constants === */
 #define INPUT_LINE_LENGTH (1024)	// 1022 without newline and \0
+#define USAGE "USAGE: %s [-r] [-o file] [--partitions N --output-prefix P | --workers K |\n" \
+	"\t--record-size N [--key-offset O --key-len L] | --run-size N [--spill]] [file1] ...\n" \
+	"       %s --daemon SOCKET"
+
+/** @brief The daemon keeps up to this many bytes of freed heap memory for the next jobs */
+#define DAEMON_HEAP_RESERVE (256 * 1024 * 1024)
+
+/** @brief getopt_long(3) return values of the options without a short form */
+enum LongOption
+{
+	optPartitions = 256,	/**< --partitions N */
+	optOutputPrefix,	/**< --output-prefix P */
+	optWorkers,		/**< --workers K */
+	optRecordSize,		/**< --record-size N */
+	optKeyOffset,		/**< --key-offset O */
+	optKeyLength,		/**< --key-len L */
+	optRunSize,		/**< --run-size N */
+	optSpill,		/**< --spill */
+	optDaemon		/**< --daemon SOCKET */
+};
 
 /* === Type Definitions === */
 /**
@@ -47,17 +78,140 @@ static enum Direction sortingDirection = ascending;
  */
 static struct Buffer *buffer; 
 
+/**
+ * @brief number of range partitions to write, 0 if the output goes to stdout
+ */
+static size_t partitions = 0;
+
+/**
+ * @brief the prefix of the partition output files
+ */
+static char *outputPrefix = NULL;
+
+/**
+ * @brief number of worker processes for the sample sort, 0 if the input is sorted by this process
+ */
+static size_t workers = 0;
+
+/**
+ * @brief layout of the binary records, recordSize is 0 if the input consists of text lines
+ */
+static struct RecordSpec records = {0, 0, 0};
+
+/**
+ * @brief 1 if --key-len was given, otherwise the key reaches until the end of the record
+ */
+static int keyLengthSet = 0;
+
+/**
+ * @brief file the sorted output is written to (-o), NULL for stdout
+ */
+static char *outputFile = NULL;
+
+/**
+ * @brief number of lines per front-coded run, 0 if the whole input is sorted at once
+ */
+static size_t runSize = 0;
+
+/**
+ * @brief 1 if the front-coded runs are spilled to a temporary file instead of being kept in memory
+ */
+static int spillRuns = 0;
+
+/**
+ * @brief the socket to listen on as daemon (--daemon), NULL for a normal invocation
+ */
+static char *daemonSocket = NULL;
+
+/**
+ * @brief 1 while the daemon runs a job: errors must not terminate the process then
+ */
+static int inDaemonJob = 0;
+
+/**
+ * @brief the state bail_out jumps back to if an error occurs during a daemon job
+ */
+static jmp_buf jobAbort;
+
+/**
+ * @brief the input file being read by the job, NULL if none
+ */
+static FILE *jobInput = NULL;
+
+/**
+ * @brief the output file opened by the job for -o in runs, NULL if none
+ */
+static FILE *jobOutput = NULL;
+
+/**
+ * @brief the output file opened by the job for -o with records, -1 if none
+ */
+static int jobOutputFd = -1;
+
+/**
+ * @brief the long options understood by mysort
+ */
+static const struct option longOptions[] = {
+	{"partitions", required_argument, NULL, optPartitions},
+	{"output-prefix", required_argument, NULL, optOutputPrefix},
+	{"workers", required_argument, NULL, optWorkers},
+	{"record-size", required_argument, NULL, optRecordSize},
+	{"key-offset", required_argument, NULL, optKeyOffset},
+	{"key-len", required_argument, NULL, optKeyLength},
+	{"run-size", required_argument, NULL, optRunSize},
+	{"spill", no_argument, NULL, optSpill},
+	{"daemon", required_argument, NULL, optDaemon},
+	{NULL, 0, NULL, 0}
+};
+
 
 /* === Function Prototypes === */
 
 /**
- * @brief terminate program on program error
- * @details global variables: programName, buffer, errno
+ * @brief terminate program on program error, or only the current job when running as daemon
+ * @details global variables: programName, buffer, errno, inDaemonJob, jobAbort, jobInput, jobOutput,
+ * jobOutputFd
  * @param exitcode exit code
  * @param fmt format string
  */
 static void bail_out(int exitcode, const char *fmt, ...);
 
+/**
+ * @brief frees the lines of the input buffer. The buffer itself is kept for the next job of a daemon.
+ * @details global variables: buffer, inDaemonJob
+ */
+static void releaseBuffer(void);
+
+/**
+ * @brief closes the files the job still has open after an error, a daemon would run out of descriptors
+ * @details global variables: jobInput, jobOutput, jobOutputFd
+ */
+static void closeJobFiles(void);
+
+/**
+ * @brief resets all options to their defaults before the arguments of a job are parsed
+ * @details global variables: all option variables
+ */
+static void resetOptions(void);
+
+/**
+ * @brief parses the arguments and sorts accordingly, i.e. one invocation of mysort
+ * @details global variables: all above defined
+ * @param argc The argument counter.
+ * @param argv The argument vector.
+ * @return EXIT_SUCCESS, if no error occurs. Otherwise bail_out is called.
+ */
+static int runJob(int argc, char **argv);
+
+/**
+ * @brief runs one job received by the daemon, catching its errors
+ * @details global variables: programName, inDaemonJob, jobAbort
+ * @param argc The argument counter of the client.
+ * @param argv The argument vector of the client.
+ * @return The exit code of the job.
+ */
+static int daemonJob(int argc, char **argv);
+
 /**
  * @brief Prints the first "size" strings of a given char** array to stdout, where size must not 
  * be greater than the size of the array. 
@@ -77,6 +231,16 @@ static void printStringArray(char **arr, size_t size);
  **/
 static int compareStrings(const void *a, const void *b);
 
+/**
+ * @brief parses a number given as option argument, exits with a usage message if it is invalid
+ * @details global variables: programName
+ * @param *arg the option argument
+ * @param min the minimum value allowed
+ * @param max the maximum value allowed
+ * @return the parsed number
+ */
+static size_t parseCount(const char *arg, long min, long max);
+
 
 /* === Implementations === */
 
@@ -95,10 +259,74 @@ static void bail_out(int exitcode, const char *fmt, ...)
     }
     (void) fprintf(stderr, "\n");
 
-    freeBuffer(buffer);
+    releaseBuffer();
+    closeJobFiles();
+    if (inDaemonJob) {
+        longjmp(jobAbort, exitcode);
+    }
     exit(exitcode);
 }
 
+static void releaseBuffer(void)
+{
+	if (buffer == NULL) {
+		return;
+	}
+	if (!inDaemonJob) {
+		freeBuffer(buffer);
+		free(buffer);
+		buffer = NULL;
+		return;
+	}
+	clearBuffer(buffer);
+}
+
+static void closeJobFiles(void)
+{
+	if (jobInput != NULL) {
+		(void) fclose(jobInput);
+		jobInput = NULL;
+	}
+	if (jobOutput != NULL) {
+		(void) fclose(jobOutput);
+		jobOutput = NULL;
+	}
+	if (jobOutputFd >= 0) {
+		(void) close(jobOutputFd);
+		jobOutputFd = -1;
+	}
+}
+
+static void resetOptions(void)
+{
+	sortingDirection = ascending;
+	partitions = 0;
+	outputPrefix = NULL;
+	workers = 0;
+	records.recordSize = records.keyOffset = records.keyLength = 0;
+	keyLengthSet = 0;
+	outputFile = NULL;
+	runSize = 0;
+	spillRuns = 0;
+	daemonSocket = NULL;
+	optind = 0;	/* getopt has to start over for every job of a daemon */
+}
+
+static int daemonJob(int argc, char **argv)
+{
+	char *daemonName = programName;
+	int status;
+
+	inDaemonJob = 1;
+	programName = argv[0];
+	if ( (status = setjmp(jobAbort)) == 0) {
+		status = runJob(argc, argv);
+	}
+	programName = daemonName;
+	inDaemonJob = 0;
+	return status;
+}
+
 static void printStringArray(char **arr, size_t size) 
 {
 	for(int i=0; i < size; i++) {
@@ -114,39 +342,163 @@ static int compareStrings(const void *a, const void *b)
 	return sortingDirection * strcmp(*ia,*ib);
 }
 
+static size_t parseCount(const char *arg, long min, long max)
+{
+	char *endptr;
+	long value;
 
-/**
- * @brief Entry point of mysort. Argument and option parsing. Calls the sorting method.
- * @details global variables: prograName, buffer, sortingDirection
- * @param argc The argument counter.
- * @param argv The argument vector.
- * @return EXIT_SUCCESS, if no error occurs. Otherwise the programm is stopped via 
- * exit(EXIT_FAILURE).
-ar**/
-int main(int argc, char **argv) 
+	errno = 0;
+	value = strtol(arg, &endptr, 10);
+	if (errno != 0 || endptr == arg || *endptr != '\0' || value < min || value > max) {
+		errno = 0;
+		bail_out(EXIT_FAILURE, "Invalid number \"%s\" (allowed: %ld-%ld)", arg, min, max);
+	}
+	return (size_t)value;
+}
+
+
+static int runJob(int argc, char **argv) 
 {
-	programName = argv[0];
- 	
-	/* initialize the buffer */
-	if( (buffer = malloc(sizeof (struct Buffer))) == NULL) {
-		bail_out(EXIT_FAILURE, "Buffer initialization failed");
-	};
-	buffer->content = malloc(sizeof (char **));
-	buffer->length = 0;
+	resetOptions();
+
+	/* initialize the buffer, a daemon keeps it from the previous job */
+	if (buffer == NULL) {
+		if( (buffer = calloc(1, sizeof (struct Buffer))) == NULL) {
+			bail_out(EXIT_FAILURE, "Buffer initialization failed");
+		};
+	}
 		
 	/* parse options using getopt */	
 	int c;
-	while ( (c = getopt(argc, argv, "r")) != -1 ) {
+	while ( (c = getopt_long(argc, argv, "ro:", longOptions, NULL)) != -1 ) {
 		switch(c) {
 			case 'r': /* absteigend sortieren */
 				sortingDirection = descending;
 				break;
+			case 'o': /* in Datei schreiben */
+				outputFile = optarg;
+				break;
+			case optPartitions: /* in N Bereiche aufteilen */
+				partitions = parseCount(optarg, 1, MAX_PARTITIONS);
+				break;
+			case optOutputPrefix: /* Praefix der Ausgabedateien */
+				outputPrefix = optarg;
+				break;
+			case optWorkers: /* mit K Prozessen sortieren */
+				workers = parseCount(optarg, 1, MAX_WORKERS);
+				break;
+			case optRecordSize: /* binaere Datensaetze fester Groesse */
+				records.recordSize = parseCount(optarg, 1, MAX_RECORD_SIZE);
+				break;
+			case optKeyOffset: /* Beginn des Schluessels im Datensatz */
+				records.keyOffset = parseCount(optarg, 0, MAX_RECORD_SIZE - 1);
+				break;
+			case optKeyLength: /* Laenge des Schluessels */
+				records.keyLength = parseCount(optarg, 1, MAX_RECORD_SIZE);
+				keyLengthSet = 1;
+				break;
+			case optRunSize: /* in Laeufen von N Zeilen sortieren */
+				runSize = parseCount(optarg, 1, INT_MAX);
+				break;
+			case optSpill: /* Laeufe in temporaere Datei auslagern */
+				spillRuns = 1;
+				break;
+			case optDaemon: /* als Daemon auf SOCKET warten */
+				daemonSocket = optarg;
+				break;
 			case '?': /* ungueltiges Argument */
-				bail_out(EXIT_FAILURE, "USAGE: %s [-r] [file1] ...", programName);
+				bail_out(EXIT_FAILURE, USAGE, programName, programName);
 			default:  /* unmöglich */
 				assert(0);
 		} 
 	}
+	if (daemonSocket != NULL) {
+		if (inDaemonJob || argc != optind || argc != 3) {
+			bail_out(EXIT_FAILURE, "--daemon can not be combined with other arguments\n" USAGE,
+				programName, programName);
+		}
+		/* keep freed memory in the heap, so that the next jobs find it warmed up */
+		(void) mallopt(M_TRIM_THRESHOLD, DAEMON_HEAP_RESERVE);
+		(void) mallopt(M_MMAP_THRESHOLD, DAEMON_HEAP_RESERVE / 8);
+		if (runDaemon(daemonSocket, daemonJob) != 0) {
+			bail_out(EXIT_FAILURE, "Daemon on socket %s failed", daemonSocket);
+		}
+		releaseBuffer();
+		return(EXIT_SUCCESS);
+	}
+	if ((records.recordSize == 0) && (records.keyOffset > 0 || keyLengthSet)) {
+		bail_out(EXIT_FAILURE, "--key-offset and --key-len require --record-size\n" USAGE,
+			programName, programName);
+	}
+	if ((partitions == 0) != (outputPrefix == NULL)) {
+		bail_out(EXIT_FAILURE, "--partitions and --output-prefix must be used together\n" USAGE,
+			programName, programName);
+	}
+	if (spillRuns && runSize == 0) {
+		bail_out(EXIT_FAILURE, "--spill requires --run-size\n" USAGE, programName, programName);
+	}
+	if ((partitions > 0) + (workers > 0) + (records.recordSize > 0) + (runSize > 0) > 1) {
+		bail_out(EXIT_FAILURE, "--partitions, --workers, --record-size and --run-size can not be combined\n"
+			USAGE, programName, programName);
+	}
+
+	if (outputFile != NULL && (partitions > 0 || workers > 0)) {
+		bail_out(EXIT_FAILURE, "-o can not be combined with --partitions or --workers\n" USAGE,
+			programName, programName);
+	}
+
+	if (records.recordSize > 0) {
+		int fd = STDOUT_FILENO;
+		if (!keyLengthSet) {
+			records.keyLength = (records.keyOffset < records.recordSize) ?
+				records.recordSize - records.keyOffset : 0;
+		}
+		if (records.keyLength == 0 || records.keyOffset + records.keyLength > records.recordSize) {
+			bail_out(EXIT_FAILURE, "The key must lie inside the record\n" USAGE, programName, programName);
+		}
+		if (outputFile != NULL &&
+				(fd = jobOutputFd = open(outputFile, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0) {
+			bail_out(EXIT_FAILURE, "open failed on file %s", outputFile);
+		}
+		if (sortRecords(&argv[optind], (size_t)(argc - optind), &records,
+				sortingDirection == descending, fd) != 0) {
+			bail_out(EXIT_FAILURE, "Sorting records of %zu bytes failed", records.recordSize);
+		}
+		jobOutputFd = -1;	/* closed below, even if close fails */
+		if (outputFile != NULL && close(fd) != 0) {
+			bail_out(EXIT_FAILURE, "close failed on file %s", outputFile);
+		}
+		releaseBuffer();
+		return(EXIT_SUCCESS);
+	}
+
+	if (runSize > 0) {
+		FILE *out = stdout;
+		if (outputFile != NULL && (out = jobOutput = fopen(outputFile, "w")) == NULL) {
+			bail_out(EXIT_FAILURE, "fopen failed on file %s", outputFile);
+		}
+		if (sortInRuns(&argv[optind], (size_t)(argc - optind), runSize, spillRuns, out,
+				INPUT_LINE_LENGTH, compareStrings) != 0) {
+			bail_out(EXIT_FAILURE, "Sorting in runs of %zu lines failed", runSize);
+		}
+		/* stdout stays open, a daemon writes the output of its next jobs to it */
+		jobOutput = NULL;
+		if ((outputFile != NULL) ? fclose(out) != 0 : fflush(stdout) != 0) {
+			bail_out(EXIT_FAILURE, "Writing the output failed");
+		}
+		releaseBuffer();
+		return(EXIT_SUCCESS);
+	}
+
+	if (workers > 0) {
+		/* the workers read the input themselves, this process never holds it */
+		if (sampleSortProcesses(&argv[optind], (size_t)(argc - optind), workers,
+				INPUT_LINE_LENGTH, compareStrings) != 0) {
+			bail_out(EXIT_FAILURE, "Sorting with %zu worker processes failed", workers);
+		}
+		releaseBuffer();
+		return(EXIT_SUCCESS);
+	}
 	
 	if(optind < argc) { /* there are files specified via command line arguments */
 		int fileCount = argc - optind;
@@ -158,26 +510,54 @@ int main(int argc, char **argv)
 			
 			path = argv[i + optind];
 			
-			if( (f = fopen(path, "r")) == NULL ) {
+			if( (f = jobInput = fopen(path, "r")) == NULL ) {
 		   		bail_out(EXIT_FAILURE, "fopen failed on file %s", path);
 			}
-			if ( readFile(f, buffer, INPUT_LINE_LENGTH) != 0) {
+			if ( readFile(f, buffer, INPUT_LINE_LENGTH, READ_RAW) != 0) {
 				bail_out(EXIT_FAILURE, "Error while reading file %s", path);
 			};
+			jobInput = NULL;
 			if (fclose(f) != 0) { 
 				bail_out(EXIT_FAILURE, "fclose failed on file %s", path);
 			}
 		}		
 		
 	} else {	/* there are no files --> read from stdin */
-		if ( readFile(stdin, buffer, INPUT_LINE_LENGTH) != 0) {
+		if ( readFile(stdin, buffer, INPUT_LINE_LENGTH, READ_RAW) != 0) {
 			bail_out(EXIT_FAILURE, "Memory allocation error while reading from stdin");
 		};
 	}
 
-	qsort(buffer->content, buffer->length, sizeof(char *), compareStrings);
-	printStringArray(buffer->content, buffer->length);
-	freeBuffer(buffer);
+	if (partitions > 0) {
+		/* no global sort: every partition is sorted and written by its own thread */
+		if (writePartitions(buffer, partitions, outputPrefix, compareStrings) != 0) {
+			bail_out(EXIT_FAILURE, "Writing the partitions with prefix %s failed", outputPrefix);
+		}
+	} else {
+		qsort(buffer->content, buffer->length, sizeof(char *), compareStrings);
+		if (outputFile != NULL) {
+			if (writeLinesParallel(outputFile, buffer->content, buffer->length, 0) != 0) {
+				bail_out(EXIT_FAILURE, "Writing the output to %s failed", outputFile);
+			}
+		} else {
+			printStringArray(buffer->content, buffer->length);
+		}
+	}
+	releaseBuffer();
 	
 	return(EXIT_SUCCESS);
 }
+
+/**
+ * @brief Entry point of mysort. Argument and option parsing. Calls the sorting method.
+ * @details global variables: programName
+ * @param argc The argument counter.
+ * @param argv The argument vector.
+ * @return EXIT_SUCCESS, if no error occurs. Otherwise the programm is stopped via 
+ * exit(EXIT_FAILURE).
+ **/
+int main(int argc, char **argv) 
+{
+	programName = argv[0];
+	return runJob(argc, argv);
+}
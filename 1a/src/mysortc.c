@@ -0,0 +1,166 @@
+/**
+ * @file mysortc.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Thin client of the mysort daemon with exactly the command-line interface of mysort.
+ * @details The arguments, the working directory and the standard file descriptors are passed to the
+ * daemon listening on $MYSORT_SOCKET (default /tmp/mysort.sock), which runs the job as if mysort had been
+ * invoked with them. The exit code of the job becomes the exit code of mysortc.
+ **/
+
+#include "sortDaemon.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* === Global Variables === */
+
+/** @brief program name, "mysortc" by default */
+static char *programName = "mysortc";
+
+/* === Prototypes === */
+
+/**
+ * @brief terminate program on program error
+ * @details global variables: programName, errno
+ * @param fmt format string
+ */
+static void bail_out(const char *fmt);
+
+/**
+ * @brief Connects to the daemon.
+ * @param *path The socket path.
+ * @return The connected socket, exits on error.
+ */
+static int connectDaemon(const char *path);
+
+
+/* === Implementations === */
+
+static void bail_out(const char *fmt)
+{
+	(void) fprintf(stderr, "%s: %s", programName, fmt);
+	if (errno != 0) {
+		(void) fprintf(stderr, ": %s", strerror(errno));
+	}
+	(void) fprintf(stderr, "\n");
+	exit(EXIT_FAILURE);
+}
+
+static int connectDaemon(const char *path)
+{
+	struct sockaddr_un addr;
+	int fd;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		errno = ENAMETOOLONG;
+		bail_out("invalid socket path");
+	}
+	memset(&addr, 0, sizeof addr);
+	addr.sun_family = AF_UNIX;
+	(void) strcpy(addr.sun_path, path);
+
+	if ( (fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		bail_out("socket");
+	}
+	if (connect(fd, (struct sockaddr *)&addr, sizeof addr) < 0) {
+		bail_out("could not connect to the mysort daemon");
+	}
+	return fd;
+}
+
+/**
+ * @brief Program entry point: sends the job to the daemon and waits for its exit code.
+ * @param argc The argument counter.
+ * @param argv The argument vector, passed on unchanged.
+ * @return The exit code of the job or EXIT_FAILURE if the daemon could not be reached.
+ */
+int main(int argc, char **argv)
+{
+	const char *path = getenv(SOCKET_ENV);
+	char cwd[PATH_MAX];
+	char *payload;
+	size_t size;
+	int fd;
+
+	programName = argv[0];
+	if (path == NULL || *path == '\0') {
+		path = DEFAULT_SOCKET;
+	}
+	if (getcwd(cwd, sizeof cwd) == NULL) {
+		bail_out("getcwd");
+	}
+
+	/* payload: cwd '\0' argv[0] '\0' ... argv[argc - 1] '\0' */
+	size = strlen(cwd) + 1;
+	for (int i = 0; i < argc; i++) {
+		size += strlen(argv[i]) + 1;
+	}
+	if (size > MAX_JOB_SIZE) {
+		errno = E2BIG;
+		bail_out("arguments too long");
+	}
+	if ( (payload = malloc(size)) == NULL) {
+		bail_out("malloc");
+	}
+	char *pos = payload;
+	pos = stpcpy(pos, cwd) + 1;
+	for (int i = 0; i < argc; i++) {
+		pos = stpcpy(pos, argv[i]) + 1;
+	}
+
+	fd = connectDaemon(path);
+
+	/* the header carries our stdin, stdout and stderr */
+	struct JobHeader header = { JOB_MAGIC, (uint32_t)size, (uint32_t)argc };
+	int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+	char control[CMSG_SPACE(sizeof fds)];
+	struct iovec iov = { &header, sizeof header };
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+
+	memset(&msg, 0, sizeof msg);
+	memset(control, 0, sizeof control);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof control;
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof fds);
+	(void) memcpy(CMSG_DATA(cmsg), fds, sizeof fds);
+
+	if (sendmsg(fd, &msg, 0) != sizeof header) {
+		bail_out("sending the job failed");
+	}
+	for (size_t sent = 0; sent < size; ) {
+		ssize_t w = send(fd, payload + sent, size - sent, 0);
+		if (w < 0) {
+			if (errno == EINTR) continue;
+			bail_out("sending the job failed");
+		}
+		sent += (size_t)w;
+	}
+	free(payload);
+
+	/* the daemon writes to our stdout itself and finally sends the exit code */
+	unsigned char status;
+	ssize_t r;
+	do {
+		r = recv(fd, &status, 1, 0);
+	} while (r < 0 && errno == EINTR);
+	if (r != 1) {
+		if (r == 0) errno = 0;
+		bail_out("the daemon did not finish the job");
+	}
+	(void) close(fd);
+	return status;
+}
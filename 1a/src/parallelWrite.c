@@ -0,0 +1,227 @@
+/**
+ * @file parallelWrite.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the parallelWrite module
+ **/
+
+/* fallocate(2) is Linux specific */
+#define _GNU_SOURCE
+
+#include "parallelWrite.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* === Constants === */
+
+/** @brief Minimum number of lines per thread, fewer lines are not worth a thread */
+#define MIN_LINES_PER_THREAD (4096)
+
+/* === Type Definitions === */
+
+/**
+ * @brief The slice of lines a single thread works on
+ */
+struct Slice
+{
+	char **lines;		/**< all lines */
+	size_t *lengths;	/**< the lengths of all lines, filled in by measureSlice */
+	size_t begin;		/**< first line of the slice */
+	size_t end;		/**< line after the last one of the slice */
+	size_t bytes;		/**< number of bytes of the slice including the newlines */
+	size_t offset;		/**< offset of the slice in the output */
+	char *dest;		/**< the mapped output file */
+};
+
+/* === Prototypes === */
+
+/**
+ * @brief Thread function of the first pass: computes the length of every line of the slice and their sum.
+ * @param *arg Pointer to a struct Slice.
+ * @return arg
+ */
+static void *measureSlice(void *arg);
+
+/**
+ * @brief Thread function of the second pass: copies the lines of the slice to their offsets in the output.
+ * @param *arg Pointer to a struct Slice.
+ * @return arg
+ */
+static void *copySlice(void *arg);
+
+/**
+ * @brief Runs func on every slice, each in its own thread (the first one in the calling thread).
+ * @return 0 on success, an error number otherwise.
+ */
+static int runSlices(struct Slice *slices, size_t threads, void *(*func)(void *));
+
+/**
+ * @brief Fallback for outputs which can not be mapped: writes the lines sequentially to fd.
+ * @return 0 on success, -1 otherwise.
+ */
+static int writeSequential(int fd, char **lines, size_t count);
+
+
+/* === Implementations === */
+
+static void *measureSlice(void *arg)
+{
+	struct Slice *slice = arg;
+
+	slice->bytes = 0;
+	for (size_t i = slice->begin; i < slice->end; i++) {
+		slice->lengths[i] = strlen(slice->lines[i]);
+		slice->bytes += slice->lengths[i] + 1;
+	}
+	return arg;
+}
+
+static void *copySlice(void *arg)
+{
+	struct Slice *slice = arg;
+	char *pos = slice->dest + slice->offset;
+
+	for (size_t i = slice->begin; i < slice->end; i++) {
+		(void) memcpy(pos, slice->lines[i], slice->lengths[i]);
+		pos[slice->lengths[i]] = '\n';
+		pos += slice->lengths[i] + 1;
+	}
+	return arg;
+}
+
+static int runSlices(struct Slice *slices, size_t threads, void *(*func)(void *))
+{
+	pthread_t tids[MAX_WRITE_THREADS];
+	size_t started;
+	int error = 0;
+
+	for (started = 1; started < threads; started++) {
+		if ( (error = pthread_create(&tids[started], NULL, func, &slices[started])) != 0) {
+			break;
+		}
+	}
+	(void) func(&slices[0]);
+	for (size_t t = 1; t < started; t++) {
+		(void) pthread_join(tids[t], NULL);
+	}
+	return error;
+}
+
+static int writeSequential(int fd, char **lines, size_t count)
+{
+	FILE *f = fdopen(fd, "w");
+	int ret = 0;
+
+	if (f == NULL) {
+		(void) close(fd);
+		return -1;
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (fputs(lines[i], f) == EOF || fputc('\n', f) == EOF) {
+			ret = -1;
+			break;
+		}
+	}
+	if (fclose(f) != 0) {
+		ret = -1;
+	}
+	return ret;
+}
+
+int writeLinesParallel(const char *path, char **lines, size_t count, size_t threads)
+{
+	struct Slice slices[MAX_WRITE_THREADS];
+	size_t *lengths = NULL;
+	size_t total = 0;
+	struct stat st;
+	char *dest;
+	int error;
+	int fd;
+
+	if ( (fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0) {
+		return -1;
+	}
+	if (fstat(fd, &st) != 0) {
+		(void) close(fd);
+		return -1;
+	}
+	if (!S_ISREG(st.st_mode)) {
+		return writeSequential(fd, lines, count);
+	}
+
+	if (threads == 0) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (online > 0) ? (size_t)online : 1;
+	}
+	if (threads > count / MIN_LINES_PER_THREAD + 1) {
+		threads = count / MIN_LINES_PER_THREAD + 1;
+	}
+	if (threads > MAX_WRITE_THREADS) {
+		threads = MAX_WRITE_THREADS;
+	}
+	if ( (lengths = malloc((count + 1) * sizeof(size_t))) == NULL) {
+		(void) close(fd);
+		return -1;
+	}
+	for (size_t t = 0; t < threads; t++) {
+		slices[t].lines = lines;
+		slices[t].lengths = lengths;
+		slices[t].begin = t * count / threads;
+		slices[t].end = (t + 1) * count / threads;
+	}
+
+	/* 1.) measure the slices and compute their offsets with a prefix sum */
+	if ( (error = runSlices(slices, threads, measureSlice)) != 0) {
+		goto fail;
+	}
+	for (size_t t = 0; t < threads; t++) {
+		slices[t].offset = total;
+		total += slices[t].bytes;
+	}
+	if (total == 0) {
+		free(lengths);
+		return close(fd);
+	}
+
+	/* 2.) preallocate the file, so that no thread has to extend it while writing */
+	if (fallocate(fd, 0, 0, (off_t)total) != 0) {
+		if ((errno != EOPNOTSUPP && errno != ENOSYS) || ftruncate(fd, (off_t)total) != 0) {
+			error = errno;
+			goto fail;
+		}
+	}
+	dest = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (dest == MAP_FAILED) {
+		error = errno;
+		goto fail;
+	}
+
+	/* 3.) copy the slices in parallel */
+	for (size_t t = 0; t < threads; t++) {
+		slices[t].dest = dest;
+	}
+	error = runSlices(slices, threads, copySlice);
+	if (munmap(dest, total) != 0 && error == 0) {
+		error = errno;
+	}
+	if (error != 0) {
+		goto fail;
+	}
+	free(lengths);
+	return close(fd);
+
+fail:
+	free(lengths);
+	(void) close(fd);
+	errno = error;
+	return -1;
+}
@@ -0,0 +1,32 @@
+/**
+ * @file parallelWrite.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Module for writing an array of lines to a file with several threads.
+ * @details The offset of every line in the output is computed with a prefix sum over the line lengths,
+ * the file is preallocated and mapped into memory and every thread copies its slice of the lines into
+ * the mapping.
+ **/
+
+#ifndef PARALLELWRITE_H
+#define PARALLELWRITE_H
+
+#include <stddef.h>
+
+/** @brief The maximum number of threads used for writing */
+#define MAX_WRITE_THREADS (64)
+
+/**
+ * @brief Writes the lines, each terminated by '\n', to the file at path.
+ * @details The file is created or truncated. If it is not a regular file (e.g. /dev/stdout), the lines
+ * are written sequentially instead.
+ * @param *path The output file.
+ * @param **lines The lines to write.
+ * @param count The number of lines.
+ * @param threads The number of threads, 0 for one per online processor (at most MAX_WRITE_THREADS).
+ * @return A value different from 0 if an error occurs (errno is set accordingly), 0 otherwise.
+ */
+int writeLinesParallel(const char *path, char **lines, size_t count, size_t threads);
+
+#endif /* PARALLELWRITE_H */
@@ -0,0 +1,208 @@
+/**
+ * @file partition.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the partition module
+ **/
+
+#include "partition.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+/* === Constants === */
+
+/** @brief Number of samples taken per partition for choosing the splitters */
+#define OVERSAMPLING (64)
+
+/** @brief Fixed seed for the sampling, so that the same input always yields the same partitions */
+#define SAMPLE_SEED (1327476)
+
+/* === Type Definitions === */
+
+/**
+ * @brief The work item of one partition thread
+ */
+struct PartitionJob
+{
+	char **lines;		/**< Pointer to the first line of the partition */
+	size_t length;		/**< Number of lines in the partition */
+	char path[FILENAME_MAX];	/**< The output file of the partition */
+	int (*compar)(const void *, const void *);	/**< The comparison function */
+	int error;		/**< errno of the first error that occured, 0 if none */
+};
+
+/* === Prototypes === */
+
+/**
+ * @brief Thread function: sorts one partition and writes it to its file.
+ * @param *arg Pointer to a struct PartitionJob.
+ * @return arg
+ */
+static void *sortAndWrite(void *arg);
+
+
+/* === Implementations === */
+
+int chooseSplitters(struct Buffer *buffer, size_t partitions,
+		int (*compar)(const void *, const void *), char **splitters)
+{
+	size_t length = (size_t)buffer->length;
+	size_t sampleSize = partitions * OVERSAMPLING;
+	unsigned int seed = SAMPLE_SEED;
+	char **sample;
+
+	if (sampleSize > length) {
+		sampleSize = length;
+	}
+	if ( (sample = malloc(sampleSize * sizeof(char *))) == NULL) {
+		return -1;
+	}
+	/* take one random line out of each of sampleSize equally sized strides */
+	for (size_t i = 0; i < sampleSize; i++) {
+		size_t begin = i * length / sampleSize;
+		size_t end = (i + 1) * length / sampleSize;
+		sample[i] = buffer->content[begin + (size_t)rand_r(&seed) % (end - begin)];
+	}
+	qsort(sample, sampleSize, sizeof(char *), compar);
+
+	for (size_t i = 1; i < partitions; i++) {
+		splitters[i - 1] = sample[i * sampleSize / partitions];
+	}
+	free(sample);
+	return 0;
+}
+
+size_t findPartition(char *line, char **splitters, size_t count,
+		int (*compar)(const void *, const void *))
+{
+	size_t low = 0;
+	size_t high = count;
+
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+		if (compar(&splitters[mid], &line) <= 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+static void *sortAndWrite(void *arg)
+{
+	struct PartitionJob *job = arg;
+	FILE *f;
+
+	qsort(job->lines, job->length, sizeof(char *), job->compar);
+
+	if ( (f = fopen(job->path, "w")) == NULL) {
+		job->error = errno;
+		return arg;
+	}
+	for (size_t i = 0; i < job->length; i++) {
+		if (fputs(job->lines[i], f) == EOF || fputc('\n', f) == EOF) {
+			job->error = errno;
+			break;
+		}
+	}
+	if (fclose(f) != 0 && job->error == 0) {
+		job->error = errno;
+	}
+	return arg;
+}
+
+int writePartitions(struct Buffer *buffer, size_t partitions, const char *prefix,
+		int (*compar)(const void *, const void *))
+{
+	size_t length = (size_t)buffer->length;
+	char **splitters = NULL;
+	size_t *owner = NULL;
+	size_t *offset = NULL;
+	char **scattered = NULL;
+	struct PartitionJob *jobs = NULL;
+	pthread_t *threads = NULL;
+	size_t started = 0;
+	int width = 1;
+	int ret = -1;
+
+	if (partitions < 1 || partitions > MAX_PARTITIONS) {
+		errno = EINVAL;
+		return -1;
+	}
+	for (size_t i = partitions - 1; i >= 10; i /= 10) {
+		width++;
+	}
+
+	if ( (splitters = malloc(partitions * sizeof(char *))) == NULL ||
+	     (owner = malloc((length + 1) * sizeof(size_t))) == NULL ||
+	     (offset = calloc(partitions + 1, sizeof(size_t))) == NULL ||
+	     (scattered = malloc((length + 1) * sizeof(char *))) == NULL ||
+	     (jobs = calloc(partitions, sizeof(struct PartitionJob))) == NULL ||
+	     (threads = malloc(partitions * sizeof(pthread_t))) == NULL) {
+		goto cleanup;
+	}
+
+	/* an empty input still produces (empty) output files */
+	if (length > 0 && partitions > 1) {
+		if (chooseSplitters(buffer, partitions, compar, splitters) != 0) {
+			goto cleanup;
+		}
+	}
+
+	/* count the lines per partition and scatter them, so that every partition is contiguous */
+	for (size_t i = 0; i < length; i++) {
+		owner[i] = findPartition(buffer->content[i], splitters, partitions - 1, compar);
+		offset[owner[i] + 1]++;
+	}
+	for (size_t p = 0; p < partitions; p++) {
+		offset[p + 1] += offset[p];
+	}
+	for (size_t i = 0; i < length; i++) {
+		scattered[offset[owner[i]]++] = buffer->content[i];
+	}
+	(void) memcpy(buffer->content, scattered, length * sizeof(char *));
+
+	/* offset[p] now is the end of partition p */
+	for (size_t p = 0; p < partitions; p++) {
+		size_t begin = (p == 0) ? 0 : offset[p - 1];
+		jobs[p].lines = &buffer->content[begin];
+		jobs[p].length = offset[p] - begin;
+		jobs[p].compar = compar;
+		if (snprintf(jobs[p].path, sizeof(jobs[p].path), "%s.%0*u", prefix, width,
+				(unsigned int)p) >= (int)sizeof(jobs[p].path)) {
+			errno = ENAMETOOLONG;
+			goto cleanup;
+		}
+	}
+
+	ret = 0;
+	for (started = 0; started < partitions; started++) {
+		int error = pthread_create(&threads[started], NULL, sortAndWrite, &jobs[started]);
+		if (error != 0) {
+			errno = error;
+			ret = -1;
+			break;
+		}
+	}
+	for (size_t p = 0; p < started; p++) {
+		(void) pthread_join(threads[p], NULL);
+		if (jobs[p].error != 0 && ret == 0) {
+			errno = jobs[p].error;
+			ret = -1;
+		}
+	}
+
+cleanup:
+	free(splitters);
+	free(owner);
+	free(offset);
+	free(scattered);
+	free(jobs);
+	free(threads);
+	return ret;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file partition.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Module for writing the content of a buffer as N range partitions into N files.
+ * @details The splitters between the partitions are chosen by sampling the input, so that no global
+ * sort is necessary. Afterwards every partition is sorted and written by its own thread.
+ **/
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include "bufferedFileRead.h"
+#include <stddef.h>
+
+/** @brief The maximum number of partitions (and therefore threads) which may be requested */
+#define MAX_PARTITIONS (1024)
+
+/**
+ * @brief Chooses partitions - 1 splitters from a sample of the buffer.
+ * @details The splitters are pointers into buffer->content and are ordered according to compar.
+ * @param *buffer The buffer to sample from. Must not be empty.
+ * @param partitions The number of partitions.
+ * @param compar The comparison function as used by qsort(3) on buffer->content.
+ * @param **splitters Array of size partitions - 1 which is filled with the splitters.
+ * @return A value different from 0 if an error occurs, 0 otherwise.
+ */
+int chooseSplitters(struct Buffer *buffer, size_t partitions,
+		int (*compar)(const void *, const void *), char **splitters);
+
+/**
+ * @brief Finds the partition a line belongs to via binary search over the splitters.
+ * @details Equal lines always end up in the same partition.
+ * @param *line The line to look up.
+ * @param **splitters The splitters as chosen by chooseSplitters.
+ * @param count The number of splitters.
+ * @param compar The comparison function the splitters were chosen with.
+ * @return The number of splitters which are less than or equal to line.
+ */
+size_t findPartition(char *line, char **splitters, size_t count,
+		int (*compar)(const void *, const void *));
+
+/**
+ * @brief Splits the lines of a buffer into range partitions and writes each of them sorted to its own file.
+ * @details From a sample of the lines partitions - 1 splitters are selected. Every line is assigned to the
+ * partition it belongs to according to compar, so that the concatenation of all the output files in order is
+ * sorted. Partition i is written to "<prefix>.<i>", where i is zero-padded to the width of partitions - 1.
+ * The order of buffer->content gets changed.
+ * @param *buffer The buffer containing the lines to partition.
+ * @param partitions The number of partitions, between 1 and MAX_PARTITIONS.
+ * @param *prefix The prefix of the output file names.
+ * @param compar The comparison function as used by qsort(3) on buffer->content.
+ * @return A value different from 0 if an error occurs (errno is set accordingly), 0 otherwise.
+ */
+int writePartitions(struct Buffer *buffer, size_t partitions, const char *prefix,
+		int (*compar)(const void *, const void *));
+
+#endif /* PARTITION_H */
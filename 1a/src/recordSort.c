@@ -0,0 +1,315 @@
+/**
+ * @file recordSort.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the recordSort module
+ * @details Every record is represented in the index by a pointer into the mapped input and the first (up to)
+ * eight key bytes packed big-endian into an integer. The index is sorted with a LSD radix sort over these
+ * packed bytes, skipping byte positions which are equal for all records. Longer keys are afterwards sorted
+ * within runs of equal prefixes by a stable merge sort comparing the remaining key bytes.
+ **/
+
+#include "recordSort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* === Constants === */
+
+/** @brief Number of key bytes packed into struct IndexEntry.prefix */
+#define PREFIX_BYTES (8)
+
+/** @brief Size of the chunks the sorted records are gathered into before they are written */
+#define OUTPUT_CHUNK (1 << 20)
+
+/** @brief Size of the blocks stdin is read in */
+#define INPUT_BLOCK (1 << 16)
+
+/* === Type Definitions === */
+
+/**
+ * @brief One entry of the index which gets sorted instead of the records themselves
+ */
+struct IndexEntry
+{
+	uint64_t prefix;		/**< The first key bytes, big-endian, zero padded */
+	const unsigned char *record;	/**< Pointer to the record */
+};
+
+/**
+ * @brief An input mapped (or, for stdin, read) into memory
+ */
+struct Input
+{
+	unsigned char *data;	/**< the content */
+	size_t size;		/**< size of the content */
+	int mapped;		/**< 1 if data has to be munmap'ed, 0 if it has to be freed */
+};
+
+/* === Prototypes === */
+
+/**
+ * @brief Maps the file at path into memory, or reads stdin if path is NULL.
+ * @return 0 on success, -1 otherwise.
+ */
+static int loadInput(const char *path, struct Input *input);
+
+/**
+ * @brief LSD radix sort of the index by prefix, stable.
+ * @param *index The index to sort.
+ * @param *tmp Scratch space of the same size as index.
+ * @param n The number of entries.
+ * @param bytes The number of significant bytes in prefix (counting from the most significant one).
+ */
+static void radixSort(struct IndexEntry *index, struct IndexEntry *tmp, size_t n, size_t bytes);
+
+/**
+ * @brief Stable merge sort of the index by the key bytes following the prefix.
+ */
+static void mergeSortSuffix(struct IndexEntry *index, struct IndexEntry *tmp, size_t n,
+		size_t offset, size_t length);
+
+/**
+ * @brief Writes the records in the order of the index to fd, gathered into large chunks.
+ * @return 0 on success, -1 otherwise.
+ */
+static int writeRecords(struct IndexEntry *index, size_t n, size_t recordSize, int descending, int fd);
+
+/**
+ * @brief Writes n bytes to fd, retrying on partial writes and EINTR.
+ * @return 0 on success, -1 otherwise.
+ */
+static int writeAll(int fd, const unsigned char *data, size_t n);
+
+
+/* === Implementations === */
+
+static int loadInput(const char *path, struct Input *input)
+{
+	struct stat st;
+	int fd = (path == NULL) ? STDIN_FILENO : open(path, O_RDONLY);
+
+	memset(input, 0, sizeof *input);
+	if (fd < 0) {
+		return -1;
+	}
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		input->data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (input->data != MAP_FAILED) {
+			(void) madvise(input->data, (size_t)st.st_size, MADV_SEQUENTIAL);
+			input->size = (size_t)st.st_size;
+			input->mapped = 1;
+			if (path != NULL) (void) close(fd);
+			return 0;
+		}
+		input->data = NULL;
+	}
+
+	/* not mappable (pipe, terminal, ...): read it into memory */
+	size_t capacity = 0;
+	for (;;) {
+		if (input->size + INPUT_BLOCK > capacity) {
+			unsigned char *grown;
+			capacity = (capacity == 0) ? INPUT_BLOCK : 2 * capacity;
+			if ( (grown = realloc(input->data, capacity)) == NULL) {
+				break;
+			}
+			input->data = grown;
+		}
+		ssize_t r = read(fd, input->data + input->size, capacity - input->size);
+		if (r < 0 && errno == EINTR) continue;
+		if (r < 0) break;
+		if (r == 0) {
+			if (path != NULL) (void) close(fd);
+			return 0;
+		}
+		input->size += (size_t)r;
+	}
+	if (path != NULL) (void) close(fd);
+	free(input->data);
+	input->data = NULL;
+	return -1;
+}
+
+static void radixSort(struct IndexEntry *index, struct IndexEntry *tmp, size_t n, size_t bytes)
+{
+	size_t count[256];
+
+	for (size_t b = 0; b < bytes; b++) {
+		unsigned int shift = 8 * (PREFIX_BYTES - bytes + b);
+		size_t pos = 0;
+
+		(void) memset(count, 0, sizeof count);
+		for (size_t i = 0; i < n; i++) {
+			count[(index[i].prefix >> shift) & 0xff]++;
+		}
+		/* all records share this byte: the pass would not change anything */
+		if (count[(index[0].prefix >> shift) & 0xff] == n) {
+			continue;
+		}
+		for (size_t d = 0; d < 256; d++) {
+			size_t c = count[d];
+			count[d] = pos;
+			pos += c;
+		}
+		for (size_t i = 0; i < n; i++) {
+			tmp[count[(index[i].prefix >> shift) & 0xff]++] = index[i];
+		}
+		(void) memcpy(index, tmp, n * sizeof(struct IndexEntry));
+	}
+}
+
+static void mergeSortSuffix(struct IndexEntry *index, struct IndexEntry *tmp, size_t n,
+		size_t offset, size_t length)
+{
+	if (n < 2) {
+		return;
+	}
+	size_t half = n / 2;
+	mergeSortSuffix(index, tmp, half, offset, length);
+	mergeSortSuffix(index + half, tmp, n - half, offset, length);
+
+	size_t i = 0, j = half, k = 0;
+	while (i < half && j < n) {
+		if (memcmp(index[j].record + offset, index[i].record + offset, length) < 0) {
+			tmp[k++] = index[j++];
+		} else {
+			tmp[k++] = index[i++];
+		}
+	}
+	while (i < half) tmp[k++] = index[i++];
+	while (j < n) tmp[k++] = index[j++];
+	(void) memcpy(index, tmp, n * sizeof(struct IndexEntry));
+}
+
+static int writeAll(int fd, const unsigned char *data, size_t n)
+{
+	while (n > 0) {
+		ssize_t w = write(fd, data, n);
+		if (w < 0) {
+			if (errno == EINTR) continue;
+			return -1;
+		}
+		data += w;
+		n -= (size_t)w;
+	}
+	return 0;
+}
+
+static int writeRecords(struct IndexEntry *index, size_t n, size_t recordSize, int descending, int fd)
+{
+	unsigned char *chunk;
+	size_t fill = 0;
+
+	if (recordSize > OUTPUT_CHUNK / 4) {
+		/* large records: gathering would not save any system calls */
+		for (size_t i = 0; i < n; i++) {
+			const unsigned char *rec = index[descending ? n - 1 - i : i].record;
+			if (writeAll(fd, rec, recordSize) != 0) return -1;
+		}
+		return 0;
+	}
+	if ( (chunk = malloc(OUTPUT_CHUNK)) == NULL) {
+		return -1;
+	}
+	for (size_t i = 0; i < n; i++) {
+		const unsigned char *rec = index[descending ? n - 1 - i : i].record;
+		if (fill + recordSize > OUTPUT_CHUNK) {
+			if (writeAll(fd, chunk, fill) != 0) {
+				free(chunk);
+				return -1;
+			}
+			fill = 0;
+		}
+		(void) memcpy(chunk + fill, rec, recordSize);
+		fill += recordSize;
+	}
+	int ret = writeAll(fd, chunk, fill);
+	free(chunk);
+	return ret;
+}
+
+int sortRecords(char **paths, size_t pathCount, const struct RecordSpec *spec, int descending, int fd)
+{
+	size_t inputCount = (pathCount == 0) ? 1 : pathCount;
+	struct Input *inputs;
+	struct IndexEntry *index = NULL;
+	struct IndexEntry *tmp = NULL;
+	size_t n = 0;
+	size_t prefixBytes;
+	int ret = -1;
+
+	if (spec->recordSize == 0 || spec->recordSize > MAX_RECORD_SIZE ||
+	    spec->keyOffset + spec->keyLength > spec->recordSize) {
+		errno = EINVAL;
+		return -1;
+	}
+	prefixBytes = (spec->keyLength < PREFIX_BYTES) ? spec->keyLength : PREFIX_BYTES;
+
+	if ( (inputs = calloc(inputCount, sizeof(struct Input))) == NULL) {
+		return -1;
+	}
+	for (size_t i = 0; i < inputCount; i++) {
+		if (loadInput((pathCount == 0) ? NULL : paths[i], &inputs[i]) != 0) {
+			goto cleanup;
+		}
+		if (inputs[i].size % spec->recordSize != 0) {
+			errno = EINVAL;
+			goto cleanup;
+		}
+		n += inputs[i].size / spec->recordSize;
+	}
+
+	if ( (index = malloc((n + 1) * sizeof(struct IndexEntry))) == NULL ||
+	     (tmp = malloc((n + 1) * sizeof(struct IndexEntry))) == NULL) {
+		goto cleanup;
+	}
+	n = 0;
+	for (size_t i = 0; i < inputCount; i++) {
+		for (size_t pos = 0; pos < inputs[i].size; pos += spec->recordSize) {
+			const unsigned char *key = inputs[i].data + pos + spec->keyOffset;
+			uint64_t prefix = 0;
+			for (size_t b = 0; b < PREFIX_BYTES; b++) {
+				prefix = (prefix << 8) | ((b < prefixBytes) ? key[b] : 0);
+			}
+			index[n].prefix = prefix;
+			index[n].record = inputs[i].data + pos;
+			n++;
+		}
+	}
+
+	if (n > 0) {
+		radixSort(index, tmp, n, prefixBytes);
+	}
+	if (spec->keyLength > PREFIX_BYTES) {
+		size_t offset = spec->keyOffset + PREFIX_BYTES;
+		size_t length = spec->keyLength - PREFIX_BYTES;
+		for (size_t begin = 0, end; begin < n; begin = end) {
+			for (end = begin + 1; end < n && index[end].prefix == index[begin].prefix; end++);
+			mergeSortSuffix(&index[begin], tmp, end - begin, offset, length);
+		}
+	}
+
+	ret = writeRecords(index, n, spec->recordSize, descending, fd);
+
+cleanup:
+	free(index);
+	free(tmp);
+	for (size_t i = 0; i < inputCount; i++) {
+		if (inputs[i].mapped) {
+			(void) munmap(inputs[i].data, inputs[i].size);
+		} else {
+			free(inputs[i].data);
+		}
+	}
+	free(inputs);
+	return ret;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file recordSort.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Module for sorting fixed-size binary records instead of text lines.
+ * @details The input files are mapped into memory and only an index of the records is sorted by their
+ * key bytes, using a radix sort for short keys. The records may contain any bytes, including '\0' and '\n'.
+ **/
+
+#ifndef RECORDSORT_H
+#define RECORDSORT_H
+
+#include <stddef.h>
+
+/** @brief The maximum size of a record */
+#define MAX_RECORD_SIZE (1 << 20)
+
+/**
+ * @brief Describes the layout of the records and of their keys
+ */
+struct RecordSpec
+{
+	size_t recordSize;	/**< Size of a record in bytes */
+	size_t keyOffset;	/**< Offset of the key inside a record */
+	size_t keyLength;	/**< Length of the key, keyOffset + keyLength must not exceed recordSize */
+};
+
+/**
+ * @brief Sorts the records of the concatenation of the given files by their keys and writes them to fd.
+ * @details Keys are compared bytewise as unsigned chars, records with equal keys keep their input order
+ * (or the reversed input order if descending). The size of every input must be a multiple of the record size.
+ * @param **paths The files to sort, if pathCount is 0 stdin is read.
+ * @param pathCount The number of files.
+ * @param *spec The record layout.
+ * @param descending 0 for ascending order, descending otherwise.
+ * @param fd The file descriptor to write the sorted records to.
+ * @return A value different from 0 if an error occurs (errno is set accordingly), 0 otherwise.
+ */
+int sortRecords(char **paths, size_t pathCount, const struct RecordSpec *spec, int descending, int fd);
+
+#endif /* RECORDSORT_H */
@@ -0,0 +1,204 @@
+/**
+ * @file runSort.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the runSort module
+ **/
+
+#include "runSort.h"
+#include "bufferedFileRead.h"
+#include "frontCoding.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* === Global Variables === */
+
+/** @brief the comparison function used for the merge heap */
+static int (*compareLines)(const void *, const void *);
+
+/* === Prototypes === */
+
+/**
+ * @brief Sorts the lines of buffer, appends them as front-coded run to *runs and empties the buffer.
+ * @return 0 on success, -1 otherwise.
+ */
+static int flushRun(struct Buffer *buffer, struct FrontCodedRun **runs, size_t *runCount, FILE *spill);
+
+/**
+ * @brief Compares the current lines of two cursors with compareLines.
+ */
+static int compareCursors(const struct RunCursor *a, const struct RunCursor *b);
+
+/**
+ * @brief Restores the heap property below index i.
+ */
+static void siftDown(struct RunCursor **heap, size_t size, size_t i);
+
+/**
+ * @brief Merges the runs with a binary heap of cursors and writes the lines to out.
+ * @return 0 on success, -1 otherwise.
+ */
+static int mergeRuns(struct FrontCodedRun *runs, size_t runCount, FILE *out);
+
+
+/* === Implementations === */
+
+static int flushRun(struct Buffer *buffer, struct FrontCodedRun **runs, size_t *runCount, FILE *spill)
+{
+	struct FrontCodedRun *grown;
+
+	if (buffer->length == 0) {
+		return 0;
+	}
+	if ( (grown = realloc(*runs, (*runCount + 1) * sizeof(struct FrontCodedRun))) == NULL) {
+		return -1;
+	}
+	*runs = grown;
+
+	qsort(buffer->content, buffer->length, sizeof(char *), compareLines);
+	if (encodeRun(&(*runs)[*runCount], buffer->content, buffer->length, spill) != 0) {
+		return -1;
+	}
+	(*runCount)++;
+
+	clearBuffer(buffer);
+	return 0;
+}
+
+static int compareCursors(const struct RunCursor *a, const struct RunCursor *b)
+{
+	return compareLines(&a->line, &b->line);
+}
+
+static void siftDown(struct RunCursor **heap, size_t size, size_t i)
+{
+	for (;;) {
+		size_t smallest = i;
+		size_t left = 2 * i + 1;
+		size_t right = left + 1;
+
+		if (left < size && compareCursors(heap[left], heap[smallest]) < 0) smallest = left;
+		if (right < size && compareCursors(heap[right], heap[smallest]) < 0) smallest = right;
+		if (smallest == i) {
+			return;
+		}
+		struct RunCursor *tmp = heap[i];
+		heap[i] = heap[smallest];
+		heap[smallest] = tmp;
+		i = smallest;
+	}
+}
+
+static int mergeRuns(struct FrontCodedRun *runs, size_t runCount, FILE *out)
+{
+	struct RunCursor *cursors;
+	struct RunCursor **heap;
+	size_t size = 0;
+	int ret = 0;
+
+	if ( (cursors = calloc(runCount + 1, sizeof(struct RunCursor))) == NULL) {
+		return -1;
+	}
+	if ( (heap = malloc((runCount + 1) * sizeof(struct RunCursor *))) == NULL) {
+		free(cursors);
+		return -1;
+	}
+	for (size_t r = 0; r < runCount; r++) {
+		if (openCursor(&cursors[r], &runs[r]) != 0 || nextLine(&cursors[r]) != 1) {
+			ret = -1;
+			goto cleanup;
+		}
+		heap[size++] = &cursors[r];
+	}
+	for (size_t i = size / 2; i-- > 0; ) {
+		siftDown(heap, size, i);
+	}
+
+	while (size > 0) {
+		if (fputs(heap[0]->line, out) == EOF || fputc('\n', out) == EOF) {
+			ret = -1;
+			break;
+		}
+		int more = nextLine(heap[0]);
+		if (more < 0) {
+			ret = -1;
+			break;
+		}
+		if (more == 0) {
+			heap[0] = heap[--size];
+		}
+		siftDown(heap, size, 0);
+	}
+
+cleanup:
+	for (size_t r = 0; r < runCount; r++) {
+		closeCursor(&cursors[r]);
+	}
+	free(cursors);
+	free(heap);
+	return ret;
+}
+
+int sortInRuns(char **paths, size_t pathCount, size_t runLines, int spill, FILE *out,
+		size_t maxLineLength, int (*compar)(const void *, const void *))
+{
+	struct Buffer buffer = {NULL, 0};
+	struct FrontCodedRun *runs = NULL;
+	size_t runCount = 0;
+	FILE *spillFile = NULL;
+	int ret = -1;
+
+	compareLines = compar;
+	if (spill && (spillFile = tmpfile()) == NULL) {
+		return -1;
+	}
+
+	for (size_t i = 0; i < pathCount || (i == 0 && pathCount == 0); i++) {
+		FILE *f = (pathCount == 0) ? stdin : fopen(paths[i], "r");
+		struct LineReader reader;
+		if (f == NULL) {
+			goto cleanup;
+		}
+		if (openReader(&reader, f, maxLineLength, READ_RAW) != 0) {
+			if (f != stdin) (void) fclose(f);
+			goto cleanup;
+		}
+		for (;;) {
+			int before = buffer.length;
+			if (readLines(&reader, &buffer, runLines - (size_t)buffer.length) != 0) {
+				closeReader(&reader);
+				if (f != stdin) (void) fclose(f);
+				goto cleanup;
+			}
+			int appended = buffer.length - before;
+			if ((size_t)buffer.length == runLines && flushRun(&buffer, &runs, &runCount, spillFile) != 0) {
+				closeReader(&reader);
+				if (f != stdin) (void) fclose(f);
+				goto cleanup;
+			}
+			if (appended == 0) {
+				break;	/* end of this file */
+			}
+		}
+		closeReader(&reader);
+		if (f != stdin && fclose(f) != 0) {
+			goto cleanup;
+		}
+	}
+	if (flushRun(&buffer, &runs, &runCount, spillFile) != 0) {
+		goto cleanup;
+	}
+	ret = mergeRuns(runs, runCount, out);
+
+cleanup:
+	freeBuffer(&buffer);
+	for (size_t r = 0; r < runCount; r++) {
+		freeRun(&runs[r]);
+	}
+	free(runs);
+	if (spillFile != NULL) {
+		(void) fclose(spillFile);
+	}
+	return ret;
+}
@@ -0,0 +1,32 @@
+/**
+ * @file runSort.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Module for sorting the input in runs which are held front-coded and merged at the end.
+ * @details The input is read and sorted in runs of a fixed number of lines. Every sorted run is front-coded
+ * (see frontCoding.h) and either kept in memory or spilled to a temporary file, after which its lines are
+ * discarded. Finally all runs are decoded lazily and merged, so only one uncompressed run is in memory at a time.
+ **/
+
+#ifndef RUNSORT_H
+#define RUNSORT_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/**
+ * @brief Sorts the concatenation of the given files in front-coded runs and writes the result to out.
+ * @param **paths The files to sort, if pathCount is 0 stdin is read.
+ * @param pathCount The number of files.
+ * @param runLines The maximum number of lines of a run.
+ * @param spill 0 to keep the encoded runs in memory, otherwise they are written to a temporary file.
+ * @param *out The stream to write the sorted lines to.
+ * @param maxLineLength The maximum length of a line as passed to openReader.
+ * @param compar The comparison function as used by qsort(3) on an array of strings.
+ * @return A value different from 0 if an error occurs, 0 otherwise.
+ */
+int sortInRuns(char **paths, size_t pathCount, size_t runLines, int spill, FILE *out,
+		size_t maxLineLength, int (*compar)(const void *, const void *));
+
+#endif /* RUNSORT_H */
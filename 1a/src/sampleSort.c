@@ -0,0 +1,503 @@
+/**
+ * @file sampleSort.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the sampleSort module
+ * @details Pipes used per worker k:
+ * - sample: worker k -> parent, the local samples of worker k (one per line)
+ * - splitter: parent -> worker k, the global splitters (one per line)
+ * - data: all other workers -> worker k, the lines owned by worker k. Every write is at most PIPE_BUF
+ *   bytes and therefore atomic, so that lines of different senders never interleave.
+ * - token: worker k - 1 (or the parent for k = 0) -> worker k, a single byte allowing worker k to print.
+ *
+ * A line read with readFile may be maxLineLength - 1 characters long without a newline, so the lines
+ * received over the pipes are read with maxLineLength + 1 to keep them in one piece.
+ **/
+
+#include "sampleSort.h"
+#include "bufferedFileRead.h"
+#include "partition.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+/* === Constants === */
+
+/** @brief Number of samples every worker sends to the parent */
+#define SAMPLES_PER_WORKER (64)
+
+/* === Type Definitions === */
+
+/**
+ * @brief An input file and its position inside the concatenation of all regular input files
+ */
+struct InputFile
+{
+	const char *path;	/**< The path of the file */
+	off_t size;		/**< The size of the file, 0 if it is not a regular file */
+	off_t offset;		/**< Offset of the file in the concatenation of the regular files */
+	int regular;		/**< 1 if the file is a regular file which can be split, 0 otherwise */
+};
+
+/**
+ * @brief The pipes of one worker, see the description of this file
+ */
+struct WorkerPipes
+{
+	int sample[2];		/**< worker -> parent */
+	int splitter[2];	/**< parent -> worker */
+	int data[2];		/**< all other workers -> worker */
+	int token[2];		/**< predecessor -> worker */
+};
+
+/**
+ * @brief The state of the thread draining the data pipe of a worker
+ */
+struct Receiver
+{
+	int fd;			/**< read end of the data pipe */
+	size_t maxLineLength;	/**< maximum line length of the input */
+	struct Buffer lines;	/**< the received lines */
+	int error;		/**< 0 on success */
+};
+
+/* === Global Variables === */
+
+/** @brief the input files */
+static struct InputFile *inputs = NULL;
+
+/** @brief number of input files, 0 means stdin */
+static size_t inputCount = 0;
+
+/** @brief sum of the sizes of all regular input files */
+static off_t totalSize = 0;
+
+/** @brief pipes of all the workers */
+static struct WorkerPipes *pipes = NULL;
+
+/** @brief number of workers */
+static size_t workerCount = 0;
+
+/* === Prototypes === */
+
+/**
+ * @brief Writes n bytes to fd, retrying on partial writes and EINTR.
+ * @return 0 on success, -1 otherwise.
+ */
+static int writeAll(int fd, const char *data, size_t n);
+
+/**
+ * @brief Returns the first line start at or after pos inside data.
+ */
+static off_t alignToLine(const char *data, off_t size, off_t pos);
+
+/**
+ * @brief Reads the share [begin, end) of the concatenated regular input files (and, for worker 0, all
+ * other inputs) into buffer.
+ * @return 0 on success, -1 otherwise.
+ */
+static int readShare(size_t self, struct Buffer *buffer, size_t maxLineLength);
+
+/**
+ * @brief Thread function reading the data pipe of a worker into a buffer.
+ * @param *arg Pointer to a struct Receiver.
+ * @return arg
+ */
+static void *receiveLines(void *arg);
+
+/**
+ * @brief Closes all pipe ends a worker does not need.
+ */
+static void closeForeignPipes(size_t self);
+
+/**
+ * @brief The main function of worker self.
+ * @return The exit code of the worker process.
+ */
+static int runWorker(size_t self, size_t maxLineLength, int (*compar)(const void *, const void *));
+
+/**
+ * @brief Sends every line of buffer terminated by '\n' to fd and closes it.
+ * @return 0 on success, -1 otherwise.
+ */
+static int sendLines(int fd, char **lines, size_t count);
+
+
+/* === Implementations === */
+
+static int writeAll(int fd, const char *data, size_t n)
+{
+	while (n > 0) {
+		ssize_t w = write(fd, data, n);
+		if (w < 0) {
+			if (errno == EINTR) continue;
+			return -1;
+		}
+		data += w;
+		n -= (size_t)w;
+	}
+	return 0;
+}
+
+static off_t alignToLine(const char *data, off_t size, off_t pos)
+{
+	if (pos <= 0) {
+		return 0;
+	}
+	if (pos >= size) {
+		return size;
+	}
+	if (data[pos - 1] == '\n') {
+		return pos;
+	}
+	const char *nl = memchr(data + pos, '\n', (size_t)(size - pos));
+	return (nl == NULL) ? size : (off_t)(nl - data) + 1;
+}
+
+static int readShare(size_t self, struct Buffer *buffer, size_t maxLineLength)
+{
+	off_t begin = totalSize * (off_t)self / (off_t)workerCount;
+	off_t end = totalSize * (off_t)(self + 1) / (off_t)workerCount;
+
+	if (inputCount == 0) {
+		return (self == 0) ? readFile(stdin, buffer, maxLineLength, READ_RAW) : 0;
+	}
+
+	for (size_t i = 0; i < inputCount; i++) {
+		struct InputFile *in = &inputs[i];
+		int ret = 0;
+
+		if (!in->regular) {
+			FILE *f;
+			if (self != 0) continue;
+			if ( (f = fopen(in->path, "r")) == NULL) {
+				return -1;
+			}
+			ret = readFile(f, buffer, maxLineLength, READ_RAW);
+			if (fclose(f) != 0) ret = -1;
+			if (ret != 0) return -1;
+			continue;
+		}
+		if (in->size == 0 || end <= in->offset || begin >= in->offset + in->size) {
+			continue;
+		}
+
+		int fd = open(in->path, O_RDONLY);
+		if (fd < 0) {
+			return -1;
+		}
+		char *data = mmap(NULL, (size_t)in->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		(void) close(fd);
+		if (data == MAP_FAILED) {
+			return -1;
+		}
+		/* both neighbours align their borders the same way, so every line is read exactly once */
+		off_t from = alignToLine(data, in->size, begin - in->offset);
+		off_t to = alignToLine(data, in->size, end - in->offset);
+		if (to > from) {
+			FILE *f = fmemopen(data + from, (size_t)(to - from), "r");
+			if (f == NULL) {
+				ret = -1;
+			} else {
+				ret = readFile(f, buffer, maxLineLength, READ_RAW);
+				if (fclose(f) != 0) ret = -1;
+			}
+		}
+		(void) munmap(data, (size_t)in->size);
+		if (ret != 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static void *receiveLines(void *arg)
+{
+	struct Receiver *recv = arg;
+	FILE *f = fdopen(recv->fd, "r");
+
+	if (f == NULL) {
+		recv->error = -1;
+		(void) close(recv->fd);
+		return arg;
+	}
+	recv->error = readFile(f, &recv->lines, recv->maxLineLength + 1, READ_RAW);
+	(void) fclose(f);
+	return arg;
+}
+
+static void closeForeignPipes(size_t self)
+{
+	for (size_t j = 0; j < workerCount; j++) {
+		(void) close(pipes[j].sample[0]);
+		(void) close(pipes[j].splitter[1]);
+		if (j != self) {
+			(void) close(pipes[j].sample[1]);
+			(void) close(pipes[j].splitter[0]);
+			(void) close(pipes[j].data[0]);
+			(void) close(pipes[j].token[0]);
+		} else {
+			/* lines owned by the worker itself never leave it */
+			(void) close(pipes[j].data[1]);
+		}
+		if (j != self + 1) {
+			(void) close(pipes[j].token[1]);
+		}
+	}
+}
+
+static int sendLines(int fd, char **lines, size_t count)
+{
+	FILE *f = fdopen(fd, "w");
+	int ret = 0;
+
+	if (f == NULL) {
+		(void) close(fd);
+		return -1;
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (fputs(lines[i], f) == EOF || fputc('\n', f) == EOF) {
+			ret = -1;
+			break;
+		}
+	}
+	if (fclose(f) != 0) {
+		ret = -1;
+	}
+	return ret;
+}
+
+static int runWorker(size_t self, size_t maxLineLength, int (*compar)(const void *, const void *))
+{
+	struct Buffer local = {NULL, 0};
+	struct Buffer splitters = {NULL, 0};
+	struct Receiver receiver;
+	pthread_t thread;
+	char *samples[SAMPLES_PER_WORKER];
+	char (*batches)[PIPE_BUF] = NULL;
+	size_t *fill = NULL;
+	size_t kept = 0;
+	char token;
+	FILE *f;
+
+	closeForeignPipes(self);
+
+	/* 1.) read the own share of the input and send samples of it to the parent */
+	if (readShare(self, &local, maxLineLength) != 0) {
+		return EXIT_FAILURE;
+	}
+	if (local.length > 0) {
+		if (chooseSplitters(&local, SAMPLES_PER_WORKER + 1, compar, samples) != 0 ||
+		    sendLines(pipes[self].sample[1], samples, SAMPLES_PER_WORKER) != 0) {
+			return EXIT_FAILURE;
+		}
+	} else {
+		(void) close(pipes[self].sample[1]);
+	}
+
+	/* 2.) receive the global splitters */
+	if ( (f = fdopen(pipes[self].splitter[0], "r")) == NULL ||
+	     readFile(f, &splitters, maxLineLength + 1, READ_RAW) != 0) {
+		return EXIT_FAILURE;
+	}
+	(void) fclose(f);
+
+	/* 3.) route every line to its owner, while a thread collects the lines owned by this worker */
+	memset(&receiver, 0, sizeof receiver);
+	receiver.fd = pipes[self].data[0];
+	receiver.maxLineLength = maxLineLength;
+	if (pthread_create(&thread, NULL, receiveLines, &receiver) != 0) {
+		return EXIT_FAILURE;
+	}
+	if ( (batches = malloc(workerCount * sizeof *batches)) == NULL ||
+	     (fill = calloc(workerCount, sizeof(size_t))) == NULL) {
+		return EXIT_FAILURE;
+	}
+	for (int i = 0; i < local.length; i++) {
+		char *line = local.content[i];
+		size_t owner = findPartition(line, splitters.content, (size_t)splitters.length, compar);
+		size_t length;
+
+		if (owner == self) {
+			local.content[kept++] = line;
+			continue;
+		}
+		length = strlen(line);
+		if (fill[owner] + length + 1 > PIPE_BUF) {
+			if (writeAll(pipes[owner].data[1], batches[owner], fill[owner]) != 0) {
+				return EXIT_FAILURE;
+			}
+			fill[owner] = 0;
+		}
+		memcpy(&batches[owner][fill[owner]], line, length);
+		batches[owner][fill[owner] + length] = '\n';
+		fill[owner] += length + 1;
+	}
+	for (size_t j = 0; j < workerCount; j++) {
+		if (j == self) continue;
+		if (fill[j] > 0 && writeAll(pipes[j].data[1], batches[j], fill[j]) != 0) {
+			return EXIT_FAILURE;
+		}
+		(void) close(pipes[j].data[1]);
+	}
+	free(batches);
+	free(fill);
+
+	/* 4.) sort the own range locally */
+	(void) pthread_join(thread, NULL);
+	if (receiver.error != 0) {
+		return EXIT_FAILURE;
+	}
+	/* the received lines stay in the arena of the receiver, only the pointers are merged */
+	local.length = (int)kept;
+	local.capacity = kept + (size_t)receiver.lines.length + 1;
+	if ( (local.content = realloc(local.content, local.capacity * sizeof(char *))) == NULL) {
+		return EXIT_FAILURE;
+	}
+	if (receiver.lines.length > 0) {
+		memcpy(&local.content[kept], receiver.lines.content, receiver.lines.length * sizeof(char *));
+	}
+	local.length += receiver.lines.length;
+	qsort(local.content, local.length, sizeof(char *), compar);
+
+	/* 5.) wait for the predecessor to finish printing, print and pass the token on */
+	if (read(pipes[self].token[0], &token, 1) != 1) {
+		return EXIT_FAILURE;
+	}
+	for (int i = 0; i < local.length; i++) {
+		(void) printf("%s\n", local.content[i]);
+	}
+	if (fflush(stdout) != 0) {
+		return EXIT_FAILURE;
+	}
+	if (self + 1 < workerCount && writeAll(pipes[self + 1].token[1], &token, 1) != 0) {
+		return EXIT_FAILURE;
+	}
+
+	freeBuffer(&splitters);
+	freeBuffer(&local);
+	freeBuffer(&receiver.lines);
+	return EXIT_SUCCESS;
+}
+
+int sampleSortProcesses(char **paths, size_t pathCount, size_t workers, size_t maxLineLength,
+		int (*compar)(const void *, const void *))
+{
+	struct Buffer samples = {NULL, 0};
+	char **splitters = NULL;
+	size_t forked = 0;
+	int ret = -1;
+
+	if (workers < 1 || workers > MAX_WORKERS || maxLineLength > PIPE_BUF) {
+		errno = EINVAL;
+		return -1;
+	}
+	workerCount = workers;
+	inputCount = pathCount;
+	totalSize = 0;
+
+	if ( (inputs = calloc(pathCount + 1, sizeof(struct InputFile))) == NULL ||
+	     (pipes = malloc(workers * sizeof(struct WorkerPipes))) == NULL ||
+	     (splitters = malloc(workers * sizeof(char *))) == NULL) {
+		goto cleanup;
+	}
+	for (size_t i = 0; i < pathCount; i++) {
+		struct stat st;
+		if (stat(paths[i], &st) != 0) {
+			goto cleanup;
+		}
+		inputs[i].path = paths[i];
+		inputs[i].regular = S_ISREG(st.st_mode);
+		inputs[i].size = inputs[i].regular ? st.st_size : 0;
+		inputs[i].offset = totalSize;
+		totalSize += inputs[i].size;
+	}
+
+	/* a worker dying must not kill the others: they get EPIPE instead */
+	if (signal(SIGPIPE, SIG_IGN) == SIG_ERR) {
+		goto cleanup;
+	}
+	for (size_t j = 0; j < workers; j++) {
+		if (pipe(pipes[j].sample) != 0 || pipe(pipes[j].splitter) != 0 ||
+		    pipe(pipes[j].data) != 0 || pipe(pipes[j].token) != 0) {
+			goto cleanup;
+		}
+	}
+
+	(void) fflush(stdout);
+	for (forked = 0; forked < workers; forked++) {
+		pid_t pid = fork();
+		if (pid < 0) {
+			break;
+		}
+		if (pid == 0) {
+			exit(runWorker(forked, maxLineLength, compar));
+		}
+	}
+
+	/* the parent keeps the read ends of the sample pipes and the write ends of the splitter pipes */
+	for (size_t j = 0; j < workers; j++) {
+		(void) close(pipes[j].sample[1]);
+		(void) close(pipes[j].splitter[0]);
+		(void) close(pipes[j].data[0]);
+		(void) close(pipes[j].data[1]);
+		(void) close(pipes[j].token[0]);
+		if (j > 0) {
+			(void) close(pipes[j].token[1]);
+		}
+	}
+
+	ret = (forked == workers) ? 0 : -1;
+	for (size_t j = 0; j < workers; j++) {
+		FILE *f = fdopen(pipes[j].sample[0], "r");
+		if (f == NULL || readFile(f, &samples, maxLineLength + 1, READ_RAW) != 0) {
+			ret = -1;
+		}
+		if (f != NULL) (void) fclose(f);
+	}
+	size_t splitterCount = (ret == 0 && samples.length > 0) ? workers - 1 : 0;
+	if (splitterCount > 0 && chooseSplitters(&samples, workers, compar, splitters) != 0) {
+		ret = -1;
+		splitterCount = 0;
+	}
+	for (size_t j = 0; j < workers; j++) {
+		if (sendLines(pipes[j].splitter[1], splitters, splitterCount) != 0) {
+			ret = -1;
+		}
+	}
+	char token = 0;
+	if (ret == 0 && writeAll(pipes[0].token[1], &token, 1) != 0) {
+		ret = -1;
+	}
+	(void) close(pipes[0].token[1]);
+
+	for (size_t j = 0; j < forked; j++) {
+		int status;
+		if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+			ret = -1;
+		}
+	}
+	if (ret != 0 && errno == 0) {
+		errno = ECHILD;
+	}
+
+cleanup:
+	freeBuffer(&samples);
+	free(splitters);
+	free(inputs);
+	free(pipes);
+	inputs = NULL;
+	pipes = NULL;
+	return ret;
+}
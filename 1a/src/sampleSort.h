@@ -0,0 +1,35 @@
+/**
+ * @file sampleSort.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Module for sorting the input with several worker processes (sample sort).
+ * @details Every worker reads an equally sized share of the input, the splitters between the workers
+ * are chosen from samples sent by all of them. Afterwards every line is routed over a pipe to the worker
+ * owning its range, which sorts it locally with readFile and qsort(3). The workers write their sorted
+ * ranges to stdout one after another, so that no process ever holds the whole input.
+ **/
+
+#ifndef SAMPLESORT_H
+#define SAMPLESORT_H
+
+#include <stddef.h>
+
+/** @brief The maximum number of worker processes which may be requested */
+#define MAX_WORKERS (64)
+
+/**
+ * @brief Sorts the concatenation of the given files with several worker processes and writes it to stdout.
+ * @details Regular files are split into byte ranges at line boundaries. Other files (e.g. pipes) as well as
+ * stdin, if no files are given, are read by the first worker only.
+ * @param **paths The files to sort, if pathCount is 0 stdin is read.
+ * @param pathCount The number of files.
+ * @param workers The number of worker processes, between 1 and MAX_WORKERS.
+ * @param maxLineLength The maximum length of a line as passed to readFile, at most PIPE_BUF.
+ * @param compar The comparison function as used by qsort(3) on an array of strings.
+ * @return A value different from 0 if an error occurs in any of the processes, 0 otherwise.
+ */
+int sampleSortProcesses(char **paths, size_t pathCount, size_t workers, size_t maxLineLength,
+		int (*compar)(const void *, const void *));
+
+#endif /* SAMPLESORT_H */
@@ -0,0 +1,281 @@
+/**
+ * @file sortDaemon.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the sortDaemon module
+ **/
+
+#include "sortDaemon.h"
+#include <stdio.h>
+#include <stdio_ext.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* === Constants === */
+
+/** @brief Number of file descriptors a client passes (stdin, stdout, stderr) */
+#define PASSED_FDS (3)
+
+/** @brief Number of clients that may wait while a job is running */
+#define BACKLOG (64)
+
+/* === Global Variables === */
+
+/** @brief set upon receipt of SIGINT or SIGTERM */
+static volatile sig_atomic_t quit = 0;
+
+/* === Prototypes === */
+
+/**
+ * @brief Signal handler, sets quit
+ * @param sig Signal number catched
+ */
+static void signal_handler(int sig);
+
+/**
+ * @brief Creates the listening socket at path.
+ * @return The socket, -1 on error.
+ */
+static int openListener(const char *path);
+
+/**
+ * @brief Receives the header of a request together with the file descriptors of the client.
+ * @return 0 on success, -1 otherwise.
+ */
+static int receiveHeader(int conn, struct JobHeader *header, int *fds);
+
+/**
+ * @brief Reads exactly n bytes from fd.
+ * @return 0 on success, -1 otherwise.
+ */
+static int readAll(int fd, char *dest, size_t n);
+
+/**
+ * @brief Receives and runs the job of one client and replies with its exit code.
+ * @param conn The connection to the client.
+ * @param job The function running the job.
+ * @param *saved Copies of the standard file descriptors of the daemon.
+ * @param *home The working directory of the daemon.
+ * @return 0 on success, -1 if the request was invalid or could not be answered.
+ */
+static int serveJob(int conn, int (*job)(int argc, char **argv), const int *saved, const char *home);
+
+
+/* === Implementations === */
+
+static void signal_handler(int sig)
+{
+	quit = 1;
+}
+
+static int openListener(const char *path)
+{
+	struct sockaddr_un addr;
+	struct stat st;
+	int fd;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+	memset(&addr, 0, sizeof addr);
+	addr.sun_family = AF_UNIX;
+	(void) strcpy(addr.sun_path, path);
+
+	if ( (fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		return -1;
+	}
+	/* remove a stale socket, but never steal the socket of a running daemon */
+	if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+		if (connect(fd, (struct sockaddr *)&addr, sizeof addr) == 0) {
+			(void) close(fd);
+			errno = EADDRINUSE;
+			return -1;
+		}
+		(void) unlink(path);
+	}
+	if (bind(fd, (struct sockaddr *)&addr, sizeof addr) != 0 || listen(fd, BACKLOG) != 0) {
+		(void) close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static int readAll(int fd, char *dest, size_t n)
+{
+	while (n > 0) {
+		ssize_t r = recv(fd, dest, n, 0);
+		if (r < 0 && errno == EINTR) continue;
+		if (r <= 0) {
+			return -1;
+		}
+		dest += r;
+		n -= (size_t)r;
+	}
+	return 0;
+}
+
+static int receiveHeader(int conn, struct JobHeader *header, int *fds)
+{
+	char control[CMSG_SPACE(PASSED_FDS * sizeof(int))];
+	struct iovec iov = { header, sizeof *header };
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+	ssize_t r;
+
+	memset(&msg, 0, sizeof msg);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof control;
+
+	do {
+		r = recvmsg(conn, &msg, 0);
+	} while (r < 0 && errno == EINTR);
+	if (r <= 0) {
+		return -1;
+	}
+	cmsg = CMSG_FIRSTHDR(&msg);
+	if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+	    cmsg->cmsg_len != CMSG_LEN(PASSED_FDS * sizeof(int))) {
+		return -1;
+	}
+	(void) memcpy(fds, CMSG_DATA(cmsg), PASSED_FDS * sizeof(int));
+
+	/* the rest of the header may arrive separately */
+	if ((size_t)r < sizeof *header && readAll(conn, (char *)header + r, sizeof *header - (size_t)r) != 0) {
+		return -1;
+	}
+	return 0;
+}
+
+static int serveJob(int conn, int (*job)(int argc, char **argv), const int *saved, const char *home)
+{
+	struct JobHeader header;
+	int fds[PASSED_FDS] = {-1, -1, -1};
+	char *payload = NULL;
+	char **argv = NULL;
+	unsigned char status = EXIT_FAILURE;
+	int ret = -1;
+
+	if (receiveHeader(conn, &header, fds) != 0) {
+		goto cleanup;
+	}
+	if (header.magic != JOB_MAGIC || header.size == 0 || header.size > MAX_JOB_SIZE ||
+	    header.argc == 0 || header.argc > header.size) {
+		goto cleanup;
+	}
+	if ( (payload = malloc(header.size)) == NULL ||
+	     (argv = calloc(header.argc + 1, sizeof(char *))) == NULL ||
+	     readAll(conn, payload, header.size) != 0 || payload[header.size - 1] != '\0') {
+		goto cleanup;
+	}
+
+	/* payload: cwd '\0' argv[0] '\0' ... argv[argc - 1] '\0' */
+	char *pos = payload + strlen(payload) + 1;
+	for (uint32_t i = 0; i < header.argc; i++) {
+		if (pos >= payload + header.size) {
+			goto cleanup;
+		}
+		argv[i] = pos;
+		pos += strlen(pos) + 1;
+	}
+
+	if (chdir(payload) != 0) {
+		(void) dprintf(fds[2], "%s: chdir to %s: %s\n", argv[0], payload, strerror(errno));
+	} else {
+		/* install the standard streams of the client */
+		(void) fflush(stdout);
+		(void) fflush(stderr);
+		__fpurge(stdin);
+		clearerr(stdin);
+		for (int i = 0; i < PASSED_FDS; i++) {
+			(void) dup2(fds[i], i);
+		}
+
+		errno = 0;
+		status = (unsigned char)job((int)header.argc, argv);
+
+		(void) fflush(stdout);
+		(void) fflush(stderr);
+		__fpurge(stdin);
+		clearerr(stdin);
+		for (int i = 0; i < PASSED_FDS; i++) {
+			(void) dup2(saved[i], i);
+		}
+		(void) chdir(home);
+	}
+	ret = (send(conn, &status, 1, 0) == 1) ? 0 : -1;
+
+cleanup:
+	for (int i = 0; i < PASSED_FDS; i++) {
+		if (fds[i] >= 0) (void) close(fds[i]);
+	}
+	free(payload);
+	free(argv);
+	return ret;
+}
+
+int runDaemon(const char *socketPath, int (*job)(int argc, char **argv))
+{
+	const int signals[] = {SIGINT, SIGTERM};
+	struct sigaction s;
+	char home[PATH_MAX];
+	int saved[PASSED_FDS];
+	int listener;
+
+	memset(&s, 0, sizeof s);
+	s.sa_handler = signal_handler;
+	s.sa_flags = 0;	/* no SA_RESTART: accept(2) has to return on a signal */
+	if (sigfillset(&s.sa_mask) < 0) {
+		return -1;
+	}
+	for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+		if (sigaction(signals[i], &s, NULL) < 0) {
+			return -1;
+		}
+	}
+	/* a client going away must not kill the daemon */
+	if (signal(SIGPIPE, SIG_IGN) == SIG_ERR) {
+		return -1;
+	}
+	if (getcwd(home, sizeof home) == NULL) {
+		return -1;
+	}
+	for (int i = 0; i < PASSED_FDS; i++) {
+		if ( (saved[i] = dup(i)) < 0) {
+			return -1;
+		}
+	}
+	if ( (listener = openListener(socketPath)) < 0) {
+		return -1;
+	}
+
+	while (!quit) {
+		int conn = accept(listener, NULL, NULL);
+		if (conn < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			break;
+		}
+		if (serveJob(conn, job, saved, home) != 0) {
+			(void) fprintf(stderr, "mysort daemon: dropped an invalid or vanished request\n");
+		}
+		(void) close(conn);
+	}
+
+	(void) close(listener);
+	(void) unlink(socketPath);
+	for (int i = 0; i < PASSED_FDS; i++) {
+		(void) close(saved[i]);
+	}
+	return quit ? 0 : -1;
+}
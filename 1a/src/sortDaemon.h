@@ -0,0 +1,50 @@
+/**
+ * @file sortDaemon.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Module for running mysort as resident daemon on a Unix domain socket.
+ * @details A client (mysortc) connects, sends its working directory and its argument vector and passes
+ * its stdin, stdout and stderr along via SCM_RIGHTS. The daemon runs the job with these file descriptors
+ * installed as its own standard streams, so the sorted output is streamed directly to wherever the
+ * client's stdout points to, and finally replies with the exit code of the job.
+ **/
+
+#ifndef SORTDAEMON_H
+#define SORTDAEMON_H
+
+#include <stdint.h>
+
+/** @brief Environment variable the client takes the socket path from */
+#define SOCKET_ENV ("MYSORT_SOCKET")
+
+/** @brief Socket path used if SOCKET_ENV is not set */
+#define DEFAULT_SOCKET ("/tmp/mysort.sock")
+
+/** @brief Magic number at the beginning of every request */
+#define JOB_MAGIC (0x6d736f72)
+
+/** @brief Maximum size of the request payload (working directory and arguments) */
+#define MAX_JOB_SIZE (1 << 16)
+
+/**
+ * @brief Header of a request, followed by size bytes of payload: the working directory and then every
+ * argument, each terminated by '\0'. The three standard file descriptors are attached to the header.
+ */
+struct JobHeader
+{
+	uint32_t magic;		/**< JOB_MAGIC */
+	uint32_t size;		/**< Size of the payload */
+	uint32_t argc;		/**< Number of arguments in the payload */
+};
+
+/**
+ * @brief Listens on socketPath and runs the jobs of the connecting clients one after the other.
+ * @details Returns when SIGINT or SIGTERM is received. The socket file is removed again.
+ * @param *socketPath The path of the Unix domain socket to create.
+ * @param job The function running a single job, called with the standard streams of the client installed.
+ * @return A value different from 0 if an error occurs, 0 otherwise.
+ */
+int runDaemon(const char *socketPath, int (*job)(int argc, char **argv));
+
+#endif /* SORTDAEMON_H */
@@ -0,0 +1,57 @@
+#!/bin/sh
+# Runs jobs of different kinds one after the other through one mysort daemon and compares their output
+# with mysort run directly.
+# Usage: tests/daemon_test.sh
+
+cd "$(dirname "$0")/.." || exit 1
+
+MYSORT_SOCKET=${TMPDIR:-/tmp}/mysort_test.$$.sock
+export MYSORT_SOCKET
+OUT=${TMPDIR:-/tmp}/mysort_test.$$.out
+EXPECTED=${TMPDIR:-/tmp}/mysort_test.$$.expected
+failed=0
+
+build/mysort --daemon "$MYSORT_SOCKET" &
+pid=$!
+sleep 0.2
+
+# runs a job through the daemon and directly, the outputs have to be equal
+check() {
+    build/mysortc "$@" > "$OUT"
+    status=$?
+    build/mysort "$@" > "$EXPECTED"
+    if [ "$status" -ne 0 ] || ! cmp -s "$OUT" "$EXPECTED"; then
+        echo "FAILED: mysortc $* (exit code $status)"
+        failed=1
+    else
+        echo "ok: mysortc $*"
+    fi
+}
+
+# a job in runs must leave stdout usable for the jobs after it
+check --run-size 2 tests/t1
+check tests/t1
+check -r tests/t1 tests/t2
+check --run-size 100 --spill tests/t2
+check tests/t1
+
+# failing jobs must not leave their files open in the daemon
+before=$(ls /proc/$pid/fd | wc -l)
+for i in 1 2 3; do
+    build/mysortc tests > /dev/null 2>&1
+    build/mysortc --run-size 2 -o "$OUT" tests > /dev/null 2>&1
+    build/mysortc --record-size 4 -o "$OUT" tests > /dev/null 2>&1
+done
+after=$(ls /proc/$pid/fd | wc -l)
+if [ "$after" -ne "$before" ]; then
+    echo "FAILED: failing jobs leaked $((after - before)) descriptors"
+    failed=1
+else
+    echo "ok: failing jobs closed their files"
+fi
+check tests/t1
+
+kill "$pid"
+wait "$pid"
+rm -f "$OUT" "$EXPECTED" "$MYSORT_SOCKET"
+exit $failed
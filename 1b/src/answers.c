@@ -0,0 +1,168 @@
+/**
+ * @file answers.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the answers module
+ */
+
+#include "answers.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if ANSWER_TABLES
+
+
+/* === Type Definitions === */
+
+/** @brief One table of a cache, the table comes first so that its address identifies the entry */
+struct cached_table {
+    uint8_t table[ANSWER_TABLE_SIZE];   /**< the marks of every guess */
+    uint16_t secret;                    /**< the secret, encoded like a guess */
+    bool valid;                         /**< the entry holds a table */
+    unsigned int refs;                  /**< number of games using the table */
+    unsigned long used;                 /**< time of the last acquisition, for the eviction */
+};
+
+struct answer_cache {
+    struct cached_table entries[ANSWER_CACHE_ENTRIES];
+    uint8_t plays[ANSWER_TABLE_SIZE];   /**< games per secret so far, saturating at ANSWER_TABLE_AFTER */
+    unsigned long clock;                /**< number of acquisitions so far */
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Fills the table for all guesses starting with the colors given so far
+ * @param table The table
+ * @param secret The secret
+ * @param left Colors of the secret not matched by the guess so far, per color
+ * @param slot The slot to fill next
+ * @param guess The guess so far
+ * @param red Red marks of the guess so far
+ * @param common Colors the guess so far has in common with the secret, regardless of their position
+ */
+static void fill_answers(uint8_t *table, const uint8_t *secret, uint8_t *left, int slot, unsigned int guess,
+    int red, int common);
+
+
+/* === Implementations === */
+
+static void fill_answers(uint8_t *table, const uint8_t *secret, uint8_t *left, int slot, unsigned int guess,
+    int red, int common)
+{
+    if (slot == SLOTS) {
+        /* every common color which is not red is white */
+        table[guess] = red | ((common - red) << MARK_WIDTH);
+        return;
+    }
+    /* values which are no color, if COLORS is no power of two, are walked as well and never match */
+    for (int color = 0; color < (1 << SHIFT_WIDTH); color++) {
+        int match = left[color] > 0;
+
+        left[color] -= match;
+        fill_answers(table, secret, left, slot + 1, guess | (color << (slot * SHIFT_WIDTH)),
+            red + (color == secret[slot]), common + match);
+        left[color] += match;
+    }
+}
+
+void build_answer_table(uint8_t *table, const uint8_t *secret)
+{
+    uint8_t left[1 << SHIFT_WIDTH];
+
+    /* the marks are updated per slot while walking the guesses, instead of marking each guess anew */
+    (void) memset(left, 0, sizeof left);
+    for (int j = 0; j < SLOTS; j++) {
+        left[secret[j]]++;
+    }
+    fill_answers(table, secret, left, 0, 0, 0, 0);
+}
+
+struct answer_cache *create_answer_cache(void)
+{
+    return calloc(1, sizeof (struct answer_cache));
+}
+
+void destroy_answer_cache(struct answer_cache *cache)
+{
+    free(cache);
+}
+
+const uint8_t *acquire_answer_table(struct answer_cache *cache, const uint8_t *secret)
+{
+    struct cached_table *victim = NULL;
+    uint16_t code = 0;
+
+    for (int j = 0; j < SLOTS; j++) {
+        code |= secret[j] << (j * SHIFT_WIDTH);
+    }
+    cache->clock++;
+    for (int i = 0; i < ANSWER_CACHE_ENTRIES; i++) {
+        struct cached_table *entry = &cache->entries[i];
+
+        if (entry->valid && entry->secret == code) {
+            entry->refs++;
+            entry->used = cache->clock;
+            return entry->table;
+        }
+        /* the least recently used table no game needs any more */
+        if (entry->refs == 0 && (victim == NULL || !entry->valid ||
+            (victim->valid && entry->used < victim->used))) {
+            victim = entry;
+        }
+    }
+
+    if (cache->plays[code] < ANSWER_TABLE_AFTER) {
+        cache->plays[code]++;
+        return NULL;
+    }
+    if (victim == NULL) {
+        return NULL;
+    }
+    if (victim->valid) {
+        /* the evicted secret has to earn its table again */
+        cache->plays[victim->secret] = 0;
+    }
+    build_answer_table(victim->table, secret);
+    victim->secret = code;
+    victim->valid = true;
+    victim->refs = 1;
+    victim->used = cache->clock;
+    return victim->table;
+}
+
+void release_answer_table(struct answer_cache *cache, const uint8_t *table)
+{
+    struct cached_table *entry = (struct cached_table *)table;
+
+    entry->refs--;
+}
+
+#else /* !ANSWER_TABLES */
+
+void build_answer_table(uint8_t *table, const uint8_t *secret)
+{
+}
+
+struct answer_cache *create_answer_cache(void)
+{
+    return NULL;
+}
+
+void destroy_answer_cache(struct answer_cache *cache)
+{
+}
+
+const uint8_t *acquire_answer_table(struct answer_cache *cache, const uint8_t *secret)
+{
+    return NULL;
+}
+
+void release_answer_table(struct answer_cache *cache, const uint8_t *table)
+{
+}
+
+#endif /* ANSWER_TABLES */
@@ -0,0 +1,82 @@
+/**
+ * @file answers.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Precomputed responses for secrets played in many games.
+ * @details A guess has 15 bits, so the marks of every possible guess against one secret fit into a table of
+ * 32 KiB, and a round becomes one table load and one parity check. Building a table costs as much as a few
+ * thousand rounds, therefore a cache only builds it for secrets which have already been played in
+ * ANSWER_TABLE_AFTER games, and all games with that secret share it. A cache belongs to one thread.
+ *
+ * Variants with longer codes or wider responses (see mastermind.h) have no tables, there a cache is never
+ * created and the games compute their marks.
+ */
+
+#ifndef ANSWERS_H
+#define ANSWERS_H
+
+#include <stdint.h>
+#include "game.h"
+
+/* === Constants === */
+
+/** @brief The variant has tables */
+#if CODE_BITS <= 16 && RESPONSE_BYTES == 1
+#define ANSWER_TABLES (1)
+#else
+#define ANSWER_TABLES (0)
+#endif
+
+/** @brief Number of possible guesses, i.e. entries of a table */
+#define ANSWER_TABLE_SIZE (1 << CODE_BITS)
+
+/** @brief Number of tables a cache keeps */
+#define ANSWER_CACHE_ENTRIES (32)
+
+/** @brief A secret gets a table once it has been played in this many games */
+#define ANSWER_TABLE_AFTER (64)
+
+
+/* === Type Definitions === */
+
+/** @brief The tables of the secrets played most often by one thread */
+struct answer_cache;
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Fills a table with the marks of every guess, without the parity and game lost bits
+ * @param table ANSWER_TABLE_SIZE bytes, indexed by the guess without its parity bit
+ * @param secret The secret
+ */
+void build_answer_table(uint8_t *table, const uint8_t *secret);
+
+/**
+ * @brief Creates an empty cache
+ * @return The cache, NULL if out of memory or the variant has no tables
+ */
+struct answer_cache *create_answer_cache(void);
+
+/**
+ * @brief Frees a cache, no table may be in use any more
+ */
+void destroy_answer_cache(struct answer_cache *cache);
+
+/**
+ * @brief Returns the table of a secret for a new game
+ * @details Tables in use are never evicted, so every call returning a table has to be paired with
+ * release_answer_table.
+ * @param cache The cache of the calling thread
+ * @param secret The secret of the game
+ * @return The table, NULL if the secret is not played often enough yet or the cache is full
+ */
+const uint8_t *acquire_answer_table(struct answer_cache *cache, const uint8_t *secret);
+
+/**
+ * @brief Gives back a table obtained from acquire_answer_table
+ */
+void release_answer_table(struct answer_cache *cache, const uint8_t *table);
+
+#endif /* ANSWERS_H */
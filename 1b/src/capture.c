@@ -0,0 +1,183 @@
+/**
+ * @file capture.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the capture module
+ */
+
+#include "capture.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Returns the monotonic time in nanoseconds
+ */
+static uint64_t monotonic_ns(void);
+
+/**
+ * @brief Appends the collected records of a writer to the file
+ */
+static void flush_writer(struct capture_writer *writer);
+
+
+/* === Implementations === */
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+int create_capture(struct capture *capture, const char *path)
+{
+    struct capture_header header;
+
+    (void) memset(&header, 0, sizeof header);
+    (void) memcpy(header.magic, CAPTURE_MAGIC, sizeof CAPTURE_MAGIC);
+    header.version = CAPTURE_VERSION;
+    header.record_size = sizeof (struct capture_record);
+    header.started = (uint64_t)time(NULL);
+    header.slots = SLOTS;
+    header.colors = COLORS;
+
+    /* O_APPEND keeps the writes of the loops from overwriting each other */
+    if ( (capture->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644)) < 0) {
+        return -1;
+    }
+    if (write(capture->fd, &header, sizeof header) != sizeof header) {
+        int error = (errno != 0) ? errno : EIO;
+        (void) close(capture->fd);
+        capture->fd = -1;
+        errno = error;
+        return -1;
+    }
+    capture->started = monotonic_ns();
+    capture->games = 0;
+    capture->dropped = 0;
+    return 0;
+}
+
+uint64_t close_capture(struct capture *capture)
+{
+    if (capture->fd >= 0) {
+        (void) close(capture->fd);
+        capture->fd = -1;
+    }
+    return capture->dropped;
+}
+
+struct capture_writer *open_capture_writer(struct capture *capture)
+{
+    struct capture_writer *writer = malloc(sizeof *writer);
+
+    if (writer != NULL) {
+        writer->capture = capture;
+        writer->count = 0;
+    }
+    return writer;
+}
+
+static void flush_writer(struct capture_writer *writer)
+{
+    size_t size = writer->count * sizeof writer->records[0];
+
+    if (writer->count == 0) {
+        return;
+    }
+    /* a short write would leave half a record, so only whole writes count */
+    if (write(writer->capture->fd, writer->records, size) != (ssize_t)size) {
+        (void) __atomic_fetch_add(&writer->capture->dropped, writer->count, __ATOMIC_RELAXED);
+    }
+    writer->count = 0;
+}
+
+void close_capture_writer(struct capture_writer *writer)
+{
+    if (writer != NULL) {
+        flush_writer(writer);
+        free(writer);
+    }
+}
+
+uint32_t capture_game(struct capture_writer *writer)
+{
+    return __atomic_fetch_add(&writer->capture->games, 1, __ATOMIC_RELAXED);
+}
+
+uint64_t capture_clock(const struct capture_writer *writer)
+{
+    return monotonic_ns() - writer->capture->started;
+}
+
+void capture_round(struct capture_writer *writer, uint64_t time, uint32_t game, mm_request_t guess,
+    mm_response_t response, int round)
+{
+    struct capture_record *record = &writer->records[writer->count++];
+
+    record->time = time;
+    record->game = game;
+    record->guess = guess;
+    record->response = response;
+    record->round = (uint8_t)round;
+    if (writer->count == CAPTURE_BATCH) {
+        flush_writer(writer);
+    }
+}
+
+int load_capture(const char *path, struct capture_record **records, size_t *count)
+{
+    struct capture_header header;
+    struct stat st;
+    size_t size;
+    int fd;
+
+    if ( (fd = open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) < 0) {
+        int error = errno;
+        (void) close(fd);
+        errno = error;
+        return -1;
+    }
+    if (read(fd, &header, sizeof header) != sizeof header ||
+        memcmp(header.magic, CAPTURE_MAGIC, sizeof CAPTURE_MAGIC) != 0 || header.version != CAPTURE_VERSION ||
+        header.record_size != sizeof (struct capture_record) || header.slots != SLOTS || header.colors != COLORS) {
+        (void) close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    *count = ((size_t)st.st_size - sizeof header) / sizeof **records;
+    size = *count * sizeof **records;
+    if ( (*records = malloc(size > 0 ? size : 1)) == NULL) {
+        (void) close(fd);
+        errno = ENOMEM;
+        return -1;
+    }
+    for (size_t done = 0; done < size; ) {
+        ssize_t r = read(fd, (char *)*records + done, size - done);
+
+        if (r <= 0) {
+            int error = (r < 0) ? errno : EINVAL;
+            free(*records);
+            (void) close(fd);
+            errno = error;
+            return -1;
+        }
+        done += (size_t)r;
+    }
+    (void) close(fd);
+    return 0;
+}
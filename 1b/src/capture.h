@@ -0,0 +1,130 @@
+/**
+ * @file capture.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Recording of the rounds played by the multi-client server into a binary file.
+ * @details The file starts with a struct capture_header followed by struct capture_record entries in host byte
+ * order, one per round: when it was played, the game it belongs to, the guess and the response. The
+ * records of the 5x8 game take 16 bytes, wider variants (see mastermind.h) have wider guesses and the header
+ * names the variant. Every game gets a new number, however it was played.
+ *
+ * Every event loop collects its records in a writer of its own and appends them CAPTURE_BATCH at a time
+ * with a single write, so the loops never wait for each other. The records of one game are in the order of
+ * its rounds, those of different loops are interleaved by batches; readers sort by time. Records which
+ * cannot be written are dropped and counted.
+ *
+ * mm-replay plays the games of a capture file against a server again.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mastermind.h"
+
+/* === Constants === */
+
+#define CAPTURE_MAGIC "MMCAPT"
+#define CAPTURE_VERSION (2)
+
+/** @brief Records a writer collects before appending them to the file */
+#define CAPTURE_BATCH (256)
+
+
+/* === Type Definitions === */
+
+/** @brief The header of a capture file */
+struct capture_header {
+    char magic[8];          /**< CAPTURE_MAGIC */
+    uint32_t version;       /**< CAPTURE_VERSION */
+    uint32_t record_size;   /**< sizeof (struct capture_record) */
+    uint64_t started;       /**< start of the capture, seconds since the epoch */
+    uint8_t slots;          /**< SLOTS of the variant */
+    uint8_t colors;         /**< COLORS of the variant */
+    uint8_t reserved[6];
+};
+
+/** @brief One round */
+struct capture_record {
+    uint64_t time;          /**< nanoseconds since the start of the capture */
+    uint32_t game;          /**< number of the game */
+    mm_request_t guess;     /**< the request as received, with its parity bit */
+    mm_response_t response; /**< the response sent */
+    uint8_t round;          /**< number of the round in its game, from 1 */
+};
+
+/** @brief An open capture file, shared by the loops */
+struct capture {
+    int fd;                 /**< the file, -1 if closed */
+    uint64_t started;       /**< monotonic time of the start in nanoseconds */
+    uint32_t games;         /**< numbers handed out, updated atomically */
+    uint64_t dropped;       /**< records which could not be written, updated atomically */
+};
+
+/** @brief The records of one loop not written yet */
+struct capture_writer {
+    struct capture *capture;
+    size_t count;
+    struct capture_record records[CAPTURE_BATCH];
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Creates or replaces a capture file and writes its header
+ * @return 0 on success, -1 otherwise (errno is set)
+ */
+int create_capture(struct capture *capture, const char *path);
+
+/**
+ * @brief Closes a capture file, all writers must be closed before
+ * @return Number of records which were dropped
+ */
+uint64_t close_capture(struct capture *capture);
+
+/**
+ * @brief Creates the writer of a loop
+ * @return The writer, NULL if out of memory
+ */
+struct capture_writer *open_capture_writer(struct capture *capture);
+
+/**
+ * @brief Writes the remaining records of a writer and frees it, NULL is ignored
+ */
+void close_capture_writer(struct capture_writer *writer);
+
+/**
+ * @brief Returns the number of a new game
+ */
+uint32_t capture_game(struct capture_writer *writer);
+
+/**
+ * @brief Returns the time for capture_round, nanoseconds since the start of the capture
+ */
+uint64_t capture_clock(const struct capture_writer *writer);
+
+/**
+ * @brief Records a round, the records are written when the writer is full
+ * @param writer The writer of the loop
+ * @param time The time the round was played, see capture_clock
+ * @param game Number of the game, see capture_game
+ * @param guess The request
+ * @param response The response
+ * @param round Number of the round in its game
+ */
+void capture_round(struct capture_writer *writer, uint64_t time, uint32_t game, mm_request_t guess,
+    mm_response_t response, int round);
+
+/**
+ * @brief Reads all records of a capture file
+ * @param path The file
+ * @param records Receives the records, to be freed by the caller
+ * @param count Receives their number
+ * @return 0 on success, -1 otherwise (errno is set, EINVAL if it is no capture file of the built variant)
+ */
+int load_capture(const char *path, struct capture_record **records, size_t *count);
+
+#endif /* CAPTURE_H */
@@ -4,6 +4,10 @@
  * @date 10.04.2015
  *
  * @brief This module takes the role of the codebreaker in the mastermind game.
+ * @details The server is given by its hostname and port, or as unix:<path> if it listens on a unix domain
+ * socket on the same machine. With -u the game is played over UDP against a server started with --udp:
+ * every guess is sent in a datagram with the game id and the round, and sent again if no response arrives
+ * in time.
  */
 
 #include <stdio.h>
@@ -15,28 +19,28 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netdb.h>
 #include <limits.h>
 #include <stdbool.h>
 #include <assert.h>
+#include <poll.h>
+#include <time.h>
+#include "mastermind.h"
+#include "solver.h"
+#include "transport.h"
 
 /* === Constants === */
-#define GUESS_BYTES (2)
-#define RESPONSE_BYTES (1)
-#define PARITY_ERR_BIT (6)
-#define GAME_LOST_ERR_BIT (7)
-
 #define EXIT_PARITY_ERROR (2)
 #define EXIT_GAME_LOST (3)
 #define EXIT_MULTIPLE_ERRORS (4)
 
-#define SLOTS (5)
-#define COLORS (8)
-#define STATUS_WIDTH (3)
-#define SHIFT_WIDTH (3)
+/* Prefix of a unix domain socket path given instead of a hostname and port */
+#define UNIX_PREFIX "unix:"
 
-static const uint8_t BITMASK_RED = 07;	// octal for 000 0111
-static const uint8_t BITMASK_WHITE = 070; // octal for 0011 1000
+/* Datagrams of the UDP mode (see mastermind.h): greeting, game id, round and guess or response */
+#define UDP_TIMEOUT_MS (200)
+#define UDP_RETRIES (10)
 
 
 /* === Macros === */
@@ -52,24 +56,10 @@ static const uint8_t BITMASK_WHITE = 070; // octal for 0011 1000
 struct client_params {
 	char *hostname;
 	char *port;
+	char *unix_path;	/*!< path of a unix domain socket, NULL for TCP */
+	bool udp;		/*!< play over UDP datagrams */
 };
 
-/** @brief the possible colors in the game */
-enum colors {beige = 0, darkblue, green, orange, red, black, violet, white};
-
-/** @brief a type representing a pattern of colors */
-typedef struct {
-	uint8_t colors[SLOTS];	/*!< Array to store the colors */
-	bool still_possible;	/*!< Boolean Value that indicates whether or not this pattern is still the searched code */
-} pattern;
-
-/** @brief a tye represemtomg a guess and the server's answer to it */
-typedef struct {
-	uint8_t *colors;	/*!< pointer to a colors array of size SLOTS */
-	uint8_t red;		/*!< server answer red pins */
-	uint8_t white;		/*!< server answer white pins */
-} guess;
-
 
 /* === Global Variables === */
 
@@ -79,14 +69,8 @@ static const char *progname = "client";
 /** @brief Socket file descriptor */
 static int sockfd = -1;
 
-/** @brief Array storing all the sent guesses with corresponding answers */
-static guess *guesses;
-
-/** @brief Array storing all the patterns and if they are still possible */
-static pattern *patterns;
-
-/** @brief Size of the patterns array, i.e. number of possible codes */
-static size_t patterns_size;
+/** @brief The solver choosing the guesses */
+static struct solver solver;
 
 
 /* === Prototypes === */
@@ -107,56 +91,56 @@ static void bail_out(int exitcode, const char *fmt, ...);
  */
 static void parse_args(int argc, char *argv[], struct client_params *params);
 
+/**
+ * @brief opens the socket to a mastermind server listening on a unix domain socket
+ * @param path the path of the socket
+ * @return the file descriptor from socket(2) if the connection can be established. Otherwise exit(EXIT_FAILURE)
+ */
+static int open_unix_socket(const char *path);
+
 /**
  * @brief opens the socket to the mastermind server
- * @param client_params hostname and portno
+ * @param client_params hostname and portno, or the path of a unix domain socket
  * @return the file descriptor from socket(2) if the connection can be established. Otherwise exit(EXIT_FAILURE)
  */
 static int open_client_socket(struct client_params params);
 
 /**
- * @brief free all used resources. Call before exit
- * @details global variables: sockfd, guesses, patterns
+ * @brief sends a guess over UDP and waits for its response, sending it again if none arrives in time
+ * @param sockfd the connected UDP socket
+ * @param game_id the id of the game
+ * @param round the round of the guess
+ * @param guess_bytes the guess as formatted by format_guess
+ * @return the response, exits with EXIT_FAILURE if the server does not answer
  */
-static void free_resources(void);
+static mm_response_t udp_exchange(int sockfd, uint32_t game_id, int round, mm_request_t guess_bytes);
 
 /**
- * @brief format a guess corresponding to the client-server communication protocol
- * @param the guess to format
- * @return the colors of the guess formated 3 bits per color with one parity bit
+ * @brief sends the greeting of the variant and checks that the server echoes it, nothing to do for
+ * WIRE_VERSION 1
+ * @param transport the transport over the connected stream socket
  */
-static uint16_t format_guess(guess *cur_guess);
+static void greet_server(struct transport *transport);
 
 /**
- * @brief validate the patterns corresponding to the last guess'es server response and
- * select from the still valid patterns the one to try next
- * @details global variables: patterns, guesses
- * @param *cur_guess a pointer to the guess, that shall be sent next
+ * @brief free all used resources. Call before exit
+ * @details global variables: sockfd, solver
  */
-static void calculate_next_guess(guess *cur_guess);
+static void free_resources(void);
 
 /**
- * @brief checks, if the result to a given guess could have been produced by a given pattern 
- * and sets the pattern's still_valid variable to false if not
- * @param *pattern pointer to the pattern
- * @param *guess pointer to the guess
+ * @brief format a guess corresponding to the client-server communication protocol
+ * @param colors the colors of the guess
+ * @return the colors of the guess formated SHIFT_WIDTH bits per color with one parity bit
  */
-static void validate_pattern(pattern *pattern, guess *guess);
+static mm_request_t format_guess(const uint8_t *colors);
 
 /**
- * @brief print an array of colors (as defined by enum colors) to a string
+ * @brief print an array of colors (as defined by COLOR_LETTERS) to a string
  * @param *colors pointer to the colors array
  * @param *dest pointer to the already allocated destination string with strlen == SLOTS
  */
-static void print_colors(uint8_t *colors, char *dest);
-
-/**
- * @brief calculate the power of an integer
- * @param base the base
- * @param exp the exponent
- * @return the power of the two numbers
- */
-static int powi(int base, int exp);
+static void print_colors(const uint8_t *colors, char *dest);
 
 
 /* === Implementations === */
@@ -185,11 +169,36 @@ static void parse_args(int argc, char *argv[], struct client_params *params)
     if(argc > 0) {
         progname = argv[0];
     }
+	params->unix_path = NULL;
+	params->udp = false;
+
+	int c;
+	while ( (c = getopt(argc, argv, "u")) != -1 ) {
+		switch (c) {
+		case 'u': /* ueber UDP spielen */
+			params->udp = true;
+			break;
+		default:  /* ungueltiges Argument */
+			bail_out(EXIT_FAILURE, "Usage: %s [-u] <server-hostname> <secret-port> | %s unix:<path>",
+				progname, progname);
+		}
+	}
+	argc -= optind - 1;
+	argv += optind - 1;
+
+	if (argc == 2 && !params->udp && strncmp(argv[1], UNIX_PREFIX, strlen(UNIX_PREFIX)) == 0) {
+		params->unix_path = argv[1] + strlen(UNIX_PREFIX);
+		if (*params->unix_path == '\0' ||
+			strlen(params->unix_path) >= sizeof ((struct sockaddr_un *)NULL)->sun_path) {
+			bail_out(EXIT_FAILURE, "Invalid unix domain socket path: %s", params->unix_path);
+		}
+		return;
+	}
 	if (argc != 3) {
-		bail_out(EXIT_FAILURE, "Usage: %s <server-hostname> <secret-port>", progname);
+		bail_out(EXIT_FAILURE, "Usage: %s [-u] <server-hostname> <secret-port> | %s unix:<path>",
+			progname, progname);
 	}
 	
-	progname = argv[0];
 	params->hostname = argv[1];
 	params->port = argv[2];
 	
@@ -214,6 +223,26 @@ static void parse_args(int argc, char *argv[], struct client_params *params)
     }
 }
 
+static int open_unix_socket(const char *path)
+{
+	DEBUG("Opening socket at %s\n", path);
+	struct sockaddr_un addr;
+	int sockfd;
+
+	if ( (sockfd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		bail_out(EXIT_FAILURE, "socket creation");
+	}
+	memset(&addr, 0, sizeof addr);
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof addr.sun_path - 1);
+	if ( connect(sockfd, (struct sockaddr *)&addr, sizeof addr) < 0) {
+		(void) close(sockfd);
+		bail_out(EXIT_FAILURE, "socket connection");
+	}
+	DEBUG("Successfully opened socket %d\n", sockfd);
+	return sockfd;
+}
+
 static int open_client_socket(struct client_params params)
 {
 	DEBUG("Opening socket at %s:%s\n", params.hostname, params.port);
@@ -222,10 +251,14 @@ static int open_client_socket(struct client_params params)
 	const char *errcause = NULL;
 	struct addrinfo hints;
 	struct addrinfo *ai, *ai_head;
+
+	if (params.unix_path != NULL) {
+		return open_unix_socket(params.unix_path);
+	}
 	
 	memset(&hints, 0, sizeof hints);
 	hints.ai_family = AF_INET;
-	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_socktype = params.udp ? SOCK_DGRAM : SOCK_STREAM;
 	hints.ai_flags = AI_PASSIVE;
 	
 	sock_error = getaddrinfo(params.hostname, params.port, &hints, &ai_head);
@@ -256,141 +289,88 @@ static int open_client_socket(struct client_params params)
 	return sockfd;
 }
 
-static void free_resources(void)
+static mm_response_t udp_exchange(int sockfd, uint32_t game_id, int round, mm_request_t guess_bytes)
 {
-    /* clean up resources */	
-    if(sockfd >= 0) {
-        (void) close(sockfd);
-    }
-	free(guesses);
-	free(patterns);
-	
-    DEBUG("Shutting down\n");
-}
+	uint8_t request[UDP_REQUEST_BYTES];
+	uint8_t response[UDP_RESPONSE_BYTES + 1];
+	uint8_t *header = &request[WIRE_HELLO_BYTES];
+	struct pollfd pfd = { .fd = sockfd, .events = POLLIN };
+
+	put_wire_hello(request);
+	for (int i = 0; i < 4; i++) {
+		header[i] = (game_id >> (8 * i)) & 0xff;
+	}
+	header[4] = round & 0xff;
+	header[5] = round >> 8;
+	put_request(&request[UDP_HEADER_BYTES], guess_bytes);
 
-static uint16_t format_guess(guess *cur_guess) {
-	
-	uint8_t *colors = cur_guess->colors;
-	uint16_t guess = 0;
-	uint8_t parity = 0;
-	uint8_t cur_color = 0;
-	
-	// encode the colors and calculate the parity
-	for (int i = SLOTS - 1; i >= 0; i--) {
-		
-		cur_color = colors[i];
-		assert (cur_color >= 0 && cur_color < COLORS);
-		guess <<= SHIFT_WIDTH;
-		guess |= cur_color;
-		parity ^= cur_color ^ (cur_color >> 1) ^ (cur_color >> 2);
+	for (int tries = 0; tries < UDP_RETRIES; tries++) {
+		if (send(sockfd, request, sizeof request, 0) < 0) {
+			bail_out(EXIT_FAILURE, "gameplay: write to server");
+		}
+		/* responses to earlier retransmissions are skipped */
+		while (poll(&pfd, 1, UDP_TIMEOUT_MS) > 0) {
+			ssize_t r = recv(sockfd, response, sizeof response, 0);
+			if (r == UDP_RESPONSE_BYTES && memcmp(response, request, UDP_HEADER_BYTES) == 0) {
+				return get_response(&response[UDP_HEADER_BYTES]);
+			}
+			if (r < 0 && errno != EINTR) {
+				bail_out(EXIT_FAILURE, "gameplay: read from server");
+			}
+		}
+		DEBUG("Round %d: no response, sending the guess again\n", round);
 	}
-	
-	parity &= 0x1;
-	guess |= (parity << (8 * GUESS_BYTES - 1));
-	
-	return guess;
+	errno = 0;
+	bail_out(EXIT_FAILURE, "gameplay: no response from server");
+	return 0;
 }
 
-static void calculate_next_guess(guess *cur_guess)
-{	
-	/* if this is the first guess, just return the first pattern from patterns */
-	if (cur_guess == guesses) {
-		cur_guess->colors = patterns[0].colors;
+static void greet_server(struct transport *transport)
+{
+	uint8_t hello[WIRE_HELLO_BYTES + 1];
+
+	if (WIRE_HELLO_BYTES == 0) {
 		return;
 	}
-	/* iterate over all the patterns and flag the impossible ones */
-	guess *last_guess = (cur_guess - 1);
-	for (int i=0; i < patterns_size; i++) {
-		if (patterns[i].still_possible == true) {
-			validate_pattern(&patterns[i], last_guess);
-		}
+	put_wire_hello(hello);
+	if (transport->write(transport, hello, WIRE_HELLO_BYTES) < 0) {
+		bail_out(EXIT_FAILURE, "greeting: write to server");
 	}
-	/* select the first possible pattern */
-	for (int i=0; i < patterns_size; i++) {
-		if (patterns[i].still_possible == true) {
-			cur_guess->colors = patterns[i].colors;
-			break;
-		}
+	/* a server of another variant just closes the connection */
+	if (read_exactly(transport, hello, WIRE_HELLO_BYTES) < 0) {
+		bail_out(EXIT_FAILURE, "greeting: read from server");
+	}
+	if (!wire_hello_ok(hello)) {
+		errno = 0;
+		bail_out(EXIT_FAILURE, "The server plays another variant");
 	}
-	
-	return;
 }
 
-static void validate_pattern(pattern *pattern, guess *guess)
+static void free_resources(void)
 {
-	/* marking red and white */
-	int colors_left[COLORS];
-	int j;
-	int red = 0;
-	int white = 0;
-	
-    (void) memset(&colors_left[0], 0, sizeof(colors_left));
-	
-    for (j = 0; j < SLOTS; ++j) {
-        /* mark red */
-        if (guess->colors[j] == pattern->colors[j]) {
-            red++;
-        } else {
-            colors_left[pattern->colors[j]]++;
-        }
-    }
-    for (j = 0; j < SLOTS; ++j) {
-        /* not marked red */
-        if (guess->colors[j] != pattern->colors[j]) {
-            if (colors_left[guess->colors[j]] > 0) {
-                white++;
-                colors_left[guess->colors[j]]--;
-            }
-        }
+    /* clean up resources */	
+    if(sockfd >= 0) {
+        (void) close(sockfd);
     }
+	destroy_solver(&solver);
 	
-	if (red != guess->red || white != guess->white) {
-		pattern->still_possible = false;
-	}
+    DEBUG("Shutting down\n");
 }
 
-static int powi(int base, int exp)
-{
-	int res = 1;
-	for(int i=0; i < exp; i++) {
-		res *= base;
-	}
+static mm_request_t format_guess(const uint8_t *colors) {
 	
-	return res;
+	for (int i = 0; i < SLOTS; i++) {
+		assert (colors[i] < COLORS);
+	}
+	// encode the colors, the parity bit makes the parity of the request even
+	return make_request(encode_code(colors));
 }
 
-static void print_colors(uint8_t *colors, char *dest) 
+static void print_colors(const uint8_t *colors, char *dest) 
 {
 	for (int i=0; i < SLOTS; i++) {
-		switch (colors[i])
-		{
-			case beige: 
-				dest[i] = 'b';
-				break;
-			case darkblue: 
-				dest[i] = 'd';
-				break;
-			case green: 
-				dest[i] = 'g';
-				break;
-			case orange: 
-				dest[i] = 'o';
-				break;
-			case red: 
-				dest[i] = 'r';
-				break;
-			case black: 
-				dest[i] = 's';
-				break;
-			case violet: 
-				dest[i] = 'v';
-				break;
-			case white: 
-				dest[i] = 'w';
-				break;
-			default:
-				assert(0);
-		}
+		assert(colors[i] < COLORS);
+		dest[i] = COLOR_LETTERS[colors[i]];
 	}
 	dest[SLOTS] = '\0';	// correctly terminate the string
 }
@@ -407,91 +387,84 @@ int main(int argc, char *argv[])
 	struct client_params params;
 	parse_args(argc, argv, &params);
 	
+	/* Game Preparations */
+	DEBUG("Creating the solver\n");
+	if (create_solver(&solver) < 0) {
+		if (errno == E2BIG) {
+			errno = 0;
+			bail_out(EXIT_FAILURE, "%d slots of %d colors are too many codes to solve", SLOTS, COLORS);
+		}
+		bail_out(EXIT_FAILURE, "malloc");
+	}
+	
 	/* set up the socket */
-	int sockfd;
+	struct socket_transport transport;
 	sockfd = open_client_socket(params);
+	open_socket_transport(&transport, sockfd);
+	if (!params.udp) {
+		greet_server(&transport.transport);
+	}
 		
 	/* Game Variable Declarations */
-	size_t guesses_size = 0;
-	uint16_t guess_bytes;
-	uint8_t response_byte;
+	const uint8_t *colors;
+	mm_request_t guess_bytes;
+	mm_response_t response;
+	unsigned int red, white;
+	uint8_t buffer[REQUEST_BYTES > RESPONSE_BYTES ? REQUEST_BYTES : RESPONSE_BYTES];
 	int ret = EXIT_SUCCESS;
 	int error = 0;
 	int round = 0;
+	uint32_t game_id = (uint32_t)getpid() ^ ((uint32_t)time(NULL) << 16);
 	char color_str[SLOTS + 1];
-	patterns_size = (size_t)powi(COLORS,SLOTS);
-	
-	/* Game Preparations */
-	DEBUG("Allocating patterns and guesses array\n");
-	if ( (guesses = malloc(8 * (sizeof (guess)))) == NULL ) {
-		bail_out(EXIT_FAILURE, "realloc");
-	}
-	if ( (patterns = malloc(patterns_size * sizeof (pattern))) == NULL) {
-		bail_out(EXIT_FAILURE, "malloc");
-	}
-	for (int i=0; i < patterns_size; i++) {
-			for (int slot=0; slot < SLOTS; slot++) {
-				patterns[i].colors[slot] = (i / (int)powi(COLORS,slot)) % COLORS;
-			}
-			patterns[i].still_possible = true;
-	}
 	
 	DEBUG("Starting the game\n"); /* play the game */
+	start_solving(&solver);
 	while (!error) {
 		round++;
 		
-		// alloc space for next guess if necessary
-		if ( round > guesses_size ) {
-			if ( (guesses = realloc(guesses, round * (sizeof (guess)))) == NULL) {
-				bail_out(EXIT_FAILURE, "realloc");
-			}
-			guesses_size = round;
-		}
-		guess *cur_guess = &guesses[round - 1];
-		memset(cur_guess, 0, (sizeof (guess)));
-		
 		// compute and format next guess
-		calculate_next_guess(cur_guess);
-		guess_bytes = format_guess(cur_guess);
-		print_colors(cur_guess->colors, &color_str[0]);
-		DEBUG("Round %d: Guess: 0x%x, meaning \"%s\"\n", round, guess_bytes, color_str);
-		
-		// send guess to server
-		if ( send(sockfd, (const void *)&guess_bytes, GUESS_BYTES, 0) < 0) {
-			bail_out(EXIT_FAILURE, "gameplay: write to server");
-		}	
+		if ( (colors = next_guess(&solver)) == NULL) {
+			errno = 0;
+			bail_out(EXIT_FAILURE, "gameplay: no code gives these responses");
+		}
+		guess_bytes = format_guess(colors);
+		print_colors(colors, &color_str[0]);
+		DEBUG("Round %d: Guess: 0x%llx, meaning \"%s\"\n", round, (unsigned long long)guess_bytes, color_str);
 		
-	    // read from server
-	    size_t bytes_recv = 0;
-	    do {	// loop, as packet can arrive in several partial reads
-	        ssize_t r;
-	        r = recv(sockfd, &response_byte + bytes_recv, RESPONSE_BYTES - bytes_recv, 0);
-	        if (r <= 0) {
-	            bail_out(EXIT_FAILURE, "gameplay: read from server");
-	        }
-	        bytes_recv += r;
-	    } while (bytes_recv < RESPONSE_BYTES);
-	    if (bytes_recv < RESPONSE_BYTES) {
-	        bail_out(EXIT_FAILURE, "gameplay: read from server");
-	    }	
+		if (params.udp) {
+			response = udp_exchange(sockfd, game_id, round, guess_bytes);
+		} else {
+			// send guess to server
+			put_request(buffer, guess_bytes);
+			if (transport.transport.write(&transport.transport, buffer, REQUEST_BYTES) < 0) {
+				bail_out(EXIT_FAILURE, "gameplay: write to server");
+			}	
+
+		    // read from server, the response can arrive in several partial reads
+		    if (read_exactly(&transport.transport, buffer, RESPONSE_BYTES) < 0) {
+		        bail_out(EXIT_FAILURE, "gameplay: read from server");
+		    }
+		    response = get_response(buffer);
+		}
 		
 		// decode server answer
-		cur_guess->red = response_byte & BITMASK_RED;
-		cur_guess->white = (response_byte & BITMASK_WHITE) >> SHIFT_WIDTH;
-		if (cur_guess->red == SLOTS) {
+		red = RED_OF(response);
+		white = WHITE_OF(response);
+		if (red == SLOTS) {
 			ret = EXIT_SUCCESS;
 			printf("Runden: %d\n", round);
 			break;
 		}
-		DEBUG("Round %d: Response: 0x%x, meaning %u red, %u white\n", round, response_byte, cur_guess->red, cur_guess->white);
+		DEBUG("Round %d: Response: 0x%x, meaning %u red, %u white\n", round, response, red, white);
+		add_response(&solver, red, white);
 		
 		// check for parity error or game over
-		if (response_byte & (1<<PARITY_ERR_BIT)) {
+		if (response & (1 << PARITY_ERR_BIT)) {
 			(void) fprintf(stderr, "%s: Parity error\n", progname);	
 			error = 1;
 			ret = EXIT_PARITY_ERROR;
 		}
-		if (response_byte & (1 << GAME_LOST_ERR_BIT)) {
+		if (response & (1 << GAME_LOST_ERR_BIT)) {
 			(void) fprintf(stderr, "%s: Game lost\n", progname);
          		error = 1;
          		if (ret == EXIT_PARITY_ERROR) {
@@ -0,0 +1,438 @@
+/**
+ * @file eventloop.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the eventloop module
+ */
+
+#define _GNU_SOURCE	/* accept4 */
+#include "eventloop.h"
+#include "answers.h"
+#include "session.h"
+#include "slab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+
+/* === Constants === */
+
+#define MAX_EVENTS (256)
+
+/** @brief Most bytes received from a connection at once */
+#define RECV_BYTES (512)
+
+/** @brief Marks the listening socket in the epoll data */
+#define LISTENER_TAG (NULL)
+
+/** @brief Marks the wake descriptor in the epoll data */
+#define WAKE_TAG ((void *)&wake_marker)
+
+
+/* === Macros === */
+
+#ifdef _ENDEBUG
+#define DEBUG(...) do { fprintf(stderr, __VA_ARGS__); } while(0)
+#else
+#define DEBUG(...)
+#endif
+
+
+/* === Type Definitions === */
+
+/** @brief A session watched by epoll */
+struct connection {
+    struct session session;     /**< the protocol state, first member */
+    bool want_out;              /**< true while the connection is watched for EPOLLOUT */
+};
+
+/** @brief The state of an event loop */
+struct loop {
+    int epfd;                           /**< the epoll instance */
+    int listenfd;                       /**< the listening socket */
+    int spare_fd;                       /**< reserved descriptor to shed clients if the limit is reached */
+    const struct loop_config *config;   /**< the game configuration */
+    struct secret_picker secrets;       /**< hands out the secrets of this loop */
+    struct answer_cache *answers;       /**< tables of the secrets played often, NULL if out of memory */
+    struct game_stats *stats;           /**< results of the games played */
+    struct loop_metrics *metrics;       /**< the live counters of this loop, NULL for none */
+    struct session_context sessions;    /**< the capture writer and the pending input of the sessions */
+    struct slab connections;            /**< the connections, found by their file descriptor */
+    struct timer_wheel timers;          /**< deadlines of the connections, in ticks of SESSION_TICK_MS */
+    uint64_t now;                       /**< the time after the last wait, see session_clock */
+};
+
+
+/* === Global Variables === */
+
+/** @brief Only its address is used, see WAKE_TAG */
+static const char wake_marker;
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Accepts all pending connections
+ * @return 0 on success, -1 on a fatal error
+ */
+static int accept_clients(struct loop *loop);
+
+/**
+ * @brief Creates the session of a freshly accepted connection
+ * @return 0 on success, -1 otherwise (the connection is closed)
+ */
+static int open_session(struct loop *loop, int fd);
+
+/**
+ * @brief Unregisters, closes and frees a session
+ */
+static void close_session(struct loop *loop, struct connection *conn);
+
+/**
+ * @brief Handles the events of a session
+ */
+static void handle_session(struct loop *loop, struct connection *conn, uint32_t events);
+
+/**
+ * @brief Closes a connection which ran out of time, its game is lost
+ * @param timer The timer of the session
+ * @param arg The loop
+ */
+static void expire_session(struct timer *timer, void *arg);
+
+/**
+ * @brief Reads what has arrived and answers every complete request
+ * @return 0 if the connection is fine, -1 if it has to be closed
+ */
+static int read_guesses(struct loop *loop, struct session *session);
+
+/**
+ * @brief Sends as much of the pending responses as possible
+ * @return 0 if the connection is fine, -1 if it has to be closed
+ */
+static int flush_responses(struct loop *loop, struct session *session);
+
+
+/* === Implementations === */
+
+int raise_fd_limit(void)
+{
+    struct rlimit limit;
+
+    if (getrlimit(RLIMIT_NOFILE, &limit) < 0) {
+        return -1;
+    }
+    if (limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &limit) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int accept_clients(struct loop *loop)
+{
+    for (;;) {
+        int fd = accept4(loop->listenfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd < 0) {
+            switch (errno) {
+            case EAGAIN:
+#if EAGAIN != EWOULDBLOCK
+            case EWOULDBLOCK:
+#endif
+                return 0;
+            case EINTR:
+            case ECONNABORTED:
+            case EPROTO:
+                continue;
+            case EMFILE:
+            case ENFILE:
+                /* out of descriptors: accept with the spare one and drop the client right away,
+                   otherwise the level-triggered listener would keep the loop spinning */
+                if (loop->spare_fd >= 0) {
+                    (void) close(loop->spare_fd);
+                    fd = accept(loop->listenfd, NULL, NULL);
+                    if (fd >= 0) {
+                        (void) close(fd);
+                    }
+                    loop->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                }
+                (void) fprintf(stderr, "server: too many open files, dropped a client\n");
+                return 0;
+            default:
+                return -1;
+            }
+        }
+        (void) open_session(loop, fd);
+    }
+}
+
+static int open_session(struct loop *loop, int fd)
+{
+    struct connection *conn;
+    struct epoll_event ev;
+    uint8_t secret[SLOTS];
+    int optval = 1;
+
+    if ( (conn = slab_alloc(&loop->connections, fd)) == NULL) {
+        (void) close(fd);
+        return -1;
+    }
+    next_secret(&loop->secrets, secret);
+    start_session(&conn->session, &loop->sessions, fd, secret, loop->now);
+    conn->want_out = false;
+    if (loop->answers != NULL) {
+        conn->session.game.answers = acquire_answer_table(loop->answers, secret);
+    }
+
+    /* the responses are single bytes which must not wait for anything */
+    (void) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof optval);
+
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.ptr = conn;
+    if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        if (conn->session.game.answers != NULL) {
+            release_answer_table(loop->answers, conn->session.game.answers);
+        }
+        slab_free(&loop->connections, fd);
+        (void) close(fd);
+        return -1;
+    }
+    if (loop->metrics != NULL) {
+        METRIC_ADD(loop->metrics->games_started, 1);
+    }
+    update_session_timer(&loop->timers, &conn->session, &loop->sessions, &loop->config->limits, loop->now);
+    DEBUG("Accepted client on %d\n", fd);
+    return 0;
+}
+
+static void close_session(struct loop *loop, struct connection *conn)
+{
+    struct session *session = &conn->session;
+
+    DEBUG("Closing client on %d after %d rounds, result %d\n", session->fd, session->game.round,
+        session->game.result);
+    record_game(loop->stats, &session->game);
+    if (loop->metrics != NULL) {
+        count_game(loop->metrics, &session->game);
+    }
+    if (session->game.answers != NULL) {
+        release_answer_table(loop->answers, session->game.answers);
+    }
+    end_session(session, &loop->sessions);
+    cancel_timer(&loop->timers, &session->timer);
+    (void) epoll_ctl(loop->epfd, EPOLL_CTL_DEL, session->fd, NULL);
+    slab_free(&loop->connections, session->fd);
+    (void) close(session->fd);
+}
+
+static void expire_session(struct timer *timer, void *arg)
+{
+    struct loop *loop = arg;
+    struct session *session = SESSION_OF_TIMER(timer);
+
+    DEBUG("Client %d ran out of time\n", session->fd);
+    expire_game(&session->game);
+    close_session(loop, (struct connection *)session);
+}
+
+static int read_guesses(struct loop *loop, struct session *session)
+{
+    uint8_t buffer[RECV_BYTES];
+    ssize_t r;
+
+    r = recv(session->fd, buffer, sizeof buffer, 0);
+    if (r == 0) {
+        return -1;  /* the client went away */
+    }
+    if (r < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+    if (loop->metrics != NULL) {
+        METRIC_ADD(loop->metrics->bytes_in, (uint64_t)r);
+    }
+    return feed_session(session, &loop->sessions, buffer, (size_t)r);
+}
+
+static int flush_responses(struct loop *loop, struct session *session)
+{
+    while (session->out_sent < session->out_len) {
+        ssize_t w = send(session->fd, &session->out[session->out_sent],
+            session->out_len - session->out_sent, MSG_NOSIGNAL);
+
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        if (loop->metrics != NULL) {
+            METRIC_ADD(loop->metrics->bytes_out, (uint64_t)w);
+        }
+        if (responses_sent(session, &loop->sessions, (size_t)w) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void handle_session(struct loop *loop, struct connection *conn, uint32_t events)
+{
+    struct session *session = &conn->session;
+    int round = session->game.round;
+    uint64_t received = (loop->metrics != NULL) ? metrics_clock() : 0;
+
+    if (events & EPOLLERR) {
+        close_session(loop, conn);
+        return;
+    }
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP) && read_guesses(loop, session) < 0) {
+        close_session(loop, conn);
+        return;
+    }
+    if (flush_responses(loop, session) < 0) {
+        close_session(loop, conn);
+        return;
+    }
+    /* sending the responses may play the requests waiting for them, a client reading is not idle either */
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP) || session->game.round != round) {
+        update_session_timer(&loop->timers, session, &loop->sessions, &loop->config->limits, loop->now);
+    }
+    if (loop->metrics != NULL && session->game.round != round) {
+        count_rounds(loop->metrics, (unsigned int)(session->game.round - round), metrics_clock() - received);
+    }
+
+    bool pending = session->out_sent < session->out_len;
+    if (SESSION_OVER(session) && !pending) {
+        /* unread input would make close(2) reset the connection and destroy the last responses */
+        uint8_t scratch[64];
+        while (recv(session->fd, scratch, sizeof scratch, 0) > 0) {
+            continue;
+        }
+        close_session(loop, conn);
+        return;
+    }
+    if (pending != conn->want_out) {
+        struct epoll_event ev;
+
+        ev.events = EPOLLIN | EPOLLRDHUP | (pending ? EPOLLOUT : 0);
+        ev.data.ptr = conn;
+        if (epoll_ctl(loop->epfd, EPOLL_CTL_MOD, session->fd, &ev) < 0) {
+            close_session(loop, conn);
+            return;
+        }
+        conn->want_out = pending;
+    }
+}
+
+int run_event_loop(int listenfd, const struct loop_config *config, unsigned int id, struct game_stats *stats,
+    volatile sig_atomic_t *quit)
+{
+    struct epoll_event events[MAX_EVENTS];
+    struct epoll_event ev;
+    struct loop loop;
+    int ret = 0;
+
+    (void) memset(&loop, 0, sizeof loop);
+    loop.listenfd = listenfd;
+    loop.config = config;
+    loop.stats = stats;
+    loop.metrics = (config->metrics != NULL) ? loop_metrics(config->metrics, id) : NULL;
+    init_picker(&loop.secrets, config->secrets, id);
+    loop.now = session_clock();
+    init_timer_wheel(&loop.timers, loop.now / SESSION_TICK_MS);
+    loop.spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+    if (fcntl(listenfd, F_SETFL, fcntl(listenfd, F_GETFL) | O_NONBLOCK) < 0 ||
+        (loop.epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        if (loop.spare_fd >= 0) (void) close(loop.spare_fd);
+        return -1;
+    }
+    if (create_slab(&loop.connections, sizeof (struct connection)) < 0) {
+        ret = -1;
+        goto cleanup;
+    }
+    loop.answers = create_answer_cache();   /* only an optimization, fine without */
+    init_session_context(&loop.sessions, NULL, loop.now);
+    if (config->capture != NULL && (loop.sessions.capture = open_capture_writer(config->capture)) == NULL) {
+        errno = ENOMEM;
+        ret = -1;
+        goto cleanup;
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = LISTENER_TAG;
+    if (epoll_ctl(loop.epfd, EPOLL_CTL_ADD, listenfd, &ev) < 0) {
+        ret = -1;
+        goto cleanup;
+    }
+    if (config->wake_fd >= 0) {
+        ev.events = EPOLLIN;
+        ev.data.ptr = WAKE_TAG;
+        if (epoll_ctl(loop.epfd, EPOLL_CTL_ADD, config->wake_fd, &ev) < 0) {
+            ret = -1;
+            goto cleanup;
+        }
+    }
+
+    while (!*quit) {
+        /* while there are deadlines the loop wakes up every tick */
+        int n = epoll_wait(loop.epfd, events, MAX_EVENTS, loop.timers.count > 0 ? SESSION_TICK_MS : -1);
+
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ret = -1;
+            break;
+        }
+        loop.now = session_clock();
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == WAKE_TAG) {
+                goto cleanup;
+            }
+            if (events[i].data.ptr == LISTENER_TAG) {
+                if (accept_clients(&loop) < 0) {
+                    ret = -1;
+                    goto cleanup;
+                }
+            } else {
+                handle_session(&loop, events[i].data.ptr, events[i].events);
+            }
+        }
+        (void) advance_timer_wheel(&loop.timers, loop.now / SESSION_TICK_MS, expire_session, &loop);
+    }
+
+cleanup:
+    if (ret < 0) {
+        ret = -errno;   /* keep errno across the cleanup */
+    }
+    for (size_t fd = 0; fd < loop.connections.fd_high; fd++) {
+        struct connection *conn = slab_find(&loop.connections, (int)fd);
+
+        if (conn != NULL) {
+            close_session(&loop, conn);
+        }
+    }
+    destroy_slab(&loop.connections);
+    destroy_answer_cache(loop.answers);
+    destroy_session_context(&loop.sessions);
+    close_capture_writer(loop.sessions.capture);
+    (void) close(loop.epfd);
+    if (loop.spare_fd >= 0) {
+        (void) close(loop.spare_fd);
+    }
+    if (ret < 0) {
+        errno = -ret;
+        return -1;
+    }
+    return 0;
+}
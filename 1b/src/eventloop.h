@@ -0,0 +1,58 @@
+/**
+ * @file eventloop.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Long-running multi-client mode of the mastermind server.
+ * @details One thread serves any number of clients with an epoll event loop on non-blocking sockets. Every
+ * connection is a small state machine playing its own game: guesses may arrive in arbitrary pieces, every
+ * complete guess is answered immediately and the connection is closed once the game is over and the last
+ * response has been sent. A connection whose client exceeds a time limit of the configuration is closed
+ * and its game counts as lost. The connections live in a slab (see slab.h) reserved when the loop starts.
+ */
+
+#ifndef EVENTLOOP_H
+#define EVENTLOOP_H
+
+#include <signal.h>
+#include <stdint.h>
+#include "game.h"
+#include "secrets.h"
+#include "session.h"
+#include "metrics.h"
+#include "capture.h"
+
+/* === Type Definitions === */
+
+/** @brief The configuration of an event loop */
+struct loop_config {
+    struct secret_source *secrets;  /**< where the secrets of the games come from */
+    int wake_fd;                    /**< the loop stops as soon as this descriptor becomes readable, -1 for none */
+    struct session_limits limits;   /**< time limits of the connections */
+    struct metrics *metrics;        /**< live counters with a block per loop id, NULL for none */
+    struct capture *capture;        /**< records the rounds of all loops, NULL for none */
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Raises the limit of open file descriptors as far as allowed, so that many clients can connect
+ * @return 0 on success, -1 otherwise
+ */
+int raise_fd_limit(void);
+
+/**
+ * @brief Accepts clients on listenfd and plays their games until *quit is set or config->wake_fd is readable
+ * @details Every loop keeps its state to itself, so several loops may run in different threads.
+ * @param listenfd The listening socket, it is made non-blocking
+ * @param config The configuration of the games
+ * @param id Number of the loop, unique among the loops sharing config
+ * @param stats Receives the results of all games played by the loop, including those aborted at the end
+ * @param quit Flag set by a signal handler to stop the loop
+ * @return 0 if the loop was stopped by quit, -1 on error (errno is set)
+ */
+int run_event_loop(int listenfd, const struct loop_config *config, unsigned int id, struct game_stats *stats,
+    volatile sig_atomic_t *quit);
+
+#endif /* EVENTLOOP_H */
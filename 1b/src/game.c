@@ -0,0 +1,120 @@
+/**
+ * @file game.c
+ * @author OSUE Team <osue-team@vmars.tuwien.ac.at>,
+ *         Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the game module
+ */
+
+#include "game.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+/* === Implementations === */
+
+int compute_answer(mm_request_t req, mm_response_t *resp, const uint8_t *secret)
+{
+    /* the kernel of the built variant, with the loops over the slots and colors unrolled */
+    unsigned int marks = mm_marks(req & CODE_MASK, encode_code(secret));
+
+    resp[0] = (mm_response_t)marks;
+    if (!request_parity_ok(req)) {
+        resp[0] |= 1 << PARITY_ERR_BIT;
+        return -1;
+    }
+    return (int)RED_OF(marks);
+}
+
+void start_game(struct game *game, const uint8_t *secret)
+{
+    (void) memcpy(game->secret, secret, SLOTS);
+    game->round = 0;
+    game->result = GAME_RUNNING;
+    game->answers = NULL;
+    game->expired = false;
+}
+
+int play_round(struct game *game, mm_request_t req, mm_response_t *resp)
+{
+    int correct_guesses;
+    int result = GAME_RUNNING;
+
+    if (game->answers != NULL) {
+        /* the parity bit makes the parity of the whole request even */
+        resp[0] = game->answers[req & CODE_MASK];
+        correct_guesses = RED_OF(resp[0]);
+        if (!request_parity_ok(req)) {
+            resp[0] |= 1 << PARITY_ERR_BIT;
+            correct_guesses = -1;
+        }
+    } else {
+        correct_guesses = compute_answer(req, resp, game->secret);
+    }
+
+    game->round++;
+    if (game->round >= MAX_TRIES && correct_guesses != SLOTS) {
+        resp[0] |= 1 << GAME_LOST_ERR_BIT;
+    }
+
+    if (resp[0] & (1 << PARITY_ERR_BIT)) {
+        result = EXIT_PARITY_ERROR;
+    }
+    if (resp[0] & (1 << GAME_LOST_ERR_BIT)) {
+        result = (result == EXIT_PARITY_ERROR) ? EXIT_MULTIPLE_ERRORS : EXIT_GAME_LOST;
+    }
+    if (result == GAME_RUNNING && correct_guesses == SLOTS) {
+        result = EXIT_SUCCESS;
+    }
+    game->result = result;
+    return result;
+}
+
+int play_batch(struct game *game, const uint8_t *requests, size_t count, uint8_t *resp, size_t *answered)
+{
+    int result = GAME_RUNNING;
+    size_t i;
+
+    for (i = 0; i < count && result == GAME_RUNNING; i++) {
+        mm_response_t response;
+
+        result = play_round(game, get_request(&requests[REQUEST_BYTES * i]), &response);
+        put_response(&resp[RESPONSE_BYTES * i], response);
+    }
+    *answered = i;
+    return result;
+}
+
+void expire_game(struct game *game)
+{
+    if (game->result == GAME_RUNNING) {
+        game->result = EXIT_GAME_LOST;
+        game->expired = true;
+    }
+}
+
+void record_game(struct game_stats *stats, const struct game *game)
+{
+    stats->games++;
+    stats->rounds += game->round;
+    if (game->result == GAME_RUNNING) {
+        stats->aborted++;
+    } else {
+        stats->results[game->result]++;
+    }
+    if (game->expired) {
+        stats->expired++;
+    }
+}
+
+void merge_stats(struct game_stats *into, const struct game_stats *from)
+{
+    into->games += from->games;
+    into->aborted += from->aborted;
+    into->expired += from->expired;
+    into->rounds += from->rounds;
+    for (size_t i = 0; i < sizeof into->results / sizeof into->results[0]; i++) {
+        into->results[i] += from->results[i];
+    }
+}
@@ -0,0 +1,120 @@
+/**
+ * @file game.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief The rules of the mastermind game as applied by the server.
+ * @details A game knows its secret, the number of rounds played and its result. Every request of the client is
+ * answered with one response byte; once the game is over its result stays in the game, so a server playing
+ * many games can collect them in a struct game_stats.
+ *
+ * The parameters of the game and the wire format of requests and responses are in mastermind.h.
+ *
+ * Batch protocol: a client may open a game with the request BATCH_HELLO instead of a guess. A server which
+ * knows the extension answers with the response BATCH_ACK and does not count this as a round; an older
+ * server answers with a parity error, as the hello is a guess with a wrong parity bit. After the
+ * acknowledgement every request is a batch: one byte with the number of guesses (1 to MAX_BATCH) followed
+ * by the guesses, REQUEST_BYTES each as usual. The reply is one byte with the number of answered guesses
+ * followed by their responses. Every guess of a batch is a round of its own: the game ends with the first
+ * guess which wins, has a parity error or is the MAX_TRIES-th guess, that response carries the
+ * GAME_LOST_ERR_BIT as usual, and the remaining guesses of the batch are neither played nor answered.
+ */
+
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mastermind.h"
+
+/* === Constants === */
+
+#define EXIT_PARITY_ERROR (2)
+#define EXIT_GAME_LOST (3)
+#define EXIT_MULTIPLE_ERRORS (4)
+
+/** @brief Result of a game which is not over yet */
+#define GAME_RUNNING (-1)
+
+/** @brief Largest number of guesses in a batch, no game takes more */
+#define MAX_BATCH (MAX_TRIES)
+
+
+/* === Type Definitions === */
+
+/** @brief The state of a single game, ordered without padding between the fields */
+struct game {
+    const uint8_t *answers; /**< the marks of every code against the secret (see answers.h), NULL to compute them */
+    int round;              /**< number of rounds played so far */
+    int result;             /**< GAME_RUNNING or the result of the game, see play_round */
+    uint8_t secret[SLOTS];  /**< the colors the client has to guess */
+    bool expired;           /**< a time limit of the server ran out, the game is lost */
+};
+
+/** @brief The results of many games */
+struct game_stats {
+    unsigned long games;                                /**< finished or aborted games */
+    unsigned long results[EXIT_MULTIPLE_ERRORS + 1];    /**< games per result, indexed by the result */
+    unsigned long aborted;                              /**< games the client left before the end */
+    unsigned long expired;                              /**< games lost by a time limit, also in results */
+    unsigned long rounds;                               /**< rounds of all games */
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Compute answer to request
+ * @param req Client's guess
+ * @param resp Buffer that will be sent to the client
+ * @param secret The server's secret
+ * @return Number of correct matches on success; -1 in case of a parity error
+ */
+int compute_answer(mm_request_t req, mm_response_t *resp, const uint8_t *secret);
+
+/**
+ * @brief Starts a new game
+ * @details The game computes the marks of every guess; a table of them (see answers.h) may be set afterwards.
+ * @param game The game to initialize
+ * @param secret The secret of the game
+ */
+void start_game(struct game *game, const uint8_t *secret);
+
+/**
+ * @brief Plays one round of a game
+ * @param game The game
+ * @param req Client's guess
+ * @param resp Receives the response, including the GAME_LOST_ERR_BIT in the last round
+ * @return GAME_RUNNING if the game goes on, otherwise its result: EXIT_SUCCESS if the client won,
+ * EXIT_PARITY_ERROR, EXIT_GAME_LOST or EXIT_MULTIPLE_ERRORS
+ */
+int play_round(struct game *game, mm_request_t req, mm_response_t *resp);
+
+/**
+ * @brief Plays the guesses of a batch until the game is over
+ * @param game The game
+ * @param requests count guesses in wire format, REQUEST_BYTES each
+ * @param count Number of guesses
+ * @param resp Buffer for up to count responses in wire format, RESPONSE_BYTES each
+ * @param answered Receives the number of guesses played, which is the number of responses
+ * @return GAME_RUNNING if the game goes on, otherwise its result like play_round
+ */
+int play_batch(struct game *game, const uint8_t *requests, size_t count, uint8_t *resp, size_t *answered);
+
+/**
+ * @brief Ends a running game because the client took too long, the game is lost
+ */
+void expire_game(struct game *game);
+
+/**
+ * @brief Adds a game, finished or not, to the statistics
+ */
+void record_game(struct game_stats *stats, const struct game *game);
+
+/**
+ * @brief Adds the statistics from to the statistics into
+ */
+void merge_stats(struct game_stats *into, const struct game_stats *from);
+
+#endif /* GAME_H */
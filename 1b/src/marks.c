@@ -0,0 +1,352 @@
+/**
+ * @file marks.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the marks module
+ */
+
+#include "marks.h"
+#include <stdbool.h>
+#include <errno.h>
+
+#if defined(__x86_64__) && defined(__SSE2__)
+#include <immintrin.h>
+#define MARKS_X86 (1)
+#else
+#define MARKS_X86 (0)
+#endif
+
+
+/* === Macros === */
+
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/* Functions using AVX2, which the rest of the build does not assume */
+#define AVX2 __attribute__((target("avx2")))
+
+
+/* === Type Definitions === */
+
+/** @brief The functions of a kernel */
+struct kernel_ops {
+    const char *name;
+    void (*compute)(const struct marks_guess *guess, const uint8_t *lanes, size_t stride, size_t n,
+        uint8_t *red, uint8_t *white);
+    size_t (*filter)(const struct marks_guess *guess, const uint8_t *from, uint8_t *to, size_t stride, size_t n,
+        unsigned int red, unsigned int white);
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief The kernels, as compute_marks and filter_codes
+ */
+static void compute_scalar(const struct marks_guess *guess, const uint8_t *lanes, size_t stride, size_t n,
+    uint8_t *red, uint8_t *white);
+static size_t filter_scalar(const struct marks_guess *guess, const uint8_t *from, uint8_t *to, size_t stride,
+    size_t n, unsigned int red, unsigned int white);
+#if MARKS_X86
+static void compute_sse2(const struct marks_guess *guess, const uint8_t *lanes, size_t stride, size_t n,
+    uint8_t *red, uint8_t *white);
+static size_t filter_sse2(const struct marks_guess *guess, const uint8_t *from, uint8_t *to, size_t stride,
+    size_t n, unsigned int red, unsigned int white);
+static AVX2 void compute_avx2(const struct marks_guess *guess, const uint8_t *lanes, size_t stride, size_t n,
+    uint8_t *red, uint8_t *white);
+static AVX2 size_t filter_avx2(const struct marks_guess *guess, const uint8_t *from, uint8_t *to, size_t stride,
+    size_t n, unsigned int red, unsigned int white);
+#endif
+
+/**
+ * @brief Returns true if the processor and the build have a kernel
+ */
+static bool kernel_supported(enum marks_kernel kernel);
+
+
+/* === Global Variables === */
+
+/** @brief The kernels, NULL where the build has none */
+static const struct kernel_ops kernels[MARKS_KERNELS] = {
+    [MARKS_SCALAR] = { "scalar", compute_scalar, filter_scalar },
+#if MARKS_X86
+    [MARKS_SSE2] = { "sse2", compute_sse2, filter_sse2 },
+    [MARKS_AVX2] = { "avx2", compute_avx2, filter_avx2 },
+#else
+    [MARKS_SSE2] = { "sse2", NULL, NULL },
+    [MARKS_AVX2] = { "avx2", NULL, NULL },
+#endif
+};
+
+/** @brief The kernel in use, -1 before the first use */
+static int chosen = -1;
+
+
+/* === Implementations === */
+
+void prepare_guess(struct marks_guess *guess, const uint8_t *colors)
+{
+    guess->distinct = 0;
+    for (int slot = 0; slot < SLOTS; slot++) {
+        int k = 0;
+
+        guess->colors[slot] = colors[slot];
+        while (k < guess->distinct && guess->color[k] != colors[slot]) {
+            k++;
+        }
+        if (k == guess->distinct) {
+            guess->color[k] = colors[slot];
+            guess->count[k] = 0;
+            guess->distinct++;
+        }
+        guess->count[k]++;
+    }
+}
+
+static void compute_scalar(const struct marks_guess *guess, const uint8_t *lanes, size_t stride, size_t n,
+    uint8_t *red, uint8_t *white)
+{
+    for (size_t i = 0; i < n; i++) {
+        uint8_t code[SLOTS];
+        unsigned int marks;
+
+        for (int slot = 0; slot < SLOTS; slot++) {
+            code[slot] = lanes[slot * stride + i];
+        }
+        marks = mm_marks_colors(guess->colors, code);
+        red[i] = (uint8_t)RED_OF(marks);
+        white[i] = (uint8_t)WHITE_OF(marks);
+    }
+}
+
+static size_t filter_scalar(const struct marks_guess *guess, const uint8_t *from, uint8_t *to, size_t stride,
+    size_t n, unsigned int red, unsigned int white)
+{
+    unsigned int wanted = red | white << MARK_WIDTH;
+    size_t kept = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        uint8_t code[SLOTS];
+
+        for (int slot = 0; slot < SLOTS; slot++) {
+            code[slot] = from[slot * stride + i];
+        }
+        if (mm_marks_colors(guess->colors, code) == wanted) {
+            for (int slot = 0; slot < SLOTS; slot++) {
+                to[slot * stride + kept] = code[slot];
+            }
+            kept++;
+        }
+    }
+    return kept;
+}
+
+#if MARKS_X86
+
+/**
+ * @brief The red marks and the pins red or white of the 16 codes from i on
+ */
+static inline void block_sse2(const struct marks_guess *guess, const uint8_t *lanes, size_t stride, size_t i,
+    __m128i *red, __m128i *pins)
+{
+    __m128i slots[SLOTS];
+    __m128i r = _mm_setzero_si128(), p = _mm_setzero_si128();
+
+    /* a compare gives -1 in the bytes which match */
+    for (int slot = 0; slot < SLOTS; slot++) {
+        slots[slot] = _mm_loadu_si128((const __m128i *)&lanes[slot * stride + i]);
+        r = _mm_sub_epi8(r, _mm_cmpeq_epi8(slots[slot], _mm_set1_epi8((char)guess->colors[slot])));
+    }
+    for (int k = 0; k < guess->distinct; k++) {
+        __m128i color = _mm_set1_epi8((char)guess->color[k]);
+        __m128i count = _mm_setzero_si128();
+
+        for (int slot = 0; slot < SLOTS; slot++) {
+            count = _mm_sub_epi8(count, _mm_cmpeq_epi8(slots[slot], color));
+        }
+        p = _mm_add_epi8(p, _mm_min_epu8(count, _mm_set1_epi8((char)guess->count[k])));
+    }
+    *red = r;
+    *pins = p;
+}
+
+static void compute_sse2(const struct marks_guess *guess, const uint8_t *lanes, size_t stride, size_t n,
+    uint8_t *red, uint8_t *white)
+{
+    for (size_t i = 0; i < n; i += 16) {
+        uint8_t r[16], p[16];
+        __m128i vr, vp;
+
+        block_sse2(guess, lanes, stride, i, &vr, &vp);
+        _mm_storeu_si128((__m128i *)r, vr);
+        _mm_storeu_si128((__m128i *)p, vp);
+        for (size_t j = 0; j < 16 && i + j < n; j++) {
+            red[i + j] = r[j];
+            white[i + j] = (uint8_t)(p[j] - r[j]);
+        }
+    }
+}
+
+static size_t filter_sse2(const struct marks_guess *guess, const uint8_t *from, uint8_t *to, size_t stride,
+    size_t n, unsigned int red, unsigned int white)
+{
+    __m128i wanted_red = _mm_set1_epi8((char)red);
+    __m128i wanted_pins = _mm_set1_epi8((char)(red + white));
+    size_t kept = 0;
+
+    /* a block is loaded before any code of it is moved, and codes only move down */
+    for (size_t i = 0; i < n; i += 16) {
+        __m128i vr, vp;
+        unsigned int match;
+
+        block_sse2(guess, from, stride, i, &vr, &vp);
+        match = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(vr, wanted_red),
+            _mm_cmpeq_epi8(vp, wanted_pins)));
+        if (n - i < 16) {
+            match &= (1u << (n - i)) - 1;
+        }
+        while (match != 0) {
+            size_t j = (size_t)__builtin_ctz(match);
+
+            for (int slot = 0; slot < SLOTS; slot++) {
+                to[slot * stride + kept] = from[slot * stride + i + j];
+            }
+            kept++;
+            match &= match - 1;
+        }
+    }
+    return kept;
+}
+
+/**
+ * @brief The red marks and the pins red or white of the 32 codes from i on
+ */
+static inline AVX2 void block_avx2(const struct marks_guess *guess, const uint8_t *lanes, size_t stride,
+    size_t i, __m256i *red, __m256i *pins)
+{
+    __m256i slots[SLOTS];
+    __m256i r = _mm256_setzero_si256(), p = _mm256_setzero_si256();
+
+    for (int slot = 0; slot < SLOTS; slot++) {
+        slots[slot] = _mm256_loadu_si256((const __m256i *)&lanes[slot * stride + i]);
+        r = _mm256_sub_epi8(r, _mm256_cmpeq_epi8(slots[slot], _mm256_set1_epi8((char)guess->colors[slot])));
+    }
+    for (int k = 0; k < guess->distinct; k++) {
+        __m256i color = _mm256_set1_epi8((char)guess->color[k]);
+        __m256i count = _mm256_setzero_si256();
+
+        for (int slot = 0; slot < SLOTS; slot++) {
+            count = _mm256_sub_epi8(count, _mm256_cmpeq_epi8(slots[slot], color));
+        }
+        p = _mm256_add_epi8(p, _mm256_min_epu8(count, _mm256_set1_epi8((char)guess->count[k])));
+    }
+    *red = r;
+    *pins = p;
+}
+
+static AVX2 void compute_avx2(const struct marks_guess *guess, const uint8_t *lanes, size_t stride, size_t n,
+    uint8_t *red, uint8_t *white)
+{
+    for (size_t i = 0; i < n; i += 32) {
+        uint8_t r[32], p[32];
+        __m256i vr, vp;
+
+        block_avx2(guess, lanes, stride, i, &vr, &vp);
+        _mm256_storeu_si256((__m256i *)r, vr);
+        _mm256_storeu_si256((__m256i *)p, vp);
+        for (size_t j = 0; j < 32 && i + j < n; j++) {
+            red[i + j] = r[j];
+            white[i + j] = (uint8_t)(p[j] - r[j]);
+        }
+    }
+}
+
+static AVX2 size_t filter_avx2(const struct marks_guess *guess, const uint8_t *from, uint8_t *to, size_t stride,
+    size_t n, unsigned int red, unsigned int white)
+{
+    __m256i wanted_red = _mm256_set1_epi8((char)red);
+    __m256i wanted_pins = _mm256_set1_epi8((char)(red + white));
+    size_t kept = 0;
+
+    for (size_t i = 0; i < n; i += 32) {
+        __m256i vr, vp;
+        uint32_t match;
+
+        block_avx2(guess, from, stride, i, &vr, &vp);
+        match = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(vr, wanted_red),
+            _mm256_cmpeq_epi8(vp, wanted_pins)));
+        if (n - i < 32) {
+            match &= (UINT32_C(1) << (n - i)) - 1;
+        }
+        while (match != 0) {
+            size_t j = (size_t)__builtin_ctz(match);
+
+            for (int slot = 0; slot < SLOTS; slot++) {
+                to[slot * stride + kept] = from[slot * stride + i + j];
+            }
+            kept++;
+            match &= match - 1;
+        }
+    }
+    return kept;
+}
+
+#endif /* MARKS_X86 */
+
+void compute_marks(const struct marks_guess *guess, const uint8_t *lanes, size_t stride, size_t n,
+    uint8_t *red, uint8_t *white)
+{
+    kernels[marks_kernel()].compute(guess, lanes, stride, n, red, white);
+}
+
+size_t filter_codes(const struct marks_guess *guess, const uint8_t *from, uint8_t *to, size_t stride, size_t n,
+    unsigned int red, unsigned int white)
+{
+    return kernels[marks_kernel()].filter(guess, from, to, stride, n, red, white);
+}
+
+static bool kernel_supported(enum marks_kernel kernel)
+{
+    switch (kernel) {
+    case MARKS_SCALAR:
+        return true;
+#if MARKS_X86
+    case MARKS_SSE2:
+        return true;
+    case MARKS_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+int select_marks_kernel(enum marks_kernel kernel)
+{
+    if (kernel >= MARKS_KERNELS || !kernel_supported(kernel)) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    STORE_RELEASE(&chosen, (int)kernel);
+    return 0;
+}
+
+enum marks_kernel marks_kernel(void)
+{
+    int kernel = LOAD_ACQUIRE(&chosen);
+
+    if (kernel < 0) {
+        /* every thread comes to the same choice */
+        kernel = kernel_supported(MARKS_AVX2) ? MARKS_AVX2 :
+            kernel_supported(MARKS_SSE2) ? MARKS_SSE2 : MARKS_SCALAR;
+        STORE_RELEASE(&chosen, kernel);
+    }
+    return (enum marks_kernel)kernel;
+}
+
+const char *marks_kernel_name(enum marks_kernel kernel)
+{
+    return (kernel < MARKS_KERNELS) ? kernels[kernel].name : "unknown";
+}
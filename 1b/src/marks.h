@@ -0,0 +1,111 @@
+/**
+ * @file marks.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief The marks of one guess against many codes at once.
+ * @details The codes are kept as a structure of arrays: one lane of bytes per slot, the color of slot s of
+ * code i at lanes[s * stride + i]. The vector kernels load a byte of the same slot of 16 (SSE2) or 32 (AVX2)
+ * codes at a time. The red marks are the sum of the compares of each slot with the guess. For every color of
+ * the guess they count the slots of that color in each code and add the smaller of that count and the count
+ * in the guess, which gives the pins red or white. The loops only depend on the guess, so there are no
+ * branches per code.
+ *
+ * The kernel is chosen when it is first used: AVX2 if the processor has it, otherwise SSE2 on x86-64 and the
+ * scalar kernel (mm_marks_colors of mastermind.h) elsewhere. select_marks_kernel chooses one explicitly, to
+ * compare them. A lane has to be readable up to its stride, which is a multiple of MARKS_BLOCK; codes past
+ * the count given are read but neither answered nor kept.
+ */
+
+#ifndef MARKS_H
+#define MARKS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mastermind.h"
+
+/* === Constants === */
+
+/** @brief The lanes are padded to a multiple of this many codes, the widest vector */
+#define MARKS_BLOCK (32)
+
+
+/* === Type Definitions === */
+
+/** @brief The kernels */
+enum marks_kernel {
+    MARKS_SCALAR,
+    MARKS_SSE2,
+    MARKS_AVX2,
+    MARKS_KERNELS
+};
+
+/** @brief A guess prepared for the kernels */
+struct marks_guess {
+    uint8_t colors[SLOTS];      /**< the colors of the slots */
+    uint8_t distinct;           /**< number of different colors */
+    uint8_t color[SLOTS];       /**< the different colors, distinct of them */
+    uint8_t count[SLOTS];       /**< the slots of each of these colors */
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Rounds a number of codes up to a stride of the lanes
+ */
+static inline size_t marks_stride(size_t codes)
+{
+    return (codes + MARKS_BLOCK - 1) / MARKS_BLOCK * MARKS_BLOCK;
+}
+
+/**
+ * @brief Prepares a guess for the kernels
+ * @param guess The guess to fill in
+ * @param colors The colors of the slots of the guess
+ */
+void prepare_guess(struct marks_guess *guess, const uint8_t *colors);
+
+/**
+ * @brief Computes the marks of a guess against codes
+ * @param guess The guess
+ * @param lanes The codes, one lane per slot
+ * @param stride Distance of the lanes, a multiple of MARKS_BLOCK
+ * @param n Number of codes
+ * @param red Receives the red marks of each code, n of them
+ * @param white Receives the white marks of each code, n of them
+ */
+void compute_marks(const struct marks_guess *guess, const uint8_t *lanes, size_t stride, size_t n,
+    uint8_t *red, uint8_t *white);
+
+/**
+ * @brief Keeps the codes with the given marks for a guess, in their order
+ * @param guess The guess
+ * @param from The codes, one lane per slot
+ * @param to Receives the codes kept, may be from
+ * @param stride Distance of the lanes of both, a multiple of MARKS_BLOCK
+ * @param n Number of codes
+ * @param red The red marks of the codes to keep
+ * @param white The white marks of the codes to keep
+ * @return The number of codes kept
+ */
+size_t filter_codes(const struct marks_guess *guess, const uint8_t *from, uint8_t *to, size_t stride, size_t n,
+    unsigned int red, unsigned int white);
+
+/**
+ * @brief Chooses the kernel of all threads
+ * @return 0 on success, -1 if the processor or the build lacks it (errno is ENOTSUP)
+ */
+int select_marks_kernel(enum marks_kernel kernel);
+
+/**
+ * @brief Returns the kernel in use, choosing the fastest available if none has been chosen
+ */
+enum marks_kernel marks_kernel(void);
+
+/**
+ * @brief Returns the name of a kernel, as "scalar", "sse2" or "avx2"
+ */
+const char *marks_kernel_name(enum marks_kernel kernel);
+
+#endif /* MARKS_H */
@@ -0,0 +1,315 @@
+/**
+ * @file mastermind.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief The parameters of the game and the wire format, shared by the server, the client and the tools.
+ * @details The game is fixed at compile time by MM_SLOTS and MM_COLORS, 5 slots of 8 colors unless the
+ * build says otherwise (make SLOTS=6 COLORS=10). Everything else follows from them: a color takes
+ * SHIFT_WIDTH bits, a code, slot i at bit i * SHIFT_WIDTH, takes CODE_BITS, and a count of marks takes
+ * MARK_WIDTH bits, enough for SLOTS + 1, so that BATCH_ACK is no possible response.
+ *
+ * Wire format: a request is REQUEST_BYTES bytes, least significant byte first, holding the code and in its
+ * topmost bit PARITY_BIT the parity bit, which makes the parity of the whole request even. A response is
+ * RESPONSE_BYTES bytes the same way: the red marks, the white marks shifted by MARK_WIDTH, and the bits
+ * PARITY_ERR_BIT and GAME_LOST_ERR_BIT above them.
+ *
+ * WIRE_VERSION 1 is the original protocol of the 5x8 game, two bytes per request and one per response. Every
+ * other variant speaks WIRE_VERSION 2: the client opens a connection with the WIRE_HELLO_BYTES greeting
+ * naming the version and the variant, and a server playing the same variant answers with the same bytes
+ * before anything else; any other server closes the connection. UDP datagrams carry the greeting in front.
+ *
+ * The marks of a guess are computed by kernels made with MM_DEFINE_MARKS for fixed parameters, with the
+ * loops over the slots and colors unrolled by the preprocessor; mm_marks is the one of the built variant.
+ */
+
+#ifndef MASTERMIND_H
+#define MASTERMIND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* === Game Parameters === */
+
+#ifndef MM_SLOTS
+#define MM_SLOTS 5
+#endif
+#ifndef MM_COLORS
+#define MM_COLORS 8
+#endif
+#ifndef MM_MAX_TRIES
+#define MM_MAX_TRIES 35
+#endif
+
+#if MM_SLOTS < 1 || MM_SLOTS > 12
+#error "MM_SLOTS has to be between 1 and 12"
+#endif
+#if MM_COLORS < 2 || MM_COLORS > 16
+#error "MM_COLORS has to be between 2 and 16"
+#endif
+
+/** @brief Bits needed for the numbers 0 to x, for x up to 31 */
+#define MM_BITS_FOR(x) ((x) <= 1 ? 1 : (x) <= 3 ? 2 : (x) <= 7 ? 3 : (x) <= 15 ? 4 : 5)
+
+#define SLOTS (MM_SLOTS)
+#define COLORS (MM_COLORS)
+#define MAX_TRIES (MM_MAX_TRIES)
+
+/** @brief Bits of a color in a code */
+#define SHIFT_WIDTH (MM_BITS_FOR(MM_COLORS - 1))
+/** @brief Bits of a code */
+#define CODE_BITS (MM_SLOTS * SHIFT_WIDTH)
+/** @brief Bits of the red and of the white marks in a response */
+#define MARK_WIDTH (MM_BITS_FOR(MM_SLOTS + 1))
+
+/** @brief The letters of the colors, in the order of their values; the first eight are the classic ones */
+#define COLOR_LETTERS "bdgorsvwacefhijk"
+
+
+/* === Wire Format === */
+
+#if MM_SLOTS == 5 && MM_COLORS == 8
+#define WIRE_VERSION (1)
+#define WIRE_HELLO_BYTES (0)
+#else
+#define WIRE_VERSION (2)
+#define WIRE_HELLO_BYTES (4)
+#endif
+
+/** @brief First byte of the greeting */
+#define WIRE_MAGIC ('M')
+
+#define REQUEST_BYTES ((CODE_BITS + 1 + 7) / 8)
+#define PARITY_BIT (8 * REQUEST_BYTES - 1)
+
+#define PARITY_ERR_BIT (2 * MARK_WIDTH)
+#define GAME_LOST_ERR_BIT (2 * MARK_WIDTH + 1)
+#define RESPONSE_BYTES ((2 * MARK_WIDTH + 2 + 7) / 8)
+
+/** @brief First request of a client using the batch protocol, the empty guess with a wrong parity bit */
+#define BATCH_HELLO ((mm_request_t)1 << PARITY_BIT)
+/** @brief Response to BATCH_HELLO, all bits set, its red marks are more than SLOTS */
+#define BATCH_ACK ((mm_response_t)~(mm_response_t)0)
+
+/** @brief UDP datagrams: the greeting, game id (4 bytes) and round (2 bytes), then a request or response */
+#define UDP_HEADER_BYTES (WIRE_HELLO_BYTES + 6)
+#define UDP_REQUEST_BYTES (UDP_HEADER_BYTES + REQUEST_BYTES)
+#define UDP_RESPONSE_BYTES (UDP_HEADER_BYTES + RESPONSE_BYTES)
+
+
+/* === Type Definitions === */
+
+/** @brief A code without parity bit */
+#if CODE_BITS <= 16
+typedef uint16_t mm_code_t;
+#elif CODE_BITS <= 32
+typedef uint32_t mm_code_t;
+#else
+typedef uint64_t mm_code_t;
+#endif
+
+/** @brief A request as on the wire */
+#if REQUEST_BYTES <= 2
+typedef uint16_t mm_request_t;
+#elif REQUEST_BYTES <= 4
+typedef uint32_t mm_request_t;
+#else
+typedef uint64_t mm_request_t;
+#endif
+
+/** @brief A response as on the wire */
+#if RESPONSE_BYTES == 1
+typedef uint8_t mm_response_t;
+#else
+typedef uint16_t mm_response_t;
+#endif
+
+
+/* === Macros === */
+
+#define CODE_MASK (((mm_request_t)1 << CODE_BITS) - 1)
+#define MARK_MASK ((1u << MARK_WIDTH) - 1)
+
+/** @brief The marks of a response */
+#define RED_OF(resp) ((unsigned int)(resp) & MARK_MASK)
+#define WHITE_OF(resp) (((unsigned int)(resp) >> MARK_WIDTH) & MARK_MASK)
+
+/** @brief Expands X(0, arg) X(1, arg) ... X(n - 1, arg), n has to be a plain number from 1 to 16 */
+#define MM_REPEAT(n, X, arg) MM_REPEAT_(n, X, arg)
+#define MM_REPEAT_(n, X, arg) MM_REPEAT_##n(X, arg)
+#define MM_REPEAT_1(X, a) X(0, a)
+#define MM_REPEAT_2(X, a) MM_REPEAT_1(X, a) X(1, a)
+#define MM_REPEAT_3(X, a) MM_REPEAT_2(X, a) X(2, a)
+#define MM_REPEAT_4(X, a) MM_REPEAT_3(X, a) X(3, a)
+#define MM_REPEAT_5(X, a) MM_REPEAT_4(X, a) X(4, a)
+#define MM_REPEAT_6(X, a) MM_REPEAT_5(X, a) X(5, a)
+#define MM_REPEAT_7(X, a) MM_REPEAT_6(X, a) X(6, a)
+#define MM_REPEAT_8(X, a) MM_REPEAT_7(X, a) X(7, a)
+#define MM_REPEAT_9(X, a) MM_REPEAT_8(X, a) X(8, a)
+#define MM_REPEAT_10(X, a) MM_REPEAT_9(X, a) X(9, a)
+#define MM_REPEAT_11(X, a) MM_REPEAT_10(X, a) X(10, a)
+#define MM_REPEAT_12(X, a) MM_REPEAT_11(X, a) X(11, a)
+#define MM_REPEAT_13(X, a) MM_REPEAT_12(X, a) X(12, a)
+#define MM_REPEAT_14(X, a) MM_REPEAT_13(X, a) X(13, a)
+#define MM_REPEAT_15(X, a) MM_REPEAT_14(X, a) X(14, a)
+#define MM_REPEAT_16(X, a) MM_REPEAT_15(X, a) X(15, a)
+
+/* One slot of a kernel: a red mark if the colors match, and both colors counted */
+#define MM_MARK_CODE_SLOT(i, width) { \
+        unsigned int g_ = (unsigned int)(guess >> ((i) * (width))) & ((1u << (width)) - 1); \
+        unsigned int s_ = (unsigned int)(secret >> ((i) * (width))) & ((1u << (width)) - 1); \
+        red += (g_ == s_); guess_count[g_]++; secret_count[s_]++; \
+    }
+#define MM_MARK_COLORS_SLOT(i, width) { \
+        red += (guess[i] == secret[i]); guess_count[guess[i]]++; secret_count[secret[i]]++; \
+    }
+/* One color of a kernel: the number of pins of the color in both */
+#define MM_MARK_COLOR(c, unused) \
+    common += (guess_count[c] < secret_count[c]) ? guess_count[c] : secret_count[c];
+
+/**
+ * @brief Defines the kernels name and name_colors for a variant
+ * @details name(guess, secret) takes two codes, name_colors(guess, secret) two arrays of slots colors. Both
+ * return the red marks and the white marks shifted by the mark width of the variant. A guess may hold
+ * values which are no color, they just never match. slots and colors have to be plain numbers.
+ */
+#define MM_DEFINE_MARKS(name, slots, colors) \
+    static inline unsigned int name(uint64_t guess, uint64_t secret) \
+    { \
+        uint8_t guess_count[1 << MM_BITS_FOR((colors) - 1)] = {0}; \
+        uint8_t secret_count[1 << MM_BITS_FOR((colors) - 1)] = {0}; \
+        unsigned int red = 0, common = 0; \
+        MM_REPEAT(slots, MM_MARK_CODE_SLOT, MM_BITS_FOR((colors) - 1)) \
+        MM_REPEAT(colors, MM_MARK_COLOR, 0) \
+        return red | (common - red) << MM_BITS_FOR((slots) + 1); \
+    } \
+    static inline unsigned int name##_colors(const uint8_t *guess, const uint8_t *secret) \
+    { \
+        uint8_t guess_count[1 << MM_BITS_FOR((colors) - 1)] = {0}; \
+        uint8_t secret_count[1 << MM_BITS_FOR((colors) - 1)] = {0}; \
+        unsigned int red = 0, common = 0; \
+        MM_REPEAT(slots, MM_MARK_COLORS_SLOT, 0) \
+        MM_REPEAT(colors, MM_MARK_COLOR, 0) \
+        return red | (common - red) << MM_BITS_FOR((slots) + 1); \
+    }
+
+
+/* === Implementations === */
+
+/** @brief The marks of the built variant */
+MM_DEFINE_MARKS(mm_marks, MM_SLOTS, MM_COLORS)
+
+/**
+ * @brief Encodes the colors of the slots into a code
+ */
+static inline mm_code_t encode_code(const uint8_t *colors)
+{
+    mm_code_t code = 0;
+
+    for (int j = 0; j < SLOTS; j++) {
+        code |= (mm_code_t)colors[j] << (j * SHIFT_WIDTH);
+    }
+    return code;
+}
+
+/**
+ * @brief Decodes a code into the colors of the slots
+ */
+static inline void decode_code(mm_code_t code, uint8_t *colors)
+{
+    for (int j = 0; j < SLOTS; j++) {
+        colors[j] = (uint8_t)((code >> (j * SHIFT_WIDTH)) & ((1u << SHIFT_WIDTH) - 1));
+    }
+}
+
+/**
+ * @brief Returns the request for a code, with its parity bit
+ */
+static inline mm_request_t make_request(mm_code_t code)
+{
+    return (mm_request_t)code | (mm_request_t)__builtin_parityll(code) << PARITY_BIT;
+}
+
+/**
+ * @brief Returns true if the parity of a request is even
+ */
+static inline bool request_parity_ok(mm_request_t req)
+{
+    return !__builtin_parityll(req);
+}
+
+/**
+ * @brief Writes a request in wire format, REQUEST_BYTES bytes
+ */
+static inline void put_request(uint8_t *buf, mm_request_t req)
+{
+    for (int i = 0; i < REQUEST_BYTES; i++) {
+        buf[i] = (uint8_t)(req >> (8 * i));
+    }
+}
+
+/**
+ * @brief Reads a request in wire format
+ */
+static inline mm_request_t get_request(const uint8_t *buf)
+{
+    mm_request_t req = 0;
+
+    for (int i = 0; i < REQUEST_BYTES; i++) {
+        req |= (mm_request_t)buf[i] << (8 * i);
+    }
+    return req;
+}
+
+/**
+ * @brief Writes a response in wire format, RESPONSE_BYTES bytes
+ */
+static inline void put_response(uint8_t *buf, mm_response_t resp)
+{
+    for (int i = 0; i < RESPONSE_BYTES; i++) {
+        buf[i] = (uint8_t)(resp >> (8 * i));
+    }
+}
+
+/**
+ * @brief Reads a response in wire format
+ */
+static inline mm_response_t get_response(const uint8_t *buf)
+{
+    mm_response_t resp = 0;
+
+    for (int i = 0; i < RESPONSE_BYTES; i++) {
+        resp |= (mm_response_t)(buf[i] << (8 * i));
+    }
+    return resp;
+}
+
+/**
+ * @brief Writes the greeting of the built variant, WIRE_HELLO_BYTES bytes
+ */
+static inline void put_wire_hello(uint8_t *buf)
+{
+#if WIRE_HELLO_BYTES > 0
+    buf[0] = WIRE_MAGIC;
+    buf[1] = WIRE_VERSION;
+    buf[2] = SLOTS;
+    buf[3] = COLORS;
+#else
+    (void) buf;
+#endif
+}
+
+/**
+ * @brief Returns true if a greeting names the version and variant built
+ */
+static inline bool wire_hello_ok(const uint8_t *buf)
+{
+#if WIRE_HELLO_BYTES > 0
+    return buf[0] == WIRE_MAGIC && buf[1] == WIRE_VERSION && buf[2] == SLOTS && buf[3] == COLORS;
+#else
+    (void) buf;
+    return true;
+#endif
+}
+
+#endif /* MASTERMIND_H */
@@ -0,0 +1,162 @@
+/**
+ * @file metrics.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the metrics module
+ */
+
+#include "metrics.h"
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+
+/* === Macros === */
+
+/* Rounds a size up to whole cache lines */
+#define LINES(size) (((size) + METRICS_LINE - 1) / METRICS_LINE * METRICS_LINE)
+
+
+/* === Implementations === */
+
+int create_metrics(struct metrics *metrics, const char *path, unsigned int loops)
+{
+    size_t size = LINES(sizeof (struct metrics_header)) + loops * LINES(sizeof (struct loop_metrics));
+    struct metrics_header *header;
+    int fd;
+
+    if ( (fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)size) < 0) {
+        int error = errno;
+        (void) close(fd);
+        errno = error;
+        return -1;
+    }
+    header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    (void) close(fd);
+    if (header == MAP_FAILED) {
+        return -1;
+    }
+    /* the file is all zeros, only the header needs to be filled in, the magic last */
+    header->version = METRICS_VERSION;
+    header->loops = loops;
+    header->block_size = LINES(sizeof (struct loop_metrics));
+    header->started = (uint64_t)time(NULL);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    (void) memcpy(header->magic, METRICS_MAGIC, sizeof METRICS_MAGIC);
+    metrics->header = header;
+    metrics->size = size;
+    return 0;
+}
+
+int open_metrics(struct metrics *metrics, const char *path)
+{
+    struct metrics_header *header;
+    struct stat st;
+    int fd;
+
+    if ( (fd = open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) < 0) {
+        int error = errno;
+        (void) close(fd);
+        errno = error;
+        return -1;
+    }
+    if ((size_t)st.st_size < sizeof *header) {
+        (void) close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    header = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    (void) close(fd);
+    if (header == MAP_FAILED) {
+        return -1;
+    }
+    metrics->header = header;
+    metrics->size = (size_t)st.st_size;
+    if (memcmp(header->magic, METRICS_MAGIC, sizeof METRICS_MAGIC) != 0 || header->version != METRICS_VERSION ||
+        header->block_size < sizeof (struct loop_metrics) ||
+        LINES(sizeof *header) + header->loops * header->block_size > metrics->size) {
+        close_metrics(metrics);
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+void close_metrics(struct metrics *metrics)
+{
+    if (metrics->header != NULL) {
+        (void) munmap(metrics->header, metrics->size);
+        metrics->header = NULL;
+    }
+}
+
+struct loop_metrics *loop_metrics(const struct metrics *metrics, unsigned int id)
+{
+    return (struct loop_metrics *)((char *)metrics->header + LINES(sizeof *metrics->header) +
+        id * metrics->header->block_size);
+}
+
+uint64_t metrics_clock(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+void count_game(struct loop_metrics *m, const struct game *game)
+{
+    METRIC_ADD(m->games_ended, 1);
+    if (game->result == GAME_RUNNING) {
+        METRIC_ADD(m->aborted, 1);
+    } else {
+        METRIC_ADD(m->results[game->result], 1);
+    }
+    if (game->expired) {
+        METRIC_ADD(m->expired, 1);
+    }
+    METRIC_ADD(m->rounds_per_game[game->round], 1);
+}
+
+void count_rounds(struct loop_metrics *m, unsigned int rounds, uint64_t ns)
+{
+    unsigned int bucket = (ns == 0) ? 0 : 64 - (unsigned int)__builtin_clzll(ns);
+
+    if (bucket >= LATENCY_BUCKETS) {
+        bucket = LATENCY_BUCKETS - 1;
+    }
+    METRIC_ADD(m->rounds, rounds);
+    METRIC_ADD(m->latency[bucket], rounds);
+}
+
+void sum_metrics(struct loop_metrics *into, const struct loop_metrics *from)
+{
+    into->games_started += METRIC_READ(from->games_started);
+    into->games_ended += METRIC_READ(from->games_ended);
+    for (size_t i = 0; i < sizeof into->results / sizeof into->results[0]; i++) {
+        into->results[i] += METRIC_READ(from->results[i]);
+    }
+    into->aborted += METRIC_READ(from->aborted);
+    into->expired += METRIC_READ(from->expired);
+    into->rounds += METRIC_READ(from->rounds);
+    into->bytes_in += METRIC_READ(from->bytes_in);
+    into->bytes_out += METRIC_READ(from->bytes_out);
+    for (size_t i = 0; i < sizeof into->rounds_per_game / sizeof into->rounds_per_game[0]; i++) {
+        into->rounds_per_game[i] += METRIC_READ(from->rounds_per_game[i]);
+    }
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+        into->latency[i] += METRIC_READ(from->latency[i]);
+    }
+}
@@ -0,0 +1,130 @@
+/**
+ * @file metrics.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Live counters of the multi-client server in a shared memory file.
+ * @details The server maps a file with a header and one block of counters per event loop, and every loop
+ * writes only its own block. Each counter therefore has a single writer, which updates it with a plain
+ * atomic store instead of a locked read-modify-write, and the blocks are cache line aligned so the loops
+ * never share a line. A reader such as mm-stats maps the same file read-only and sums the blocks whenever
+ * it likes; it never stops or slows down the server.
+ *
+ * The latency histogram counts rounds by the time the loop spent from taking the request off the socket
+ * until its response was sent or, with io_uring, queued for sending: bucket 0 holds 0 ns, bucket i > 0
+ * holds [2^(i-1), 2^i) ns. Rounds answered together count with the time of the whole group.
+ *
+ * A game ends when it is recorded in the game_stats, for UDP games that is when they leave the table.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+/* === Constants === */
+
+#define METRICS_MAGIC "MMSTATS"
+#define METRICS_VERSION (1)
+
+/** @brief Buckets of the latency histogram, the last one also counts everything longer */
+#define LATENCY_BUCKETS (40)
+
+/** @brief Alignment of the blocks in the file */
+#define METRICS_LINE (64)
+
+
+/* === Macros === */
+
+/** @brief Adds n to a counter of the loop's own block */
+#define METRIC_ADD(counter, n) __atomic_store_n(&(counter), (counter) + (n), __ATOMIC_RELAXED)
+
+/** @brief Reads a counter of any block */
+#define METRIC_READ(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+
+
+/* === Type Definitions === */
+
+/** @brief The counters of one event loop */
+struct loop_metrics {
+    uint64_t games_started;                 /**< games begun */
+    uint64_t games_ended;                   /**< games recorded, finished or aborted */
+    uint64_t results[EXIT_MULTIPLE_ERRORS + 1]; /**< finished games per result */
+    uint64_t aborted;                       /**< games the client left */
+    uint64_t expired;                       /**< games lost by a time limit */
+    uint64_t rounds;                        /**< rounds played */
+    uint64_t bytes_in;                      /**< bytes received */
+    uint64_t bytes_out;                     /**< bytes sent */
+    uint64_t rounds_per_game[MAX_TRIES + 1];    /**< recorded games by their number of rounds */
+    uint64_t latency[LATENCY_BUCKETS];      /**< rounds by their service time */
+};
+
+/** @brief The header of the file */
+struct metrics_header {
+    char magic[8];          /**< METRICS_MAGIC, written last */
+    uint32_t version;       /**< METRICS_VERSION */
+    uint32_t loops;         /**< number of blocks */
+    uint64_t block_size;    /**< distance of the blocks in bytes */
+    uint64_t started;       /**< start of the server, seconds since the epoch */
+};
+
+/** @brief A mapped metrics file */
+struct metrics {
+    struct metrics_header *header;
+    size_t size;            /**< size of the mapping */
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Creates or replaces a metrics file and maps it
+ * @param metrics Receives the mapping
+ * @param path The file
+ * @param loops Number of event loops
+ * @return 0 on success, -1 otherwise (errno is set)
+ */
+int create_metrics(struct metrics *metrics, const char *path, unsigned int loops);
+
+/**
+ * @brief Maps an existing metrics file read-only
+ * @return 0 on success, -1 otherwise (errno is set, EINVAL if it is no metrics file)
+ */
+int open_metrics(struct metrics *metrics, const char *path);
+
+/**
+ * @brief Unmaps a metrics file, the file stays
+ */
+void close_metrics(struct metrics *metrics);
+
+/**
+ * @brief Returns the block of an event loop
+ */
+struct loop_metrics *loop_metrics(const struct metrics *metrics, unsigned int id);
+
+/**
+ * @brief Returns a monotonic time stamp in nanoseconds for latency measurements
+ */
+uint64_t metrics_clock(void);
+
+/**
+ * @brief Counts a game when it is recorded, like record_game
+ */
+void count_game(struct loop_metrics *m, const struct game *game);
+
+/**
+ * @brief Counts rounds answered together and the time it took
+ * @param m The block of the loop
+ * @param rounds Number of rounds
+ * @param ns Nanoseconds from the request to the response
+ */
+void count_rounds(struct loop_metrics *m, unsigned int rounds, uint64_t ns);
+
+/**
+ * @brief Adds the block from to the block into, for readers
+ */
+void sum_metrics(struct loop_metrics *into, const struct loop_metrics *from);
+
+#endif /* METRICS_H */
@@ -0,0 +1,569 @@
+/**
+ * @file mm-replay.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Plays the games of a capture file (see capture.h) against a mastermind server again.
+ * @details Every captured game is played on a connection of its own with the captured guesses, one guess
+ * per request. By default the replay keeps the captured timing: a game starts at the time its first round
+ * was captured and every further guess is sent at its captured time, or as soon as the previous response
+ * arrived if that is later. -x speeds the timing up by a factor. With -f the games are played as fast as
+ * possible instead, the next guess as soon as the response is there.
+ *
+ * At most -c games run at the same time, a game which would need more waits for a free connection and
+ * falls behind the captured timing; the largest lag is reported.
+ *
+ * The responses are compared with the captured ones, they only match if the server hands out the same
+ * secrets to the same games, as a server with a fixed <secret-sequence> does. A game the server ends before
+ * its captured guesses are used up counts as ended early, a captured game which stopped before its end is
+ * closed after its last guess, and the server counts it as aborted.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "capture.h"
+#include "game.h"
+
+/* === Constants === */
+
+#define USAGE "Usage: %s [-f] [-x <speed>] [-c <connections>] <capture-file> <server-hostname> <server-port> | " \
+    "<capture-file> unix:<path>"
+
+#define UNIX_PREFIX "unix:"
+
+#define DEFAULT_CONNECTIONS (256)
+#define MAX_CONNECTIONS (100000)
+#define MAX_EVENTS (256)
+
+/** @brief Latency histogram: HIST_SUB linear buckets per power of two */
+#define HIST_SUB_BITS (5)
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+
+/* === Type Definitions === */
+
+/** @brief A captured game */
+struct replay_game {
+    const struct capture_record *rounds;    /**< its rounds in order */
+    size_t count;                           /**< their number */
+};
+
+/** @brief A connection replaying a game */
+struct conn {
+    int fd;
+    const struct replay_game *game; /**< the game, NULL if the connection is free */
+    size_t next;                    /**< index of the next guess to send */
+    bool connecting;                /**< waiting for the connection */
+    bool draining;                  /**< the game is over, waiting for the server to close */
+    uint64_t sent;                  /**< time the last guess was sent */
+    uint64_t due;                   /**< time the next guess is due */
+    uint8_t in[WIRE_HELLO_BYTES + RESPONSE_BYTES];  /**< the response received so far */
+    size_t in_len;
+};
+
+
+/* === Global Variables === */
+
+/* Name of the program with default value */
+static const char *progname = "mm-replay";
+
+/* The address of the server */
+static struct sockaddr_storage server_addr;
+static socklen_t server_addrlen;
+
+/* The timing: -f, -x and the captured time of the first round */
+static bool fast = false;
+static double speed = 1.0;
+static uint64_t first;
+
+/* Connections waiting to send their next guess, a binary heap ordered by due */
+static struct conn **waiting;
+static size_t nwaiting;
+
+/* Results */
+static unsigned long rounds, matched, different, ended_early, cut_short, errors;
+static uint64_t hist[HIST_BUCKETS];
+static uint64_t max_lag;
+
+
+/* === Implementations === */
+
+/**
+ * @brief terminate program on program error
+ * @param exitcode exit code
+ * @param fmt format string
+ */
+static void bail_out(int exitcode, const char *fmt, ...)
+{
+    va_list ap;
+
+    (void) fprintf(stderr, "%s: ", progname);
+    if (fmt != NULL) {
+        va_start(ap, fmt);
+        (void) vfprintf(stderr, fmt, ap);
+        va_end(ap);
+    }
+    if (errno != 0) {
+        (void) fprintf(stderr, ": %s", strerror(errno));
+    }
+    (void) fprintf(stderr, "\n");
+
+    exit(exitcode);
+}
+
+/**
+ * @brief Returns the time in nanoseconds
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Orders records by game and round
+ */
+static int compare_records(const void *a, const void *b)
+{
+    const struct capture_record *x = a, *y = b;
+
+    if (x->game != y->game) {
+        return (x->game < y->game) ? -1 : 1;
+    }
+    if (x->round != y->round) {
+        return (x->round < y->round) ? -1 : 1;
+    }
+    return (x->time < y->time) ? -1 : (x->time > y->time);
+}
+
+/**
+ * @brief Orders games by the time of their first round
+ */
+static int compare_games(const void *a, const void *b)
+{
+    const struct replay_game *x = a, *y = b;
+
+    return (x->rounds[0].time < y->rounds[0].time) ? -1 : (x->rounds[0].time > y->rounds[0].time);
+}
+
+/**
+ * @brief Returns when a captured round is due in the replay, nanoseconds since its start
+ */
+static uint64_t replay_time(const struct capture_record *record)
+{
+    return fast ? 0 : (uint64_t)((record->time - first) / speed);
+}
+
+/**
+ * @brief Index of the histogram bucket of a latency
+ */
+static unsigned int hist_index(uint64_t ns)
+{
+    if (ns < HIST_SUB) {
+        return (unsigned int)ns;
+    }
+    unsigned int e = 63 - (unsigned int)__builtin_clzll(ns);
+    return (e - HIST_SUB_BITS + 1) * HIST_SUB + (unsigned int)((ns >> (e - HIST_SUB_BITS)) & (HIST_SUB - 1));
+}
+
+/**
+ * @brief Returns the latency below which the given fraction of the rounds lies, an upper bound
+ */
+static uint64_t percentile(double fraction)
+{
+    uint64_t seen = 0;
+
+    for (unsigned int i = 0; i < HIST_BUCKETS; ++i) {
+        seen += hist[i];
+        if (seen > 0 && seen >= fraction * rounds) {
+            if (i < HIST_SUB) {
+                return i;
+            }
+            unsigned int e = i / HIST_SUB + HIST_SUB_BITS - 1;
+            return ((uint64_t)(HIST_SUB + i % HIST_SUB + 1) << (e - HIST_SUB_BITS)) - 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Adds a connection to the heap of waiting connections
+ */
+static void push_waiting(struct conn *conn)
+{
+    size_t i = nwaiting++;
+
+    while (i > 0 && waiting[(i - 1) / 2]->due > conn->due) {
+        waiting[i] = waiting[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    waiting[i] = conn;
+}
+
+/**
+ * @brief Removes the connection whose guess is due first from the heap
+ */
+static struct conn *pop_waiting(void)
+{
+    struct conn *top = waiting[0];
+    struct conn *last = waiting[--nwaiting];
+    size_t i = 0;
+
+    for (;;) {
+        size_t child = 2 * i + 1;
+
+        if (child >= nwaiting) {
+            break;
+        }
+        if (child + 1 < nwaiting && waiting[child + 1]->due < waiting[child]->due) {
+            child++;
+        }
+        if (waiting[child]->due >= last->due) {
+            break;
+        }
+        waiting[i] = waiting[child];
+        i = child;
+    }
+    if (nwaiting > 0) {
+        waiting[i] = last;
+    }
+    return top;
+}
+
+/**
+ * @brief Closes the connection of a game and frees it
+ */
+static void finish_conn(struct conn *conn, struct conn **free_conns, size_t *nfree)
+{
+    (void) close(conn->fd);     /* also removes it from the epoll set */
+    conn->fd = -1;
+    conn->game = NULL;
+    free_conns[(*nfree)++] = conn;
+}
+
+/**
+ * @brief Sends the next guess of a game
+ * @return 0 on success, -1 if the connection failed
+ */
+static int send_guess(struct conn *conn, uint64_t now)
+{
+    uint8_t request[WIRE_HELLO_BYTES + REQUEST_BYTES];
+    size_t len = 0;
+
+    /* the greeting goes in front of the first guess */
+    if (conn->next == 0) {
+        put_wire_hello(request);
+        len = WIRE_HELLO_BYTES;
+    }
+    put_request(&request[len], conn->game->rounds[conn->next].guess);
+    len += REQUEST_BYTES;
+    if (now > conn->due && now - conn->due > max_lag) {
+        max_lag = now - conn->due;
+    }
+    conn->in_len = 0;
+    conn->sent = now;
+    return (send(conn->fd, request, len, MSG_NOSIGNAL) == (ssize_t)len) ? 0 : -1;
+}
+
+/**
+ * @brief Opens the connection of a game
+ * @return 0 on success, -1 if it failed
+ */
+static int open_conn(int epfd, struct conn *conn)
+{
+    struct epoll_event ev;
+    int optval = 1;
+
+    conn->fd = socket(server_addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (conn->fd < 0) {
+        return -1;
+    }
+    if (server_addr.ss_family == AF_INET) {
+        (void) setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof optval);
+    }
+    conn->connecting = true;
+    conn->draining = false;
+    if (connect(conn->fd, (struct sockaddr *)&server_addr, server_addrlen) < 0 && errno != EINPROGRESS) {
+        return -1;
+    }
+    /* the first guess goes out once the socket is writable, which it is right away if connected */
+    ev.events = EPOLLOUT;
+    ev.data.ptr = conn;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, conn->fd, &ev);
+}
+
+/**
+ * @brief Program entry point
+ * @param argc The argument counter
+ * @param argv The argument vector
+ * @return EXIT_SUCCESS if every game could be played, EXIT_FAILURE otherwise
+ */
+int main(int argc, char **argv)
+{
+    struct capture_record *records;
+    struct replay_game *games;
+    struct conn *conns, **free_conns;
+    struct epoll_event events[MAX_EVENTS];
+    size_t nrecords, ngames = 0, nconns = DEFAULT_CONNECTIONS, nfree, next_game = 0;
+    uint64_t last = 0;
+    char *endptr;
+    int c, epfd;
+
+    if (argc > 0) {
+        progname = argv[0];
+    }
+    while ( (c = getopt(argc, argv, "fx:c:")) != -1 ) {
+        switch (c) {
+        case 'f': /* so schnell wie moeglich */
+            fast = true;
+            break;
+        case 'x': /* Faktor fuer die Geschwindigkeit */
+            errno = 0;
+            speed = strtod(optarg, &endptr);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || !(speed > 0)) {
+                errno = 0;
+                bail_out(EXIT_FAILURE, "<speed> has to be a positive number");
+            }
+            break;
+        case 'c': /* hoechstens so viele Spiele gleichzeitig */
+            errno = 0;
+            long value = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || value < 1 || value > MAX_CONNECTIONS) {
+                errno = 0;
+                bail_out(EXIT_FAILURE, "<connections> has to be between 1 and %d", MAX_CONNECTIONS);
+            }
+            nconns = (size_t)value;
+            break;
+        default:  /* ungueltiges Argument */
+            bail_out(EXIT_FAILURE, USAGE, progname);
+        }
+    }
+    if (argc - optind == 2 && strncmp(argv[optind + 1], UNIX_PREFIX, strlen(UNIX_PREFIX)) == 0) {
+        struct sockaddr_un *addr = (struct sockaddr_un *)&server_addr;
+        const char *path = argv[optind + 1] + strlen(UNIX_PREFIX);
+
+        if (strlen(path) >= sizeof addr->sun_path) {
+            bail_out(EXIT_FAILURE, "Invalid unix domain socket path: %s", path);
+        }
+        addr->sun_family = AF_UNIX;
+        (void) strcpy(addr->sun_path, path);
+        server_addrlen = sizeof *addr;
+    } else if (argc - optind == 3) {
+        struct addrinfo hints, *ai;
+
+        (void) memset(&hints, 0, sizeof hints);
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        int err = getaddrinfo(argv[optind + 1], argv[optind + 2], &hints, &ai);
+        if (err != 0) {
+            bail_out(EXIT_FAILURE, "getaddrinfo: %s", gai_strerror(err));
+        }
+        (void) memcpy(&server_addr, ai->ai_addr, ai->ai_addrlen);
+        server_addrlen = ai->ai_addrlen;
+        freeaddrinfo(ai);
+    } else {
+        bail_out(EXIT_FAILURE, USAGE, progname);
+    }
+
+    /* group the rounds by game and order the games by their start */
+    if (load_capture(argv[optind], &records, &nrecords) < 0) {
+        bail_out(EXIT_FAILURE, "Could not read the capture file %s", argv[optind]);
+    }
+    qsort(records, nrecords, sizeof *records, compare_records);
+    for (size_t i = 0; i < nrecords; ++i) {
+        ngames += (i == 0 || records[i].game != records[i - 1].game);
+        last = (records[i].time > last) ? records[i].time : last;
+    }
+    if ( (games = malloc((ngames > 0 ? ngames : 1) * sizeof *games)) == NULL) {
+        bail_out(EXIT_FAILURE, "malloc");
+    }
+    ngames = 0;
+    for (size_t i = 0; i < nrecords; ++i) {
+        if (i == 0 || records[i].game != records[i - 1].game) {
+            games[ngames].rounds = &records[i];
+            games[ngames++].count = 0;
+        }
+        games[ngames - 1].count++;
+    }
+    qsort(games, ngames, sizeof *games, compare_games);
+
+    conns = calloc(nconns, sizeof *conns);
+    free_conns = calloc(nconns, sizeof *free_conns);
+    waiting = calloc(nconns, sizeof *waiting);
+    if (conns == NULL || free_conns == NULL || waiting == NULL) {
+        bail_out(EXIT_FAILURE, "calloc");
+    }
+    for (size_t i = 0; i < nconns; ++i) {
+        conns[i].fd = -1;
+        free_conns[i] = &conns[nconns - 1 - i];
+    }
+    nfree = nconns;
+    if ( (epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        bail_out(EXIT_FAILURE, "epoll_create1");
+    }
+
+    /* the captured times count from the first round, scaled by the speed */
+    first = (ngames > 0) ? games[0].rounds[0].time : 0;
+    uint64_t start = now_ns();
+
+    while (next_game < ngames || nfree < nconns) {
+        uint64_t now = now_ns() - start;
+        int timeout = -1;
+
+        while (next_game < ngames && nfree > 0 && replay_time(&games[next_game].rounds[0]) <= now) {
+            struct conn *conn = free_conns[--nfree];
+
+            conn->game = &games[next_game++];
+            conn->next = 0;
+            conn->due = replay_time(&conn->game->rounds[0]);
+            if (open_conn(epfd, conn) < 0) {
+                errors++;
+                if (conn->fd >= 0) {
+                    finish_conn(conn, free_conns, &nfree);
+                } else {
+                    conn->game = NULL;
+                    free_conns[nfree++] = conn;
+                }
+            }
+        }
+        while (nwaiting > 0 && waiting[0]->due <= now) {
+            struct conn *conn = pop_waiting();
+
+            if (send_guess(conn, now) < 0) {
+                errors++;
+                finish_conn(conn, free_conns, &nfree);
+            }
+        }
+
+        /* sleep until the next game or guess is due */
+        uint64_t wake = UINT64_MAX;
+        if (next_game < ngames && nfree > 0) {
+            wake = replay_time(&games[next_game].rounds[0]);
+        }
+        if (nwaiting > 0 && waiting[0]->due < wake) {
+            wake = waiting[0]->due;
+        }
+        if (wake != UINT64_MAX) {
+            timeout = (wake > now) ? (int)((wake - now + 999999) / 1000000) : 0;
+        }
+
+        int n = epoll_wait(epfd, events, MAX_EVENTS, timeout);
+        now = now_ns() - start;
+        for (int i = 0; i < n; ++i) {
+            struct conn *conn = events[i].data.ptr;
+            uint8_t buffer[16];
+
+            if (conn->connecting) {
+                struct epoll_event ev;
+                int error = 0;
+                socklen_t len = sizeof error;
+
+                conn->connecting = false;
+                ev.events = EPOLLIN;
+                ev.data.ptr = conn;
+                if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0 ||
+                    epoll_ctl(epfd, EPOLL_CTL_MOD, conn->fd, &ev) < 0 || send_guess(conn, now) < 0) {
+                    errors++;
+                    finish_conn(conn, free_conns, &nfree);
+                }
+                continue;
+            }
+
+            size_t expected = (conn->next == 0 ? WIRE_HELLO_BYTES : 0) + RESPONSE_BYTES;
+            ssize_t r;
+
+            if (conn->draining) {
+                r = recv(conn->fd, buffer, sizeof buffer, 0);
+                if (r <= 0 && !(r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))) {
+                    finish_conn(conn, free_conns, &nfree);
+                }
+                continue;
+            }
+            r = recv(conn->fd, &conn->in[conn->in_len], expected - conn->in_len, 0);
+            if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                continue;
+            }
+            if (r <= 0 || (conn->in_len + (size_t)r == expected && expected > RESPONSE_BYTES &&
+                !wire_hello_ok(conn->in))) {
+                errors++;   /* closed early, or a server of another variant */
+                finish_conn(conn, free_conns, &nfree);
+                continue;
+            }
+            conn->in_len += (size_t)r;
+            if (conn->in_len < expected) {
+                continue;
+            }
+
+            const struct capture_record *round = &conn->game->rounds[conn->next++];
+            mm_response_t response = get_response(&conn->in[expected - RESPONSE_BYTES]);
+            hist[hist_index(now_ns() - start - conn->sent)]++;
+            rounds++;
+            if (response == round->response) {
+                matched++;
+            } else {
+                different++;
+            }
+            if (RED_OF(response) == SLOTS || (response & (1 << PARITY_ERR_BIT | 1 << GAME_LOST_ERR_BIT))) {
+                ended_early += (conn->next < conn->game->count);
+                conn->draining = true;
+            } else if (conn->next == conn->game->count) {
+                cut_short++;    /* the capture has no more guesses of this game */
+                finish_conn(conn, free_conns, &nfree);
+            } else {
+                conn->due = replay_time(&conn->game->rounds[conn->next]);
+                if (conn->due <= now) {
+                    if (send_guess(conn, now) < 0) {
+                        errors++;
+                        finish_conn(conn, free_conns, &nfree);
+                    }
+                } else {
+                    push_waiting(conn);
+                }
+            }
+        }
+    }
+    double elapsed = (now_ns() - start) / 1e9;
+    double captured = (last - first) / 1e9;
+
+    if (elapsed <= 0) {
+        elapsed = 1e-9;
+    }
+    (void) printf("replayed %zu games, %lu rounds in %.2f s (captured in %.2f s): %.0f games/s, %.0f rounds/s\n",
+        ngames, rounds, elapsed, captured, ngames / elapsed, rounds / elapsed);
+    (void) printf("responses: %lu as captured, %lu different; games ended early %lu, cut short %lu, errors %lu\n",
+        matched, different, ended_early, cut_short, errors);
+    if (rounds > 0) {
+        (void) printf("round latency p50 %.1f us, p99 %.1f us, p999 %.1f us, max %.1f us",
+            percentile(0.5) / 1e3, percentile(0.99) / 1e3, percentile(0.999) / 1e3, percentile(1.0) / 1e3);
+        if (!fast) {
+            (void) printf(", largest lag behind the capture %.1f ms", max_lag / 1e6);
+        }
+        (void) printf("\n");
+    }
+
+    (void) close(epfd);
+    free(waiting);
+    free(free_conns);
+    free(conns);
+    free(games);
+    free(records);
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
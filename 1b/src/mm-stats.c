@@ -0,0 +1,182 @@
+/**
+ * @file mm-stats.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Shows the live counters of a mastermind server started with --metrics.
+ * @details Maps the metrics file read-only and prints the sums over all event loops: games by result,
+ * rounds, bytes and the percentiles of the round latency, which are upper bounds of the histogram buckets.
+ * With -t every loop is printed as well, with -i the counters are printed again every interval together
+ * with the rates since the previous output. Reading never disturbs the server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include "metrics.h"
+
+/* === Constants === */
+
+#define USAGE "Usage: %s [-t] [-i <seconds>] <metrics-file>"
+
+
+/* === Global Variables === */
+
+/* Name of the program with default value */
+static const char *progname = "mm-stats";
+
+
+/* === Implementations === */
+
+/**
+ * @brief terminate program on program error
+ * @param exitcode exit code
+ * @param fmt format string
+ */
+static void bail_out(int exitcode, const char *fmt, ...)
+{
+    va_list ap;
+
+    (void) fprintf(stderr, "%s: ", progname);
+    if (fmt != NULL) {
+        va_start(ap, fmt);
+        (void) vfprintf(stderr, fmt, ap);
+        va_end(ap);
+    }
+    if (errno != 0) {
+        (void) fprintf(stderr, ": %s", strerror(errno));
+    }
+    (void) fprintf(stderr, "\n");
+
+    exit(exitcode);
+}
+
+/**
+ * @brief Returns the upper bound in nanoseconds of the bucket holding the given fraction of the rounds
+ */
+static uint64_t latency_percentile(const struct loop_metrics *m, double fraction)
+{
+    uint64_t total = 0, seen = 0;
+
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+        total += m->latency[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += m->latency[i];
+        if (seen >= fraction * total) {
+            return (i == 0) ? 0 : (uint64_t)1 << i;
+        }
+    }
+    return (uint64_t)1 << (LATENCY_BUCKETS - 1);
+}
+
+/**
+ * @brief Prints the counters of one loop or of the sum
+ * @param name Label of the line
+ * @param m The counters
+ */
+static void print_metrics(const char *name, const struct loop_metrics *m)
+{
+    uint64_t finished = m->games_ended - m->aborted;
+
+    (void) printf("%s: games started %lu, running %lu, won %lu, parity errors %lu, lost %lu (timed out %lu), "
+        "multiple errors %lu, aborted %lu\n", name,
+        (unsigned long)m->games_started, (unsigned long)(m->games_started - m->games_ended),
+        (unsigned long)m->results[EXIT_SUCCESS], (unsigned long)m->results[EXIT_PARITY_ERROR],
+        (unsigned long)m->results[EXIT_GAME_LOST], (unsigned long)m->expired,
+        (unsigned long)m->results[EXIT_MULTIPLE_ERRORS], (unsigned long)m->aborted);
+    (void) printf("%s: rounds %lu (%.2f per finished game), bytes in %lu, out %lu, "
+        "round latency p50 <= %lu ns, p99 <= %lu ns, p999 <= %lu ns\n", name,
+        (unsigned long)m->rounds, finished > 0 ? (double)m->rounds / finished : 0.0,
+        (unsigned long)m->bytes_in, (unsigned long)m->bytes_out,
+        (unsigned long)latency_percentile(m, 0.5), (unsigned long)latency_percentile(m, 0.99),
+        (unsigned long)latency_percentile(m, 0.999));
+}
+
+/**
+ * @brief Program entry point
+ * @param argc The argument counter
+ * @param argv The argument vector
+ * @return EXIT_SUCCESS, EXIT_FAILURE if the file cannot be read
+ */
+int main(int argc, char *argv[])
+{
+    struct metrics metrics;
+    struct loop_metrics previous;
+    bool per_loop = false;
+    long int interval = 0;
+    char *endptr;
+    int c;
+
+    if (argc > 0) {
+        progname = argv[0];
+    }
+    while ( (c = getopt(argc, argv, "ti:")) != -1 ) {
+        switch (c) {
+        case 't': /* jede Event-Loop einzeln ausgeben */
+            per_loop = true;
+            break;
+        case 'i': /* Ausgabe alle <seconds> Sekunden wiederholen */
+            errno = 0;
+            interval = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' || interval < 1) {
+                errno = 0;
+                bail_out(EXIT_FAILURE, "<seconds> has to be a positive number");
+            }
+            break;
+        default:  /* ungueltiges Argument */
+            bail_out(EXIT_FAILURE, USAGE, progname);
+        }
+    }
+    if (argc - optind != 1) {
+        bail_out(EXIT_FAILURE, USAGE, progname);
+    }
+    if (open_metrics(&metrics, argv[optind]) < 0) {
+        bail_out(EXIT_FAILURE, "Could not read the metrics file %s", argv[optind]);
+    }
+
+    (void) memset(&previous, 0, sizeof previous);
+    for (bool first = true; ; first = false) {
+        struct loop_metrics sum;
+
+        (void) memset(&sum, 0, sizeof sum);
+        (void) printf("uptime %lu s, %u event loops\n",
+            (unsigned long)(time(NULL) - (time_t)metrics.header->started), metrics.header->loops);
+        for (unsigned int id = 0; id < metrics.header->loops; id++) {
+            struct loop_metrics one;
+
+            (void) memset(&one, 0, sizeof one);
+            sum_metrics(&one, loop_metrics(&metrics, id));
+            if (per_loop) {
+                char name[32];
+                (void) snprintf(name, sizeof name, "loop %u", id);
+                print_metrics(name, &one);
+            }
+            sum_metrics(&sum, &one);
+        }
+        print_metrics("total", &sum);
+        if (interval == 0) {
+            break;
+        }
+        if (!first) {
+            (void) printf("rates: %.0f games/s, %.0f rounds/s\n",
+                (double)(sum.games_ended - previous.games_ended) / interval,
+                (double)(sum.rounds - previous.rounds) / interval);
+        }
+        (void) printf("\n");
+        (void) fflush(stdout);
+        previous = sum;
+        (void) sleep((unsigned int)interval);
+    }
+    close_metrics(&metrics);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+/**
+ * @file secrets.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the secrets module
+ */
+
+#include "secrets.h"
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+
+/* === Constants === */
+
+/** @brief Length of a line in a secret file */
+#define LINE_LENGTH (SLOTS + 1)
+
+/** @brief The letters of the colors, in the order of their values */
+static const char color_letters[] = COLOR_LETTERS;
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Returns the value of a color letter, -1 if it is no color
+ */
+static int color_of(char letter);
+
+/**
+ * @brief Mixes a seed into a well distributed generator state (splitmix64)
+ */
+static uint64_t mix_seed(uint64_t seed);
+
+
+/* === Implementations === */
+
+static int color_of(char letter)
+{
+    for (int color = 0; color < COLORS; color++) {
+        if (color_letters[color] == letter) {
+            return color;
+        }
+    }
+    return -1;
+}
+
+int parse_secret(const char *text, uint8_t *secret)
+{
+    for (int i = 0; i < SLOTS; i++) {
+        int color = color_of(text[i]);
+
+        if (color < 0) {
+            return i;
+        }
+        secret[i] = (uint8_t)color;
+    }
+    return (text[SLOTS] == '\0') ? -1 : SLOTS;
+}
+
+void fixed_secrets(struct secret_source *source, const uint8_t *secret)
+{
+    (void) memset(source, 0, sizeof *source);
+    source->mode = SECRETS_FIXED;
+    (void) memcpy(source->fixed, secret, SLOTS);
+}
+
+int map_secrets(struct secret_source *source, const char *path)
+{
+    struct stat st;
+    void *map;
+    int fd;
+
+    (void) memset(source, 0, sizeof *source);
+    if ( (fd = open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) < 0) {
+        (void) close(fd);
+        return -1;
+    }
+    /* every line is a secret and a newline, the newline of the last one is optional */
+    size_t size = (size_t)st.st_size;
+    if (size == 0 || (size % LINE_LENGTH != 0 && size % LINE_LENGTH != SLOTS)) {
+        (void) close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    (void) close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    /* check the file once, so that handing out a secret cannot fail */
+    const char *list = map;
+    size_t count = (size + 1) / LINE_LENGTH;
+    for (size_t i = 0; i < count; i++) {
+        const char *line = &list[i * LINE_LENGTH];
+
+        for (int j = 0; j < SLOTS; j++) {
+            if (color_of(line[j]) < 0) {
+                (void) munmap(map, size);
+                errno = EINVAL;
+                return -1;
+            }
+        }
+        if (i + 1 < count && line[SLOTS] != '\n') {
+            (void) munmap(map, size);
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    (void) madvise(map, size, MADV_WILLNEED);
+
+    source->mode = SECRETS_LIST;
+    source->list = list;
+    source->list_size = size;
+    source->count = count;
+    return 0;
+}
+
+void random_secrets(struct secret_source *source, uint64_t seed)
+{
+    (void) memset(source, 0, sizeof *source);
+    source->mode = SECRETS_RANDOM;
+    source->seed = seed;
+}
+
+void release_secrets(struct secret_source *source)
+{
+    if (source->mode == SECRETS_LIST && source->list != NULL) {
+        (void) munmap((void *)source->list, source->list_size);
+        source->list = NULL;
+    }
+}
+
+static uint64_t mix_seed(uint64_t seed)
+{
+    uint64_t z = seed + 0x9e3779b97f4a7c15ULL;
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return (z == 0) ? 1 : z;    /* xorshift must not start at 0 */
+}
+
+void init_picker(struct secret_picker *picker, struct secret_source *source, unsigned int id)
+{
+    picker->source = source;
+    picker->state = mix_seed(source->seed ^ ((uint64_t)id << 32));
+}
+
+void next_secret(struct secret_picker *picker, uint8_t *secret)
+{
+    struct secret_source *source = picker->source;
+
+    switch (source->mode) {
+    case SECRETS_FIXED:
+        (void) memcpy(secret, source->fixed, SLOTS);
+        break;
+    case SECRETS_LIST: {
+        unsigned long n = __atomic_fetch_add(&source->next, 1, __ATOMIC_RELAXED);
+        const char *line = &source->list[(n % source->count) * LINE_LENGTH];
+
+        for (int i = 0; i < SLOTS; i++) {
+            secret[i] = (uint8_t)color_of(line[i]);
+        }
+        break;
+    }
+    case SECRETS_RANDOM: {
+        /* xorshift64*, the high bits are the good ones */
+        uint64_t x = picker->state;
+
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        picker->state = x;
+#if (COLORS & (COLORS - 1)) == 0
+        x = (x * 0x2545f4914f6cdd1dULL) >> (64 - CODE_BITS);
+        for (int i = 0; i < SLOTS; i++) {
+            secret[i] = x & (COLORS - 1);
+            x >>= SHIFT_WIDTH;
+        }
+#else
+        /* the high bits taken as a number in base COLORS */
+        x = (x * 0x2545f4914f6cdd1dULL) >> 16;
+        for (int i = 0; i < SLOTS; i++) {
+            secret[i] = x % COLORS;
+            x /= COLORS;
+        }
+#endif
+        break;
+    }
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * @file secrets.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Where the secrets of the games come from.
+ * @details A secret source hands out the secret of every new game. It is either the single secret given on the
+ * command line, a list of secrets read from a file and handed out round-robin, or a pseudo random generator.
+ * Every thread draws from the source through its own struct secret_picker, so the generator needs no locking
+ * and a fixed seed reproduces the same sequence of secrets per thread.
+ *
+ * A secret file holds one secret per line, written like the <secret-sequence> argument (e.g. "rgbvw"). The
+ * file is mapped into memory and its lines are only decoded when they are handed out.
+ */
+
+#ifndef SECRETS_H
+#define SECRETS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+/* === Type Definitions === */
+
+/** @brief The kinds of secret sources */
+enum secret_mode {
+    SECRETS_FIXED,      /**< every game has the same secret */
+    SECRETS_LIST,       /**< the secrets of a file, round-robin */
+    SECRETS_RANDOM      /**< a pseudo random secret per game */
+};
+
+/** @brief A source of secrets shared by all threads */
+struct secret_source {
+    enum secret_mode mode;
+    uint8_t fixed[SLOTS];       /**< the secret of SECRETS_FIXED */
+    const char *list;           /**< the mapped secret file of SECRETS_LIST */
+    size_t list_size;           /**< size of the mapping in bytes */
+    size_t count;               /**< number of secrets in the list */
+    unsigned long next;         /**< round-robin position in the list, updated atomically */
+    uint64_t seed;              /**< the seed of SECRETS_RANDOM */
+};
+
+/** @brief The per-thread view of a secret source */
+struct secret_picker {
+    struct secret_source *source;
+    uint64_t state;             /**< state of the random generator */
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Parses a secret like "rgbvw"
+ * @param text The secret, exactly SLOTS color letters
+ * @param secret Buffer for the colors
+ * @return -1 on success, otherwise the position of the first invalid character (SLOTS if too short)
+ */
+int parse_secret(const char *text, uint8_t *secret);
+
+/**
+ * @brief Initializes a source which always hands out the same secret
+ */
+void fixed_secrets(struct secret_source *source, const uint8_t *secret);
+
+/**
+ * @brief Initializes a source with the secrets of a file
+ * @param source The source to initialize
+ * @param path The secret file
+ * @return 0 on success, -1 on error (errno is set, EINVAL if the file is malformed or empty)
+ */
+int map_secrets(struct secret_source *source, const char *path);
+
+/**
+ * @brief Initializes a source of pseudo random secrets
+ * @param seed Every thread derives its generator from this seed and its id
+ */
+void random_secrets(struct secret_source *source, uint64_t seed);
+
+/**
+ * @brief Releases the resources of a source
+ */
+void release_secrets(struct secret_source *source);
+
+/**
+ * @brief Prepares a thread for drawing from a source
+ * @param picker The picker of the thread
+ * @param source The source
+ * @param id A number unique among the threads
+ */
+void init_picker(struct secret_picker *picker, struct secret_source *source, unsigned int id);
+
+/**
+ * @brief Hands out the secret of a new game
+ * @param picker The picker of the calling thread
+ * @param secret Buffer for the colors
+ */
+void next_secret(struct secret_picker *picker, uint8_t *secret);
+
+#endif /* SECRETS_H */
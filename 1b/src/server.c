@@ -19,6 +19,36 @@
  * @date 10.04.2015
  * 
  * @brief This module behaves as a server in the mastermind game.
+ * @details By default the server plays a single game and exits with its result. With -m it keeps running
+ * and serves any number of clients concurrently, see eventloop.h. With --threads N there are N event loops
+ * in N threads, each with its own listening socket bound with SO_REUSEPORT, so the kernel distributes the
+ * connections among them and the threads share nothing.
+ *
+ * Without <secret-sequence> every game gets its own secret: with --secrets FILE the secrets of the file are
+ * handed out round-robin, otherwise they are drawn from a pseudo random generator, which --seed makes
+ * reproducible. A long-running server prints the results of all games when it is stopped.
+ *
+ * Clients may use the batch protocol described in game.h in every mode.
+ *
+ * Instead of a port the server may listen on a unix domain socket given as unix:<path>, which spares
+ * co-located clients the TCP stack. Such a socket has no SO_REUSEPORT, so there all event loops accept from
+ * the same listening socket.
+ *
+ * With --udp the games are played over UDP datagrams instead of connections, see udploop.h.
+ *
+ * With --io-uring the event loops use io_uring instead of epoll, see uringloop.h. If the kernel does not
+ * offer it, the server says so and uses epoll.
+ *
+ * --idle-timeout, --round-timeout and --game-timeout limit the time a client may take (see session.h), a
+ * client exceeding a limit loses its game. By default only the idle time is limited, to
+ * DEFAULT_IDLE_TIMEOUT milliseconds.
+ *
+ * With --metrics FILE the event loops keep live counters in FILE (see metrics.h), which mm-stats shows while
+ * the server is running.
+ *
+ * With --capture FILE every round played is recorded in FILE (see capture.h), mm-replay plays the captured
+ * games again, for example against a changed server. The responses of a replay only match the captured ones
+ * if both servers hand out the same secrets to the same games, as with a fixed <secret-sequence>.
  */
 
 #include <stdio.h>
@@ -29,30 +59,40 @@
 #include <stdarg.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <signal.h>
 #include <errno.h>
 #include <limits.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/eventfd.h>
+#include "game.h"
+#include "secrets.h"
+#include "eventloop.h"
+#include "udploop.h"
+#include "uringloop.h"
 
 
 /* === Constants === */
 
-#define MAX_TRIES (35)
-#define SLOTS (5)
-#define COLORS (8)
+#define BACKLOG (5)
+#define MULTI_BACKLOG (SOMAXCONN)
+#define MAX_THREADS (64)
 
-#define READ_BYTES (2)
-#define WRITE_BYTES (1)
-#define BUFFER_BYTES (2)
-#define SHIFT_WIDTH (3)
-#define PARITY_ERR_BIT (6)
-#define GAME_LOST_ERR_BIT (7)
+/* Milliseconds a client may stay silent unless --idle-timeout says otherwise */
+#define DEFAULT_IDLE_TIMEOUT (60000)
 
-#define EXIT_PARITY_ERROR (2)
-#define EXIT_GAME_LOST (3)
-#define EXIT_MULTIPLE_ERRORS (4)
+/* Prefix of a unix domain socket path given instead of a port */
+#define UNIX_PREFIX "unix:"
 
-#define BACKLOG (5)
+#define USAGE "Usage: %s [-m] [-u|--udp | -i|--io-uring] [-t|--threads <threads>] [-f|--secrets <secret-file> | -s|--seed <seed>] " \
+    "[-I|--idle-timeout <ms>] [-R|--round-timeout <ms>] [-G|--game-timeout <ms>] [-M|--metrics <file>] " \
+    "[-C|--capture <file>] <server-port>|unix:<path> [<secret-sequence>]"
 
 
 /* === Macros === */
@@ -78,6 +118,18 @@ static int sockfd = -1;
 /* File descriptor for connection socket */
 static int connfd = -1;
 
+/* Path of the unix domain socket to remove at the end, NULL if none was created */
+static const char *socket_path = NULL;
+
+/* The secrets of the games */
+static struct secret_source secrets = {.mode = SECRETS_FIXED};
+
+/* The live counters, header is NULL without --metrics */
+static struct metrics metrics = {.header = NULL};
+
+/* The recorded rounds, fd is -1 without --capture */
+static struct capture capture = {.fd = -1};
+
 /* This variable is set upon receipt of a signal */
 volatile sig_atomic_t quit = 0;
 
@@ -86,7 +138,32 @@ volatile sig_atomic_t quit = 0;
 
 struct opts {
     long int portno;
+    const char *unix_path;      /* unix:<path> was given instead of a port */
     uint8_t secret[SLOTS];
+    bool has_secret;            /* <secret-sequence> was given */
+    const char *secret_file;    /* -f: secrets to hand out round-robin */
+    unsigned long long seed;    /* -s: seed of the random secrets */
+    bool seeded;                /* -s was given */
+    bool multi;                 /* -m: keep serving clients concurrently */
+    bool udp;                   /* -u: play over UDP datagrams, implies multi */
+    bool uring;                 /* -i: use io_uring instead of epoll, implies multi */
+    long int threads;           /* -t: number of event loops, implies multi */
+    struct session_limits limits;   /* -I, -R, -G: time limits of the clients */
+    const char *metrics_file;   /* -M: file for the live counters, implies multi */
+    const char *capture_file;   /* -C: file recording the rounds, implies multi */
+};
+
+/* An event loop running in its own thread */
+struct worker {
+    pthread_t thread;
+    int listenfd;
+    const struct loop_config *config;
+    bool udp;
+    bool uring;
+    unsigned int id;
+    struct game_stats stats;
+    int ret;
+    int error;
 };
 
 
@@ -113,13 +190,65 @@ static void parse_args(int argc, char **argv, struct opts *options);
 static uint8_t *read_from_client(int sockfd_con, uint8_t *buffer, size_t n);
 
 /**
- * @brief Compute answer to request
- * @param req Client's guess
- * @param resp Buffer that will be sent to the client
- * @param secret The server's secret
- * @return Number of correct matches on success; -1 in case of a parity error
+ * @brief Sets the receive timeout of the connection of a single game to the nearest time limit
+ * @param fd The connection
+ * @param limits The time limits
+ * @param started Start of the game, see session_clock
+ * @param round_started Time of the last response
+ * @return 0 on success, -1 if a limit has already run out
+ */
+static int set_read_timeout(int fd, const struct session_limits *limits, uint64_t started, uint64_t round_started);
+
+/**
+ * @brief Parses a time limit in milliseconds
+ * @param arg The argument
+ * @param name Name of the option for the error message
+ * @return The limit, exits on error
+ */
+static unsigned int parse_timeout(const char *arg, const char *name);
+
+/**
+ * @brief Initializes the global secret source according to the options
+ * @param options The parsed arguments
+ */
+static void open_secrets(const struct opts *options);
+
+/**
+ * @brief Prints the results of the games of a long-running server
+ * @param stats The results
+ */
+static void print_stats(const struct game_stats *stats);
+
+/**
+ * @brief Create the listening socket
+ * @param options The parsed arguments, the socket listens on their port or unix domain socket
+ * @param backlog The backlog passed to listen(2)
+ * @param reuseport Set SO_REUSEPORT, only for TCP
+ * @return The socket, exits on error
  */
-static int compute_answer(uint16_t req, uint8_t *resp, uint8_t *secret);
+static int open_listener(const struct opts *options, int backlog, bool reuseport);
+
+/**
+ * @brief Create a listening unix domain socket, replacing a socket left behind at the path
+ * @param path The path to bind to
+ * @param backlog The backlog passed to listen(2)
+ * @return The socket, exits on error
+ */
+static int open_unix_listener(const char *path, int backlog);
+
+/**
+ * @brief Thread start routine running the event loop of a struct worker
+ * @param arg The struct worker
+ * @return arg
+ */
+static void *run_worker(void *arg);
+
+/**
+ * @brief Runs options->threads event loops in parallel until a signal arrives
+ * @param options The parsed arguments
+ * @param config The configuration of the loops
+ */
+static void serve_threads(const struct opts *options, struct loop_config *config);
 
 /**
  * @brief terminate program on program error
@@ -161,56 +290,232 @@ static uint8_t *read_from_client(int fd, uint8_t *buffer, size_t n)
     return buffer;
 }
 
-static int compute_answer(uint16_t req, uint8_t *resp, uint8_t *secret)
+static int set_read_timeout(int fd, const struct session_limits *limits, uint64_t started, uint64_t round_started)
 {
-    int colors_left[COLORS];
-    int guess[COLORS];
-    uint8_t parity_calc, parity_recv;
-    int red, white;
-    int j;
-
-    parity_recv = (req >> 15) & 1;
-
-    /* extract the guess and calculate parity */
-    parity_calc = 0;
-    for (j = 0; j < SLOTS; ++j) {
-        int tmp = req & 0x7;
-        parity_calc ^= tmp ^ (tmp >> 1) ^ (tmp >> 2);
-        guess[j] = tmp;
-        req >>= SHIFT_WIDTH;
-    }
-    parity_calc &= 0x1;
-
-    /* marking red and white */
-    (void) memset(&colors_left[0], 0, sizeof(colors_left));
-    red = white = 0;
-    for (j = 0; j < SLOTS; ++j) {
-        /* mark red */
-        if (guess[j] == secret[j]) {
-            red++;
-        } else {
-            colors_left[secret[j]]++;
+    uint64_t now = session_clock();
+    uint64_t timeout = limits->idle_ms;
+    struct timeval tv;
+
+    if (limits->round_ms > 0) {
+        if (now >= round_started + limits->round_ms) {
+            return -1;
+        }
+        if (timeout == 0 || round_started + limits->round_ms - now < timeout) {
+            timeout = round_started + limits->round_ms - now;
         }
     }
-    for (j = 0; j < SLOTS; ++j) {
-        /* not marked red */
-        if (guess[j] != secret[j]) {
-            if (colors_left[guess[j]] > 0) {
-                white++;
-                colors_left[guess[j]]--;
-            }
+    if (limits->game_ms > 0) {
+        if (now >= started + limits->game_ms) {
+            return -1;
+        }
+        if (timeout == 0 || started + limits->game_ms - now < timeout) {
+            timeout = started + limits->game_ms - now;
         }
     }
+    /* a timeout of 0 blocks forever */
+    tv.tv_sec = (time_t)(timeout / 1000);
+    tv.tv_usec = (suseconds_t)(timeout % 1000) * 1000;
+    return setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+}
+
+static unsigned int parse_timeout(const char *arg, const char *name)
+{
+    char *endptr;
+    unsigned long int value;
+
+    errno = 0;
+    value = strtoul(arg, &endptr, 10);
+    if (errno != 0 || endptr == arg || *endptr != '\0' || *arg == '-' || value > UINT_MAX) {
+        errno = 0;
+        bail_out(EXIT_FAILURE, "<%s> has to be a number of milliseconds", name);
+    }
+    return (unsigned int)value;
+}
+
+static void open_secrets(const struct opts *options)
+{
+    if (options->has_secret) {
+        fixed_secrets(&secrets, options->secret);
+    } else if (options->secret_file != NULL) {
+        if (map_secrets(&secrets, options->secret_file) < 0) {
+            bail_out(EXIT_FAILURE, "Could not read the secrets of %s", options->secret_file);
+        }
+    } else {
+        uint64_t seed = options->seeded ? options->seed : (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+        random_secrets(&secrets, seed);
+    }
+}
+
+static void print_stats(const struct game_stats *stats)
+{
+    (void) printf("Spiele: %lu, gewonnen: %lu, Paritaetsfehler: %lu, verloren: %lu (Zeit abgelaufen: %lu), "
+        "mehrere Fehler: %lu, abgebrochen: %lu, Runden: %lu\n",
+        stats->games, stats->results[EXIT_SUCCESS], stats->results[EXIT_PARITY_ERROR],
+        stats->results[EXIT_GAME_LOST], stats->expired, stats->results[EXIT_MULTIPLE_ERRORS], stats->aborted,
+        stats->rounds);
+}
+
+static int open_unix_listener(const char *path, int backlog)
+{
+    struct sockaddr_un sock_addr;
+    struct stat st;
+    int sockfd;
+
+    /* a socket left behind by an earlier run would make bind fail */
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        (void) unlink(path);
+    }
+    if ( (sockfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0) {
+        bail_out(EXIT_FAILURE, "Socket creation failed.");
+    }
+    (void) memset(&sock_addr, 0, sizeof sock_addr);
+    sock_addr.sun_family = AF_UNIX;
+    (void) strncpy(sock_addr.sun_path, path, sizeof sock_addr.sun_path - 1);
+    if (bind(sockfd, (struct sockaddr *)&sock_addr, sizeof sock_addr) < 0) {
+        (void) close(sockfd);
+        bail_out(EXIT_FAILURE, "Socket binding to %s failed.", path);
+    }
+    socket_path = path;
+    if (listen(sockfd, backlog) < 0) {
+        (void) close(sockfd);
+        bail_out(EXIT_FAILURE, "Could not set socket to passive.");
+    }
+    return sockfd;
+}
+
+static int open_listener(const struct opts *options, int backlog, bool reuseport)
+{
+    /* Create a new TCP/IP socket `sockfd`, and set the SO_REUSEADDR
+       option for this socket. Then bind the socket to localhost:portno
+       and listen. Terminate the program in case of an error.
+    */
+    int sockfd;
+	struct sockaddr_in sock_addr;
+	socklen_t sockaddr_size = sizeof (struct sockaddr_in);
+	int optval = 1;
+
+	if (options->unix_path != NULL) {
+		return open_unix_listener(options->unix_path, backlog);
+	}
+	
+	/* 1.) create socket and set options */
+	if ( (sockfd = socket(AF_INET, options->udp ? SOCK_DGRAM : SOCK_STREAM, 0)) < 0) {
+		bail_out(EXIT_FAILURE, "Socket creation failed.");
+	}
+	if ( setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof optval) < 0) {
+		(void) close(sockfd);
+		bail_out(EXIT_FAILURE, "Socket option setting failed.");
+	};
+	if ( reuseport && setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof optval) < 0) {
+		(void) close(sockfd);
+		bail_out(EXIT_FAILURE, "Socket option SO_REUSEPORT setting failed.");
+	}
+	
+	/* 2.) create sockaddr_in */
+	(void) memset(&sock_addr, 0, sizeof sock_addr);
+	sock_addr.sin_family = AF_INET; 
+	sock_addr.sin_port = htons(options->portno);
+	sock_addr.sin_addr.s_addr = INADDR_ANY;
+	
+	/* 3.) bind to a port */
+	if ( (bind(sockfd, (struct sockaddr *)&sock_addr, sockaddr_size)) < 0) {
+		(void) close(sockfd);
+		bail_out(EXIT_FAILURE, "Socket binding failed.");
+	} 
 
-    /* build response buffer */
-    resp[0] = red;
-    resp[0] |= (white << SHIFT_WIDTH);
-    if (parity_recv != parity_calc) {
-        resp[0] |= (1 << PARITY_ERR_BIT);
-        return -1;
+	/* 4.) listen for incoming connections, set socket to passive */
+	if ( !options->udp && (listen(sockfd, backlog)) < 0) {
+		(void) close(sockfd);
+		bail_out(EXIT_FAILURE, "Could not set socket to passive.");
+	}
+	return sockfd;
+}
+
+static void *run_worker(void *arg)
+{
+    struct worker *worker = arg;
+
+    if (worker->udp) {
+        worker->ret = run_udp_loop(worker->listenfd, worker->config, worker->id, &worker->stats, &quit);
+    } else if (worker->uring) {
+        worker->ret = run_uring_loop(worker->listenfd, worker->config, worker->id, &worker->stats, &quit);
     } else {
-        return red;
+        worker->ret = run_event_loop(worker->listenfd, worker->config, worker->id, &worker->stats, &quit);
+    }
+    worker->error = errno;
+    return arg;
+}
+
+static void serve_threads(const struct opts *options, struct loop_config *config)
+{
+    static struct worker workers[MAX_THREADS];
+    struct game_stats stats;
+    sigset_t blocked, old;
+    long int started = 0;
+    int ret = EXIT_SUCCESS;
+
+    /* the workers inherit the blocked signals, only this thread handles them */
+    (void) sigemptyset(&blocked);
+    (void) sigaddset(&blocked, SIGINT);
+    (void) sigaddset(&blocked, SIGTERM);
+    if (pthread_sigmask(SIG_BLOCK, &blocked, &old) != 0) {
+        bail_out(EXIT_FAILURE, "pthread_sigmask");
+    }
+    if ( (config->wake_fd = eventfd(0, EFD_CLOEXEC)) < 0) {
+        bail_out(EXIT_FAILURE, "eventfd");
+    }
+    for (long int i = 0; i < options->threads; i++) {
+        /* unix domain sockets have no SO_REUSEPORT, there all loops share the listener of the first one */
+        if (options->unix_path != NULL && i > 0) {
+            workers[i].listenfd = workers[0].listenfd;
+        } else {
+            workers[i].listenfd = open_listener(options, MULTI_BACKLOG, true);
+        }
+        workers[i].config = config;
+        workers[i].udp = options->udp;
+        workers[i].uring = options->uring;
+        workers[i].id = (unsigned int)i;
+        (void) memset(&workers[i].stats, 0, sizeof workers[i].stats);
+        workers[i].ret = 0;
+        workers[i].error = 0;
+        errno = pthread_create(&workers[i].thread, NULL, run_worker, &workers[i]);
+        if (errno != 0) {
+            if (workers[i].listenfd != workers[0].listenfd || i == 0) {
+                (void) close(workers[i].listenfd);
+            }
+            (void) fprintf(stderr, "%s: pthread_create: %s\n", progname, strerror(errno));
+            ret = EXIT_FAILURE;
+            quit = 1;
+            break;
+        }
+        started++;
     }
+
+    /* wait for SIGINT or SIGTERM, then wake up all loops */
+    while (!quit) {
+        (void) sigsuspend(&old);
+    }
+    uint64_t one = 1;
+    if (write(config->wake_fd, &one, sizeof one) != sizeof one) {
+        (void) fprintf(stderr, "%s: could not wake up the event loops\n", progname);
+    }
+
+    (void) memset(&stats, 0, sizeof stats);
+    for (long int i = 0; i < started; i++) {
+        (void) pthread_join(workers[i].thread, NULL);
+        if (workers[i].listenfd != workers[0].listenfd || i == 0) {
+            (void) close(workers[i].listenfd);
+        }
+        merge_stats(&stats, &workers[i].stats);
+        if (workers[i].ret < 0) {
+            (void) fprintf(stderr, "%s: event loop %ld: %s\n", progname, i, strerror(workers[i].error));
+            ret = EXIT_FAILURE;
+        }
+    }
+    (void) close(config->wake_fd);
+    print_stats(&stats);
+    free_resources();
+    exit(ret);
 }
 
 static void bail_out(int exitcode, const char *fmt, ...)
@@ -242,6 +547,15 @@ static void free_resources(void)
     if(sockfd >= 0) {
         (void) close(sockfd);
     }
+    if (socket_path != NULL) {
+        (void) unlink(socket_path);
+    }
+    release_secrets(&secrets);
+    close_metrics(&metrics);
+    uint64_t dropped = close_capture(&capture);
+    if (dropped > 0) {
+        (void) fprintf(stderr, "%s: %lu rounds could not be captured\n", progname, (unsigned long)dropped);
+    }
 }
 
 static void signal_handler(int sig)
@@ -261,10 +575,14 @@ int main(int argc, char *argv[])
 {
 
     struct opts options;
-    int round;
-    int ret;
+    struct secret_picker picker;
+    struct game game;
+    uint8_t secret[SLOTS];
+    bool batched = false;
+    uint64_t started, round_started;
 
     parse_args(argc, argv, &options);
+    open_secrets(&options);
 
     /* setup signal handlers */
     const int signals[] = {SIGINT, SIGTERM};
@@ -283,105 +601,183 @@ int main(int argc, char *argv[])
 
 
 
-    /* Create a new TCP/IP socket `sockfd`, and set the SO_REUSEADDR
-       option for this socket. Then bind the socket to localhost:portno,
-       listen, and wait for new connections, which should be assigned to
-       `connfd`. Terminate the program in case of an error.
-    */
-    int sockfd;
-	struct sockaddr_in sock_addr;
-	struct sockaddr_in clnt_addr;
-	socklen_t sockaddr_size = sizeof (struct sockaddr_in);
-	int optval = 1;
-	
-	/* 1.) create socket and set options */
-	if ( (sockfd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
-		bail_out(EXIT_FAILURE, "Socket creation failed.");
-	}
-	if ( setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof optval) < 0) {
-		bail_out(EXIT_FAILURE, "Socket option setting failed.");
-	};
-	
-	/* 2.) create sockaddr_in */
-	sock_addr.sin_family = AF_INET; 
-	sock_addr.sin_port = htons(options.portno);
-	sock_addr.sin_addr.s_addr = INADDR_ANY;
-	
-	/* 3.) bind to a port */
-	if ( (bind(sockfd, (struct sockaddr *)&sock_addr, sockaddr_size)) < 0) {
-		bail_out(EXIT_FAILURE, "Socket binding failed.");
-	} 
+    if (options.multi) {
+        struct loop_config config;
+        struct game_stats stats;
 
-	/* 4.) listen for incoming connections, set socket to passive */
-	if ( (listen(sockfd, BACKLOG)) < 0) {
-		bail_out(EXIT_FAILURE, "Could not set socket to passive.");
-	}
-	
-	/* 5.) Wait for a connection and assign the client to connfd */
+        config.secrets = &secrets;
+        config.wake_fd = -1;
+        config.limits = options.limits;
+        config.metrics = NULL;
+        if (options.metrics_file != NULL) {
+            if (create_metrics(&metrics, options.metrics_file, (unsigned int)options.threads) < 0) {
+                bail_out(EXIT_FAILURE, "Could not create the metrics file %s", options.metrics_file);
+            }
+            config.metrics = &metrics;
+        }
+        config.capture = NULL;
+        if (options.capture_file != NULL) {
+            if (create_capture(&capture, options.capture_file) < 0) {
+                bail_out(EXIT_FAILURE, "Could not create the capture file %s", options.capture_file);
+            }
+            config.capture = &capture;
+        }
+        if (raise_fd_limit() < 0) {
+            (void) fprintf(stderr, "%s: could not raise the limit of open files: %s\n", progname, strerror(errno));
+        }
+        if (options.uring && !uring_supported()) {
+            (void) fprintf(stderr, "%s: io_uring is not available (%s), using epoll\n", progname, strerror(errno));
+            options.uring = false;
+        }
+        if (options.threads > 1) {
+            serve_threads(&options, &config);
+        }
+        sockfd = open_listener(&options, MULTI_BACKLOG, false);
+        (void) memset(&stats, 0, sizeof stats);
+        if (options.udp) {
+            if (run_udp_loop(sockfd, &config, 0, &stats, &quit) < 0) {
+                bail_out(EXIT_FAILURE, "UDP loop");
+            }
+        } else if (options.uring) {
+            if (run_uring_loop(sockfd, &config, 0, &stats, &quit) < 0) {
+                bail_out(EXIT_FAILURE, "io_uring loop");
+            }
+        } else if (run_event_loop(sockfd, &config, 0, &stats, &quit) < 0) {
+            bail_out(EXIT_FAILURE, "event loop");
+        }
+        print_stats(&stats);
+        free_resources();
+        return EXIT_SUCCESS;
+    }
+
+    struct sockaddr_in clnt_addr;
+    socklen_t sockaddr_size = sizeof (struct sockaddr_in);
+
+    sockfd = open_listener(&options, BACKLOG, false);
+
+	/* Wait for a connection and assign the client to connfd */
 	if ( (connfd = accept(sockfd, (struct sockaddr *)&clnt_addr, &sockaddr_size)) < 0) {
 		bail_out(EXIT_FAILURE, "Connection with client failed.");
 	};
-	
-	
 
     /* accepted the connection */
-    ret = EXIT_SUCCESS;
-    for (round = 1; round <= MAX_TRIES && !quit; ++round) {
-        uint16_t request;
-        static uint8_t buffer[BUFFER_BYTES];
-        int correct_guesses;
-        int error = 0;
-
-        /* read from client */
-        if (read_from_client(connfd, &buffer[0], READ_BYTES) == NULL) {
-            if (quit) break; /* caught signal */
-            bail_out(EXIT_FAILURE, "read_from_client");
+    init_picker(&picker, &secrets, 0);
+    next_secret(&picker, secret);
+    start_game(&game, secret);
+    started = round_started = session_clock();
+    if (WIRE_HELLO_BYTES > 0 && !quit) {
+        uint8_t hello[WIRE_HELLO_BYTES + 1];
+
+        /* the greeting names the variant, a client of another one is turned away */
+        if (set_read_timeout(connfd, &options.limits, started, round_started) < 0 ||
+            read_from_client(connfd, hello, WIRE_HELLO_BYTES) == NULL) {
+            if (!quit && errno != EAGAIN && errno != EWOULDBLOCK) {
+                bail_out(EXIT_FAILURE, "read_from_client");
+            }
+            expire_game(&game);
+        } else if (!wire_hello_ok(hello)) {
+            errno = 0;
+            bail_out(EXIT_FAILURE, "The client plays another variant");
+        } else if (send(connfd, hello, WIRE_HELLO_BYTES, 0) < 0) {
+            bail_out(EXIT_FAILURE, "sending response to client failed");
+        }
+    }
+    while (game.result == GAME_RUNNING && !quit) {
+        mm_request_t request;
+        mm_response_t response;
+        static uint8_t buffer[1 + REQUEST_BYTES * MAX_BATCH];
+        static uint8_t reply[1 + RESPONSE_BYTES * MAX_BATCH];
+        size_t reply_len = RESPONSE_BYTES;
+
+        /* the receive timeout ends a game whose client takes too long */
+        if (set_read_timeout(connfd, &options.limits, started, round_started) < 0) {
+            expire_game(&game);
+            break;
         }
-        request = (buffer[1] << 8) | buffer[0];
-        DEBUG("Round %d: Received 0x%x\n", round, request);
 
-        /* compute answer */
-        correct_guesses = compute_answer(request, buffer, options.secret);
-        if (round == MAX_TRIES && correct_guesses != SLOTS) {
-            buffer[0] |= 1 << GAME_LOST_ERR_BIT;
+        if (batched) {
+            size_t count, answered;
+
+            /* read a batch: the number of guesses, then the guesses */
+            if (read_from_client(connfd, &buffer[0], 1) == NULL) {
+                if (quit) break; /* caught signal */
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    expire_game(&game);    /* receive timeout */
+                    break;
+                }
+                bail_out(EXIT_FAILURE, "read_from_client");
+            }
+            count = buffer[0];
+            if (count == 0 || count > MAX_BATCH) {
+                errno = 0;
+                bail_out(EXIT_FAILURE, "Invalid batch of %zu guesses", count);
+            }
+            if (read_from_client(connfd, &buffer[1], REQUEST_BYTES * count) == NULL) {
+                if (quit) break; /* caught signal */
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    expire_game(&game);    /* receive timeout */
+                    break;
+                }
+                bail_out(EXIT_FAILURE, "read_from_client");
+            }
+            DEBUG("Round %d: Received a batch of %zu\n", game.round + 1, count);
+
+            /* compute answers */
+            (void) play_batch(&game, &buffer[1], count, &reply[1], &answered);
+            reply[0] = (uint8_t)answered;
+            reply_len = 1 + RESPONSE_BYTES * answered;
+        } else {
+            /* read from client */
+            if (read_from_client(connfd, &buffer[0], REQUEST_BYTES) == NULL) {
+                if (quit) break; /* caught signal */
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    expire_game(&game);    /* receive timeout */
+                    break;
+                }
+                bail_out(EXIT_FAILURE, "read_from_client");
+            }
+            request = get_request(buffer);
+            DEBUG("Round %d: Received 0x%llx\n", game.round + 1, (unsigned long long)request);
+
+            if (request == BATCH_HELLO && game.round == 0) {
+                batched = true;
+                response = BATCH_ACK;
+            } else {
+                /* compute answer */
+                (void) play_round(&game, request, &response);
+            }
+            put_response(reply, response);
         }
 
-        DEBUG("Sending byte 0x%x\n", buffer[0]);
+        DEBUG("Sending %zu bytes, last 0x%x\n", reply_len, reply[reply_len - 1]);
 
         /* send message to client */
-		if ( send(connfd, (const void *)&buffer, WRITE_BYTES, 0) < 0) {
+		if ( send(connfd, (const void *)reply, reply_len, 0) < 0) {
 			bail_out(EXIT_FAILURE, "sending response to client failed");
 		}
 		
 
         /* We sent the answer to the client; now stop the game
            if its over, or an error occured */
-        if (*buffer & (1<<PARITY_ERR_BIT)) {
+        if (game.result == EXIT_PARITY_ERROR || game.result == EXIT_MULTIPLE_ERRORS) {
             (void) fprintf(stderr, "%s: Parity error\n", progname);
-            error = 1;
-            ret = EXIT_PARITY_ERROR;
         }
-        if (*buffer & (1 << GAME_LOST_ERR_BIT)) {
+        if (game.result == EXIT_GAME_LOST || game.result == EXIT_MULTIPLE_ERRORS) {
             (void) fprintf(stderr, "%s: Game lost\n", progname);
-            error = 1;
-            if (ret == EXIT_PARITY_ERROR) {
-                ret = EXIT_MULTIPLE_ERRORS;
-            } else {
-                ret = EXIT_GAME_LOST;
-            }
         }
-        if (error) {
-            break;
-        } else if (correct_guesses == SLOTS) {
+        if (game.result == EXIT_SUCCESS) {
             /* won */
-            (void) printf("Runden: %d\n", round);
-            break;
+            (void) printf("Runden: %d\n", game.round);
         }
+        round_started = session_clock();
+    }
+    if (game.expired) {
+        (void) fprintf(stderr, "%s: Game lost, the client took too long\n", progname);
     }
 
     /* we are done */
     free_resources();
-    return ret;
+    return (game.result == GAME_RUNNING) ? EXIT_SUCCESS : game.result;
 }
 
 static void parse_args(int argc, char **argv, struct opts *options)
@@ -390,81 +786,160 @@ static void parse_args(int argc, char **argv, struct opts *options)
     char *port_arg;
     char *secret_arg;
     char *endptr;
-    enum { beige, darkblue, green, orange, red, black, violet, white };
 
     if(argc > 0) {
         progname = argv[0];
     }
-    if (argc != 3) {
-        bail_out(EXIT_FAILURE,
-            "Usage: %s <server-port> <secret-sequence>", progname);
+    options->multi = false;
+    options->udp = false;
+    options->uring = false;
+    options->threads = 1;
+    options->limits.idle_ms = DEFAULT_IDLE_TIMEOUT;
+    options->limits.round_ms = 0;
+    options->limits.game_ms = 0;
+    options->metrics_file = NULL;
+    options->capture_file = NULL;
+    options->has_secret = false;
+    options->secret_file = NULL;
+    options->seeded = false;
+
+    static const struct option long_options[] = {
+        {"multi", no_argument, NULL, 'm'},
+        {"udp", no_argument, NULL, 'u'},
+        {"io-uring", no_argument, NULL, 'i'},
+        {"threads", required_argument, NULL, 't'},
+        {"secrets", required_argument, NULL, 'f'},
+        {"seed", required_argument, NULL, 's'},
+        {"idle-timeout", required_argument, NULL, 'I'},
+        {"round-timeout", required_argument, NULL, 'R'},
+        {"game-timeout", required_argument, NULL, 'G'},
+        {"metrics", required_argument, NULL, 'M'},
+        {"capture", required_argument, NULL, 'C'},
+        {NULL, 0, NULL, 0}
+    };
+    int c;
+    while ( (c = getopt_long(argc, argv, "muit:f:s:I:R:G:M:C:", long_options, NULL)) != -1 ) {
+        switch (c) {
+        case 'm': /* mehrere Clients gleichzeitig bedienen */
+            options->multi = true;
+            break;
+        case 'u': /* ueber UDP-Datagramme spielen */
+            options->udp = true;
+            options->multi = true;
+            break;
+        case 'i': /* io_uring statt epoll verwenden */
+            options->uring = true;
+            options->multi = true;
+            break;
+        case 't': /* Anzahl der Event-Loops */
+            errno = 0;
+            options->threads = strtol(optarg, &endptr, 10);
+            if (errno != 0 || endptr == optarg || *endptr != '\0' ||
+                options->threads < 1 || options->threads > MAX_THREADS) {
+                errno = 0;
+                bail_out(EXIT_FAILURE, "<threads> has to be between 1 and %d", MAX_THREADS);
+            }
+            options->multi = true;
+            break;
+        case 'f': /* Datei mit Geheimcodes */
+            options->secret_file = optarg;
+            break;
+        case 's': /* Startwert fuer zufaellige Geheimcodes */
+            errno = 0;
+            options->seed = strtoull(optarg, &endptr, 0);
+            if (errno != 0 || endptr == optarg || *endptr != '\0') {
+                errno = 0;
+                bail_out(EXIT_FAILURE, "<seed> has to be a number");
+            }
+            options->seeded = true;
+            break;
+        case 'I': /* maximale Zeit ohne Eingabe */
+            options->limits.idle_ms = parse_timeout(optarg, "idle-timeout");
+            break;
+        case 'R': /* maximale Zeit pro Runde */
+            options->limits.round_ms = parse_timeout(optarg, "round-timeout");
+            break;
+        case 'G': /* maximale Zeit pro Spiel */
+            options->limits.game_ms = parse_timeout(optarg, "game-timeout");
+            break;
+        case 'M': /* Datei fuer die laufenden Zaehler */
+            options->metrics_file = optarg;
+            options->multi = true;
+            break;
+        case 'C': /* Datei fuer die Aufzeichnung der Runden */
+            options->capture_file = optarg;
+            options->multi = true;
+            break;
+        default:  /* ungueltiges Argument */
+            bail_out(EXIT_FAILURE, USAGE, progname);
+        }
+    }
+    if (argc - optind != 1 && argc - optind != 2) {
+        bail_out(EXIT_FAILURE, USAGE, progname);
+    }
+    if (options->udp && options->uring) {
+        bail_out(EXIT_FAILURE, "--udp and --io-uring exclude each other");
+    }
+    if (options->secret_file != NULL && options->seeded) {
+        bail_out(EXIT_FAILURE, "--secrets and --seed exclude each other");
+    }
+    port_arg = argv[optind];
+    secret_arg = (argc - optind == 2) ? argv[optind + 1] : NULL;
+    if (secret_arg != NULL && (options->secret_file != NULL || options->seeded)) {
+        bail_out(EXIT_FAILURE, "<secret-sequence> excludes --secrets and --seed");
     }
-    port_arg = argv[1];
-    secret_arg = argv[2];
 	
-    errno = 0;
-    options->portno = strtol(port_arg, &endptr, 10);
+    options->unix_path = NULL;
+    if (strncmp(port_arg, UNIX_PREFIX, strlen(UNIX_PREFIX)) == 0) {
+        if (options->udp) {
+            bail_out(EXIT_FAILURE, "--udp needs a <server-port>");
+        }
+        options->unix_path = port_arg + strlen(UNIX_PREFIX);
+        options->portno = 0;
+        if (*options->unix_path == '\0' ||
+            strlen(options->unix_path) >= sizeof ((struct sockaddr_un *)NULL)->sun_path) {
+            bail_out(EXIT_FAILURE, "Invalid unix domain socket path: %s", options->unix_path);
+        }
+    } else {
+        errno = 0;
+        options->portno = strtol(port_arg, &endptr, 10);
 
-    if ((errno == ERANGE &&
-          (options->portno == LONG_MAX || options->portno == LONG_MIN))
-        || (errno != 0 && options->portno == 0)) {
-        bail_out(EXIT_FAILURE, "strtol");
-    }
+        if ((errno == ERANGE &&
+              (options->portno == LONG_MAX || options->portno == LONG_MIN))
+            || (errno != 0 && options->portno == 0)) {
+            bail_out(EXIT_FAILURE, "strtol");
+        }
 
-    if (endptr == port_arg) {
-        bail_out(EXIT_FAILURE, "No digits were found");
-    }
+        if (endptr == port_arg) {
+            bail_out(EXIT_FAILURE, "No digits were found");
+        }
 
-    /* If we got here, strtol() successfully parsed a number */
+        /* If we got here, strtol() successfully parsed a number */
 
-    if (*endptr != '\0') { /* In principle not necessarily an error... */
-        bail_out(EXIT_FAILURE,
-            "Further characters after <server-port>: %s", endptr);
-    }
+        if (*endptr != '\0') { /* In principle not necessarily an error... */
+            bail_out(EXIT_FAILURE,
+                "Further characters after <server-port>: %s", endptr);
+        }
 
-    /* check for valid port range */
-    if (options->portno < 1 || options->portno > 65535)
-    {
-        bail_out(EXIT_FAILURE, "Use a valid TCP/IP port range (1-65535)");
+        /* check for valid port range */
+        if (options->portno < 1 || options->portno > 65535)
+        {
+            bail_out(EXIT_FAILURE, "Use a valid TCP/IP port range (1-65535)");
+        }
     }
 
+    if (secret_arg == NULL) {
+        return;
+    }
     if (strlen(secret_arg) != SLOTS) {
         bail_out(EXIT_FAILURE,
             "<secret-sequence> has to be %d chars long", SLOTS);
     }
 
     /* read secret */
-    for (i = 0; i < SLOTS; ++i) {
-        uint8_t color = '\0';
-        switch (secret_arg[i]) {
-        case 'b':
-            color = beige;
-            break;
-        case 'd':
-            color = darkblue;
-            break;
-        case 'g':
-            color = green;
-            break;
-        case 'o':
-            color = orange;
-            break;
-        case 'r':
-            color = red;
-            break;
-        case 's':
-            color = black;
-            break;
-        case 'v':
-            color = violet;
-            break;
-        case 'w':
-            color = white;
-            break;
-        default:
-            bail_out(EXIT_FAILURE,
-                "Bad Color '%c' in <secret-sequence>", secret_arg[i]);
-        }
-        options->secret[i] = color;
+    if ( (i = parse_secret(secret_arg, options->secret)) >= 0) {
+        bail_out(EXIT_FAILURE,
+            "Bad Color '%c' in <secret-sequence>", secret_arg[i]);
     }
+    options->has_secret = true;
 }
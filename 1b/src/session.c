@@ -0,0 +1,268 @@
+/**
+ * @file session.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the session module
+ */
+
+#include "session.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/* === Macros === */
+
+/** @brief Milliseconds to ticks, rounded up */
+#define TICKS(ms) (((ms) + SESSION_TICK_MS - 1) / SESSION_TICK_MS)
+
+#ifdef _ENDEBUG
+#define DEBUG(...) do { fprintf(stderr, __VA_ARGS__); } while(0)
+#else
+#define DEBUG(...)
+#endif
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Plays the complete requests at the beginning of the input whose responses fit into the output
+ * @param session The session
+ * @param ctx The context of the loop
+ * @param in The input
+ * @param len Its length
+ * @return The number of bytes played, -1 if the connection has to be closed
+ */
+static long play_requests(struct session *session, struct session_context *ctx, const uint8_t *in, size_t len);
+
+/**
+ * @brief Gives the block of pending input of a session back to the context
+ */
+static void release_pending(struct session *session, struct session_context *ctx);
+
+
+/* === Implementations === */
+
+void init_session_context(struct session_context *ctx, struct capture_writer *capture, uint64_t now)
+{
+    ctx->capture = capture;
+    ctx->base = TICKS(now);
+    ctx->free_blocks = NULL;
+}
+
+void destroy_session_context(struct session_context *ctx)
+{
+    while (ctx->free_blocks != NULL) {
+        void *block = ctx->free_blocks;
+
+        (void) memcpy(&ctx->free_blocks, block, sizeof ctx->free_blocks);
+        free(block);
+    }
+}
+
+void start_session(struct session *session, struct session_context *ctx, int fd, const uint8_t *secret,
+    uint64_t now)
+{
+    (void) memset(session, 0, sizeof *session);
+    session->fd = fd;
+    start_game(&session->game, secret);
+    init_timer(&session->timer);
+    session->started = session->round_started = (uint32_t)(TICKS(now) - ctx->base);
+    session->timed_round = 0;
+    session->greeted = (WIRE_HELLO_BYTES == 0);
+    if (ctx->capture != NULL) {
+        session->capture_game = capture_game(ctx->capture);
+    }
+}
+
+static long play_requests(struct session *session, struct session_context *ctx, const uint8_t *in, size_t len)
+{
+    uint64_t captured = (ctx->capture != NULL) ? capture_clock(ctx->capture) : 0;
+    size_t pos = 0, room;
+
+    while (!SESSION_OVER(session)) {
+        const uint8_t *msg = &in[pos];
+        size_t available = len - pos;
+
+        room = SESSION_OUT_BYTES - session->out_len;
+        if (!session->greeted) {
+            if (available < WIRE_HELLO_BYTES) {
+                /* an old client sends a request instead, which mostly does not start like a greeting */
+                if (available > 0 && msg[0] != WIRE_MAGIC) {
+                    return -1;
+                }
+                break;
+            }
+            if (!wire_hello_ok(msg)) {
+                DEBUG("Client %d: greeting of another variant\n", session->fd);
+                return -1;
+            }
+            if (room < WIRE_HELLO_BYTES) {
+                break;
+            }
+            pos += WIRE_HELLO_BYTES;
+            put_wire_hello(&session->out[session->out_len]);
+            session->out_len += WIRE_HELLO_BYTES;
+            session->greeted = true;
+        } else if (!session->batched) {
+            mm_response_t response;
+
+            if (available < REQUEST_BYTES || room < RESPONSE_BYTES) {
+                break;
+            }
+            mm_request_t request = get_request(msg);
+            pos += REQUEST_BYTES;
+            if (request == BATCH_HELLO && session->game.round == 0) {
+                DEBUG("Client %d: batch protocol\n", session->fd);
+                session->batched = true;
+                put_response(&session->out[session->out_len], BATCH_ACK);
+                session->out_len += RESPONSE_BYTES;
+                continue;
+            }
+            (void) play_round(&session->game, request, &response);
+            DEBUG("Client %d, round %d: Received 0x%llx, sending 0x%x\n", session->fd, session->game.round,
+                (unsigned long long)request, (unsigned int)response);
+            if (ctx->capture != NULL) {
+                capture_round(ctx->capture, captured, session->capture_game, request, response,
+                    session->game.round);
+            }
+            put_response(&session->out[session->out_len], response);
+            session->out_len += RESPONSE_BYTES;
+        } else {
+            size_t count, answered;
+
+            if (available < 1) {
+                break;
+            }
+            count = msg[0];
+            if (count == 0 || count > MAX_BATCH) {
+                return -1;
+            }
+            if (available < 1 + REQUEST_BYTES * count || room < 1 + RESPONSE_BYTES * count) {
+                break;
+            }
+            pos += 1 + REQUEST_BYTES * count;
+            (void) play_batch(&session->game, &msg[1], count, &session->out[session->out_len + 1], &answered);
+            DEBUG("Client %d, round %d: Received a batch of %zu, answered %zu\n", session->fd,
+                session->game.round, count, answered);
+            for (size_t i = 0; ctx->capture != NULL && i < answered; i++) {
+                capture_round(ctx->capture, captured, session->capture_game,
+                    get_request(&msg[1 + REQUEST_BYTES * i]),
+                    get_response(&session->out[session->out_len + 1 + RESPONSE_BYTES * i]),
+                    session->game.round - (int)(answered - 1 - i));
+            }
+            session->out[session->out_len] = (uint8_t)answered;
+            session->out_len += 1 + RESPONSE_BYTES * answered;
+        }
+    }
+    return (long)pos;
+}
+
+static void release_pending(struct session *session, struct session_context *ctx)
+{
+    if (session->pending != NULL) {
+        (void) memcpy(session->pending, &ctx->free_blocks, sizeof ctx->free_blocks);
+        ctx->free_blocks = session->pending;
+        session->pending = NULL;
+    }
+    session->in_len = 0;
+}
+
+int feed_session(struct session *session, struct session_context *ctx, const uint8_t *data, size_t len)
+{
+    long played;
+
+    if (session->pending != NULL) {
+        /* the new bytes go behind the pending ones, those which do not fit come after the end of the game */
+        size_t n = SESSION_PENDING_BYTES - session->in_len;
+
+        if (n > len) {
+            n = len;
+        }
+        if (n > 0) {
+            (void) memcpy(&session->pending[session->in_len], data, n);
+            session->in_len += n;
+        }
+        data = session->pending;
+        len = session->in_len;
+    }
+    if (SESSION_OVER(session)) {
+        release_pending(session, ctx);  /* anything after the end of the game is ignored */
+        return 0;
+    }
+    if ( (played = play_requests(session, ctx, data, len)) < 0) {
+        return -1;
+    }
+    len -= (size_t)played;
+    if (len == 0 || SESSION_OVER(session)) {
+        release_pending(session, ctx);
+        return 0;
+    }
+    if (session->pending == NULL) {
+        if (ctx->free_blocks != NULL) {
+            session->pending = ctx->free_blocks;
+            (void) memcpy(&ctx->free_blocks, session->pending, sizeof ctx->free_blocks);
+        } else if ( (session->pending = malloc(SESSION_PENDING_BYTES)) == NULL) {
+            return -1;
+        }
+        if (len > SESSION_PENDING_BYTES) {
+            len = SESSION_PENDING_BYTES;
+        }
+    }
+    (void) memmove(session->pending, &data[played], len);
+    session->in_len = (uint16_t)len;
+    return 0;
+}
+
+int responses_sent(struct session *session, struct session_context *ctx, size_t n)
+{
+    session->out_sent += n;
+    if (session->out_sent == session->out_len && !SESSION_OVER(session)) {
+        session->out_len = session->out_sent = 0;
+        if (session->pending != NULL) {
+            return feed_session(session, ctx, NULL, 0);     /* requests waiting for the buffer */
+        }
+    }
+    return 0;
+}
+
+void end_session(struct session *session, struct session_context *ctx)
+{
+    release_pending(session, ctx);
+}
+
+uint64_t session_clock(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+void update_session_timer(struct timer_wheel *wheel, struct session *session, const struct session_context *ctx,
+    const struct session_limits *limits, uint64_t now)
+{
+    uint64_t deadline = UINT64_MAX;
+
+    if (session->game.round != session->timed_round) {
+        /* the responses of the last round are out; rounding the start up never lets a timer expire early */
+        session->round_started = (uint32_t)(TICKS(now) - ctx->base);
+        session->timed_round = (uint16_t)session->game.round;
+    }
+    if (limits->idle_ms > 0) {
+        deadline = TICKS(now + limits->idle_ms);
+    }
+    if (limits->round_ms > 0 && ctx->base + session->round_started + TICKS(limits->round_ms) < deadline) {
+        deadline = ctx->base + session->round_started + TICKS(limits->round_ms);
+    }
+    if (limits->game_ms > 0 && ctx->base + session->started + TICKS(limits->game_ms) < deadline) {
+        deadline = ctx->base + session->started + TICKS(limits->game_ms);
+    }
+    if (deadline == UINT64_MAX) {
+        cancel_timer(wheel, &session->timer);
+        return;
+    }
+    schedule_timer(wheel, &session->timer, deadline);
+}
@@ -0,0 +1,166 @@
+/**
+ * @file session.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief The protocol side of a connection of the multi-client server.
+ * @details A session plays every complete request of the bytes received on a connection, guesses as well as
+ * batches (see game.h), and collects the responses until they are sent. With WIRE_VERSION 2 the connection
+ * starts with the greeting of the variant (see mastermind.h), which is answered the same. It does no I/O
+ * itself, so the epoll and the io_uring backend share it.
+ *
+ * A session is kept small, so that many thousands of them fit into a few MB: the requests are played right
+ * from the received bytes, and the output buffer holds one reply to a full batch plus the greeting and the
+ * acknowledgement of the batch protocol. A request whose response does not fit any more waits until the
+ * responses before it are sent. Only bytes which cannot be played yet, the rest of a request split across
+ * two receives or requests waiting for the output, are copied, into a block of the session context.
+ *
+ * A session may have time limits: for the time without any input (idle), for the time between two
+ * responses and the next complete request (round) and for the whole game. The loops keep the sessions in a
+ * timer wheel (see timerwheel.h) at the earliest of their deadlines; a game running out of time is lost.
+ *
+ * The sessions of a loop share a context: the capture writer (see capture.h) recording every round they
+ * play, the tick their times count from and the blocks for pending input.
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+#include "timerwheel.h"
+#include "capture.h"
+
+/* === Constants === */
+
+/**
+ * @brief Size of a block of pending input, the most input a game takes: the greeting, the batch hello, a
+ * batch of one guess per round and a full batch in the last one. Any bytes after that come after the end of
+ * the game and are ignored anyway.
+ */
+#define SESSION_PENDING_BYTES (WIRE_HELLO_BYTES + REQUEST_BYTES + (MAX_TRIES - 1) * (1 + REQUEST_BYTES) + \
+    1 + REQUEST_BYTES * MAX_BATCH)
+
+/** @brief Size of the output buffer: the reply to a full batch, and the greeting and the acknowledgement */
+#define SESSION_OUT_BYTES (WIRE_HELLO_BYTES + RESPONSE_BYTES + 1 + RESPONSE_BYTES * MAX_BATCH)
+
+/** @brief Milliseconds per tick of the timer wheel, the resolution of the time limits */
+#define SESSION_TICK_MS (10)
+
+
+/* === Macros === */
+
+/** @brief The game is over, the connection is closed after the last response */
+#define SESSION_OVER(session) ((session)->game.result != GAME_RUNNING)
+
+/** @brief The session a timer of the timer wheel belongs to */
+#define SESSION_OF_TIMER(t) ((struct session *)((char *)(t) - offsetof(struct session, timer)))
+
+
+/* === Type Definitions === */
+
+/** @brief Time limits of the sessions in milliseconds, 0 for none */
+struct session_limits {
+    unsigned int idle_ms;           /**< time without any input */
+    unsigned int round_ms;          /**< time from a response to the next complete request */
+    unsigned int game_ms;           /**< time of the whole game */
+};
+
+/** @brief What the sessions of one loop share */
+struct session_context {
+    struct capture_writer *capture; /**< records the rounds of the sessions, NULL for none */
+    uint64_t base;                  /**< the tick the times of the sessions count from */
+    void *free_blocks;              /**< blocks for pending input not in use, chained through their first bytes */
+};
+
+/**
+ * @brief The state of one connection, ordered without padding: 120 bytes in the default variant, so that a
+ * connection record of either loop is two cache lines
+ */
+struct session {
+    struct game game;               /**< the game played on this connection */
+    uint8_t *pending;               /**< received bytes not played yet, a block of SESSION_PENDING_BYTES or NULL */
+    struct timer timer;             /**< expires at the earliest deadline */
+    int fd;                         /**< the connection */
+    uint16_t in_len;                /**< number of bytes in pending */
+    uint16_t out_len;               /**< number of bytes in out */
+    uint16_t out_sent;              /**< number of bytes of out already sent */
+    uint16_t timed_round;           /**< the round round_started belongs to */
+    uint32_t started;               /**< start of the game, in ticks after the base of the context */
+    uint32_t round_started;         /**< start of the current round */
+    uint32_t capture_game;          /**< number of the game in the capture */
+    bool greeted;                   /**< the greeting was received, or there is none */
+    bool batched;                   /**< the client opened the batch protocol */
+    uint8_t out[SESSION_OUT_BYTES]; /**< responses not sent yet */
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Initializes the context of the sessions of a loop
+ * @param ctx The context
+ * @param capture Records the rounds of the sessions, NULL for none
+ * @param now The current time, see session_clock
+ */
+void init_session_context(struct session_context *ctx, struct capture_writer *capture, uint64_t now);
+
+/**
+ * @brief Frees the blocks of a context, its sessions must be ended
+ */
+void destroy_session_context(struct session_context *ctx);
+
+/**
+ * @brief Starts the session of a new connection
+ * @param session The session to initialize
+ * @param ctx The context of the loop
+ * @param fd The connection
+ * @param secret The secret of its game
+ * @param now The current time, see session_clock
+ */
+void start_session(struct session *session, struct session_context *ctx, int fd, const uint8_t *secret,
+    uint64_t now);
+
+/**
+ * @brief Plays every complete request of the received bytes whose response fits, and keeps the rest as
+ * pending input; bytes after the end of the game are ignored
+ * @param session The session
+ * @param ctx The context of the loop
+ * @param data The received bytes
+ * @param len Their number
+ * @return 0 if the connection is fine, -1 if it has to be closed because of a malformed batch or greeting, or
+ * because there is no memory for the pending input
+ */
+int feed_session(struct session *session, struct session_context *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Marks the first n pending responses as sent, once all are sent the buffer is reused and the pending
+ * input is played
+ * @return 0 if the connection is fine, -1 if it has to be closed, see feed_session
+ */
+int responses_sent(struct session *session, struct session_context *ctx, size_t n);
+
+/**
+ * @brief Ends a session, giving its block of pending input back to the context
+ */
+void end_session(struct session *session, struct session_context *ctx);
+
+/**
+ * @brief Returns the monotonic time in milliseconds
+ */
+uint64_t session_clock(void);
+
+/**
+ * @brief Notes that input arrived at now and moves the timer of the session to its earliest deadline
+ * @param wheel The timer wheel of the loop, in ticks of SESSION_TICK_MS
+ * @param session The session
+ * @param ctx The context of the loop
+ * @param limits The time limits, the timer is cancelled if there are none
+ * @param now The current time, see session_clock
+ */
+void update_session_timer(struct timer_wheel *wheel, struct session *session, const struct session_context *ctx,
+    const struct session_limits *limits, uint64_t now);
+
+#endif /* SESSION_H */
@@ -0,0 +1,92 @@
+/**
+ * @file slab.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the slab module
+ */
+
+#define _GNU_SOURCE	/* MAP_NORESERVE */
+#include "slab.h"
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+
+/* === Implementations === */
+
+int create_slab(struct slab *slab, size_t size)
+{
+    struct rlimit limit;
+    size_t capacity = SLAB_MAX_RECORDS;
+    size_t records_size, index_size;
+
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY &&
+        limit.rlim_cur < capacity) {
+        capacity = (size_t)limit.rlim_cur;
+    }
+    (void) memset(slab, 0, sizeof *slab);
+    slab->record_size = (size + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN;
+    slab->capacity = (uint32_t)capacity;
+    slab->free_head = SLAB_NONE;
+
+    /* the records, the freelist and the descriptor map, every part starting on a cache line;
+       only the pages touched are ever backed */
+    records_size = capacity * slab->record_size;
+    index_size = (capacity * sizeof (uint32_t) + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN;
+    slab->map_size = records_size + 2 * index_size;
+    slab->map = mmap(NULL, slab->map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+        -1, 0);
+    if (slab->map == MAP_FAILED) {
+        slab->map = NULL;
+        return -1;
+    }
+    slab->records = slab->map;
+    slab->next_free = (uint32_t *)(slab->records + records_size);
+    slab->slot_of_fd = (uint32_t *)(slab->records + records_size + index_size);
+    return 0;
+}
+
+void destroy_slab(struct slab *slab)
+{
+    if (slab->map != NULL) {
+        (void) munmap(slab->map, slab->map_size);
+        slab->map = NULL;
+    }
+}
+
+void *slab_alloc(struct slab *slab, int fd)
+{
+    uint32_t slot;
+
+    if (fd < 0 || (size_t)fd >= slab->capacity) {
+        errno = EMFILE;
+        return NULL;
+    }
+    if (slab->free_head != SLAB_NONE) {
+        slot = slab->free_head;
+        slab->free_head = slab->next_free[slot];
+    } else if (slab->fresh < slab->capacity) {
+        slot = slab->fresh++;
+    } else {
+        errno = EMFILE;
+        return NULL;
+    }
+    slab->used++;
+    slab->slot_of_fd[fd] = slot + 1;
+    if ((size_t)fd >= slab->fd_high) {
+        slab->fd_high = (size_t)fd + 1;
+    }
+    return slab->records + (size_t)slot * slab->record_size;
+}
+
+void slab_free(struct slab *slab, int fd)
+{
+    uint32_t slot = slab->slot_of_fd[fd] - 1;
+
+    slab->slot_of_fd[fd] = 0;
+    slab->next_free[slot] = slab->free_head;
+    slab->free_head = slot;
+    slab->used--;
+}
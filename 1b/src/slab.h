@@ -0,0 +1,94 @@
+/**
+ * @file slab.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Preallocated storage for the connections of a loop.
+ * @details A slab holds one record per connection, all records of the same size in a single mapping made
+ * when the loop starts. Every record is rounded up to whole cache lines (SLAB_ALIGN), so two connections
+ * served one after the other never share a line. A record is found by the file descriptor of its
+ * connection through a map of record indices, and free records are chained by their indices: allocating,
+ * finding and freeing a record take constant time and never call malloc.
+ *
+ * There is a record for every descriptor the process may open, up to SLAB_MAX_RECORDS. The mapping is only
+ * reserved at the start; a page is backed once a record on it is first used. The most recently freed record
+ * is handed out next, so the memory in use follows the largest number of connections at once and stays
+ * flat however many connections come and go.
+ */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* === Constants === */
+
+/** @brief Size of a cache line, the records are multiples of it */
+#define SLAB_ALIGN (64)
+
+/** @brief Most records of a slab, and most descriptors it maps */
+#define SLAB_MAX_RECORDS (1 << 20)
+
+/** @brief End of the list of free records */
+#define SLAB_NONE (UINT32_MAX)
+
+
+/* === Type Definitions === */
+
+/** @brief The records of one loop */
+struct slab {
+    uint8_t *records;       /**< the records, capacity of them */
+    size_t record_size;     /**< size of a record, a multiple of SLAB_ALIGN */
+    uint32_t capacity;      /**< number of records */
+    uint32_t used;          /**< records allocated */
+    uint32_t fresh;         /**< records below this index have been used before */
+    uint32_t free_head;     /**< first record freed and not used again, SLAB_NONE for none */
+    uint32_t *next_free;    /**< the next free record after each free one */
+    uint32_t *slot_of_fd;   /**< index of the record of each descriptor plus one, 0 for none */
+    size_t fd_high;         /**< one more than the highest descriptor ever mapped */
+    void *map;              /**< the mapping holding all of the above */
+    size_t map_size;
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Reserves a slab with a record for every descriptor the process may open
+ * @param slab The slab to initialize
+ * @param size Size of a record, rounded up to whole cache lines
+ * @return 0 on success, -1 otherwise (errno is set)
+ */
+int create_slab(struct slab *slab, size_t size);
+
+/**
+ * @brief Releases the memory of a slab, the records must not be used any more
+ */
+void destroy_slab(struct slab *slab);
+
+/**
+ * @brief Allocates the record of a descriptor, its contents are undefined
+ * @return The record, NULL if the slab is full or the descriptor beyond its capacity (errno is EMFILE)
+ */
+void *slab_alloc(struct slab *slab, int fd);
+
+/**
+ * @brief Frees the record of a descriptor
+ */
+void slab_free(struct slab *slab, int fd);
+
+/**
+ * @brief Returns the record of a descriptor, NULL if it has none
+ */
+static inline void *slab_find(const struct slab *slab, int fd)
+{
+    uint32_t slot;
+
+    if (fd < 0 || (size_t)fd >= slab->fd_high || (slot = slab->slot_of_fd[fd]) == 0) {
+        return NULL;
+    }
+    return slab->records + (size_t)(slot - 1) * slab->record_size;
+}
+
+#endif /* SLAB_H */
@@ -0,0 +1,84 @@
+/**
+ * @file solver.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the solver module
+ */
+
+#include "solver.h"
+#include <stdlib.h>
+#include <errno.h>
+
+
+/* === Implementations === */
+
+int create_solver(struct solver *solver)
+{
+    size_t size = 1;
+
+    for (int slot = 0; slot < SLOTS; slot++) {
+        size *= COLORS;
+        if (size > SOLVER_MAX_CODES) {
+            errno = E2BIG;
+            return -1;
+        }
+    }
+    solver->stride = marks_stride(size);
+    /* the padding of the lanes is read by the kernels */
+    if ( (solver->codes = calloc(SLOTS * solver->stride, 1)) == NULL) {
+        return -1;
+    }
+    if ( (solver->candidates = calloc(SLOTS * solver->stride, 1)) == NULL) {
+        free(solver->codes);
+        return -1;
+    }
+    /* counting in base COLORS with the first slot changing fastest */
+    for (size_t i = 0; i < size; i++) {
+        size_t rest = i;
+
+        for (int slot = 0; slot < SLOTS; slot++) {
+            solver->codes[slot * solver->stride + i] = (uint8_t)(rest % COLORS);
+            rest /= COLORS;
+        }
+    }
+    solver->size = size;
+    start_solving(solver);
+    return 0;
+}
+
+void destroy_solver(struct solver *solver)
+{
+    free(solver->codes);
+    free(solver->candidates);
+    solver->codes = solver->candidates = NULL;
+}
+
+void start_solving(struct solver *solver)
+{
+    solver->possible = solver->codes;
+    solver->remaining = solver->size;
+}
+
+const uint8_t *next_guess(struct solver *solver)
+{
+    uint8_t colors[SLOTS];
+
+    if (solver->remaining == 0) {
+        return NULL;
+    }
+    /* the first possible code */
+    for (int slot = 0; slot < SLOTS; slot++) {
+        colors[slot] = solver->possible[slot * solver->stride];
+    }
+    prepare_guess(&solver->guess, colors);
+    return solver->guess.colors;
+}
+
+void add_response(struct solver *solver, unsigned int red, unsigned int white)
+{
+    /* keep the codes which would have answered the guess alike, in place after the first response */
+    solver->remaining = filter_codes(&solver->guess, solver->possible, solver->candidates, solver->stride,
+        solver->remaining, red, white);
+    solver->possible = solver->candidates;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file solver.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief The codebreaker of the client.
+ * @details A code is still possible if it would have given all responses of the game so far had it been the
+ * secret. The solver keeps the possible codes densely in ascending order, which each response filters in
+ * place, so a round only looks at the codes left: after two guesses usually a few hundred of the 32768
+ * codes of the classic variant. The first response is filtered from the table of every code straight into
+ * the candidates, so a new game copies nothing. Both are kept as lanes of the marks module (see marks.h),
+ * whose vector kernels compare a guess with 16 or 32 codes at once. The guess is always the first possible code, so the guesses
+ * of a game only depend on the responses. Variants with more than SOLVER_MAX_CODES codes are not solved.
+ *
+ * The solver does no I/O itself: the client plays it against a server over a socket, selfplay against a
+ * server thread of the same process (see transport.h).
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mastermind.h"
+#include "marks.h"
+
+/* === Constants === */
+
+/** @brief Most codes the solver keeps */
+#define SOLVER_MAX_CODES (1 << 24)
+
+
+/* === Type Definitions === */
+
+/** @brief The state of the solver */
+struct solver {
+    uint8_t *codes;             /**< lanes of every code of the variant, in ascending order */
+    size_t size;                /**< number of codes */
+    size_t stride;              /**< distance of the lanes */
+    uint8_t *candidates;        /**< lanes of the codes still possible after the first response */
+    const uint8_t *possible;    /**< lanes of the codes still possible: codes before the first response */
+    size_t remaining;           /**< number of codes still possible */
+    struct marks_guess guess;   /**< the last guess of the game */
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Creates a solver for the variant
+ * @return 0 on success, -1 otherwise (errno is set, E2BIG if the variant has too many codes)
+ */
+int create_solver(struct solver *solver);
+
+/**
+ * @brief Releases the memory of a solver
+ */
+void destroy_solver(struct solver *solver);
+
+/**
+ * @brief Starts a new game, every code is possible again
+ */
+void start_solving(struct solver *solver);
+
+/**
+ * @brief Returns the next guess, the first code still possible
+ * @return The colors of the guess, valid until the next call, NULL if no code fits the responses
+ */
+const uint8_t *next_guess(struct solver *solver);
+
+/**
+ * @brief Takes the response to the last guess and rules out the codes which would have answered otherwise
+ * @param solver The solver
+ * @param red The red marks of the response
+ * @param white The white marks of the response
+ */
+void add_response(struct solver *solver, unsigned int red, unsigned int white);
+
+#endif /* SOLVER_H */
@@ -0,0 +1,144 @@
+/**
+ * @file timerwheel.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the timerwheel module
+ */
+
+#include "timerwheel.h"
+
+
+/* === Macros === */
+
+/* Slot of a tick on a level */
+#define SLOT_OF(tick, level) (((tick) >> (TIMER_LEVEL_BITS * (level))) & (TIMER_SLOTS - 1))
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Puts a timer into the slot of its tick, the timer must not be scheduled
+ */
+static void insert_timer(struct timer_wheel *wheel, struct timer *timer);
+
+/**
+ * @brief Moves the timers of a slot of a higher level down to where they belong now
+ * @return The slot
+ */
+static unsigned int cascade(struct timer_wheel *wheel, unsigned int level, unsigned int slot);
+
+
+/* === Implementations === */
+
+void init_timer_wheel(struct timer_wheel *wheel, uint64_t now)
+{
+    for (unsigned int level = 0; level < TIMER_LEVELS; level++) {
+        for (unsigned int slot = 0; slot < TIMER_SLOTS; slot++) {
+            wheel->slots[level][slot].next = &wheel->slots[level][slot];
+            wheel->slots[level][slot].prev = &wheel->slots[level][slot];
+        }
+    }
+    wheel->next_tick = now;
+    wheel->count = 0;
+}
+
+void init_timer(struct timer *timer)
+{
+    timer->next = timer->prev = NULL;
+    timer->expires = 0;
+}
+
+bool timer_pending(const struct timer *timer)
+{
+    return timer->next != NULL;
+}
+
+static void insert_timer(struct timer_wheel *wheel, struct timer *timer)
+{
+    uint64_t expires = timer->expires;
+    struct timer *head;
+    unsigned int level;
+
+    if (expires < wheel->next_tick) {
+        expires = wheel->next_tick;
+    } else if (expires - wheel->next_tick > TIMER_MAX_DELAY) {
+        expires = wheel->next_tick + TIMER_MAX_DELAY;
+    }
+    /* the lowest level whose range covers the delay, the slot is taken from the absolute tick so the timer
+       reaches the lowest level exactly when the levels below have gone round */
+    for (level = 0; level + 1 < TIMER_LEVELS; level++) {
+        if (expires - wheel->next_tick < ((uint64_t)1 << (TIMER_LEVEL_BITS * (level + 1)))) {
+            break;
+        }
+    }
+    head = &wheel->slots[level][SLOT_OF(expires, level)];
+    timer->next = head;
+    timer->prev = head->prev;
+    head->prev->next = timer;
+    head->prev = timer;
+}
+
+void schedule_timer(struct timer_wheel *wheel, struct timer *timer, uint64_t expires)
+{
+    cancel_timer(wheel, timer);
+    timer->expires = expires;
+    insert_timer(wheel, timer);
+    wheel->count++;
+}
+
+void cancel_timer(struct timer_wheel *wheel, struct timer *timer)
+{
+    if (!timer_pending(timer)) {
+        return;
+    }
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next = timer->prev = NULL;
+    wheel->count--;
+}
+
+static unsigned int cascade(struct timer_wheel *wheel, unsigned int level, unsigned int slot)
+{
+    struct timer *head = &wheel->slots[level][slot];
+    struct timer *timer = head->next;
+
+    head->next = head->prev = head;
+    while (timer != head) {
+        struct timer *next = timer->next;
+
+        insert_timer(wheel, timer);
+        timer = next;
+    }
+    return slot;
+}
+
+size_t advance_timer_wheel(struct timer_wheel *wheel, uint64_t now, timer_handler handler, void *arg)
+{
+    size_t expired = 0;
+
+    while (wheel->next_tick <= now) {
+        unsigned int slot = SLOT_OF(wheel->next_tick, 0);
+        struct timer *head = &wheel->slots[0][slot];
+
+        if (wheel->count == 0) {
+            wheel->next_tick = now + 1;     /* nothing to cascade or expire on the way */
+            break;
+        }
+        /* the lowest level went round: the next slot of each higher level moves down */
+        for (unsigned int level = 1; level < TIMER_LEVELS && slot == 0; level++) {
+            slot = cascade(wheel, level, SLOT_OF(wheel->next_tick, level));
+        }
+        wheel->next_tick++;
+
+        /* the handler may schedule and cancel timers, so take them one by one */
+        while (head->next != head) {
+            struct timer *timer = head->next;
+
+            cancel_timer(wheel, timer);
+            handler(timer, arg);
+            expired++;
+        }
+    }
+    return expired;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file timerwheel.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Hierarchical timer wheel for the deadlines of many connections.
+ * @details Time is counted in ticks. The wheel has TIMER_LEVELS levels of TIMER_SLOTS slots each: a timer due
+ * within TIMER_SLOTS ticks sits in the slot of its tick on the lowest level, later timers sit in coarser
+ * slots of the higher levels and move down a level whenever the lowest level has gone round once. Scheduling
+ * and cancelling a timer are O(1), and every tick touches only the timers of one slot, no matter how many
+ * timers there are. Timers further away than the wheel reaches expire at its end instead.
+ *
+ * The timers are embedded in the structures they belong to, the wheel allocates nothing.
+ */
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* === Constants === */
+
+#define TIMER_LEVEL_BITS (6)
+#define TIMER_SLOTS (1 << TIMER_LEVEL_BITS)
+#define TIMER_LEVELS (4)
+
+/** @brief The furthest a timer can be scheduled ahead, in ticks */
+#define TIMER_MAX_DELAY (((uint64_t)1 << (TIMER_LEVEL_BITS * TIMER_LEVELS)) - 1)
+
+
+/* === Type Definitions === */
+
+/** @brief A timer, embedded in the structure it belongs to */
+struct timer {
+    struct timer *next;     /**< next timer of the slot, NULL if the timer is not scheduled */
+    struct timer *prev;     /**< previous timer of the slot */
+    uint64_t expires;       /**< the tick at which the timer expires */
+};
+
+/** @brief The wheel, every slot is the head of a circular list */
+struct timer_wheel {
+    struct timer slots[TIMER_LEVELS][TIMER_SLOTS];
+    uint64_t next_tick;     /**< the next tick to be processed */
+    size_t count;           /**< number of scheduled timers */
+};
+
+/** @brief Called for every expired timer, which is not scheduled any more and may be scheduled again */
+typedef void (*timer_handler)(struct timer *timer, void *arg);
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Initializes an empty wheel
+ * @param wheel The wheel
+ * @param now The current tick
+ */
+void init_timer_wheel(struct timer_wheel *wheel, uint64_t now);
+
+/**
+ * @brief Initializes a timer which is not scheduled
+ */
+void init_timer(struct timer *timer);
+
+/**
+ * @brief Schedules a timer, or moves it if it is scheduled already
+ * @param wheel The wheel
+ * @param timer The timer
+ * @param expires The tick at which it expires, a tick already processed expires with the next one
+ */
+void schedule_timer(struct timer_wheel *wheel, struct timer *timer, uint64_t expires);
+
+/**
+ * @brief Cancels a timer, nothing happens if it is not scheduled
+ */
+void cancel_timer(struct timer_wheel *wheel, struct timer *timer);
+
+/**
+ * @brief Tells whether a timer is scheduled
+ */
+bool timer_pending(const struct timer *timer);
+
+/**
+ * @brief Expires all timers due up to and including tick now
+ * @param wheel The wheel
+ * @param now The current tick
+ * @param handler Called for every expired timer
+ * @param arg Passed to handler
+ * @return Number of expired timers
+ */
+size_t advance_timer_wheel(struct timer_wheel *wheel, uint64_t now, timer_handler handler, void *arg);
+
+#endif /* TIMERWHEEL_H */
@@ -0,0 +1,230 @@
+/**
+ * @file transport.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the transport module
+ */
+
+#define _GNU_SOURCE    /* syscall */
+#include "transport.h"
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+
+/* === Macros === */
+
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define LOAD_SEQ(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define STORE_SEQ(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+
+
+/* === Prototypes === */
+
+/**
+ * @brief The read operation of the socket transport
+ */
+static ssize_t socket_read(struct transport *transport, uint8_t *buf, size_t len);
+
+/**
+ * @brief The write operation of the socket transport
+ */
+static int socket_write(struct transport *transport, const uint8_t *buf, size_t len);
+
+/**
+ * @brief The read operation of the in-process transport
+ */
+static ssize_t inproc_read(struct transport *transport, uint8_t *buf, size_t len);
+
+/**
+ * @brief The write operation of the in-process transport
+ */
+static int inproc_write(struct transport *transport, const uint8_t *buf, size_t len);
+
+/**
+ * @brief Sleeps until the other side of a ring moves its position, unless it already has
+ * @details The sleeper announces itself before it looks at the position a last time, and the other side
+ * looks for a sleeper after it has moved the position, so at least one of them sees the other.
+ * @param sleeps The futex of the sleeping side
+ * @param position The position of the other side
+ * @param seen The position last seen
+ * @param closed The closed flag of the ring if the consumer sleeps, NULL for the producer
+ */
+static void sleep_on(uint32_t *sleeps, const uint64_t *position, uint64_t seen, const bool *closed);
+
+/**
+ * @brief Wakes the other side of a ring if it sleeps, after the position has been moved
+ * @param sleeps The futex of the other side
+ */
+static void wake_up(uint32_t *sleeps);
+
+
+/* === Implementations === */
+
+static ssize_t socket_read(struct transport *transport, uint8_t *buf, size_t len)
+{
+    struct socket_transport *t = (struct socket_transport *)transport;
+    ssize_t r;
+
+    do {
+        r = recv(t->fd, buf, len, 0);
+    } while (r < 0 && errno == EINTR);
+    return r;
+}
+
+static int socket_write(struct transport *transport, const uint8_t *buf, size_t len)
+{
+    struct socket_transport *t = (struct socket_transport *)transport;
+
+    while (len > 0) {
+        ssize_t w = send(t->fd, buf, len, MSG_NOSIGNAL);
+
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+void open_socket_transport(struct socket_transport *transport, int fd)
+{
+    transport->transport.read = socket_read;
+    transport->transport.write = socket_write;
+    transport->fd = fd;
+}
+
+static void sleep_on(uint32_t *sleeps, const uint64_t *position, uint64_t seen, const bool *closed)
+{
+    STORE_SEQ(sleeps, 1);
+    if (LOAD_SEQ(position) == seen && (closed == NULL || !LOAD_SEQ(closed))) {
+        /* returns at once if the other side has cleared the futex in between */
+        (void) syscall(SYS_futex, sleeps, FUTEX_WAIT_PRIVATE, 1, NULL, NULL, 0);
+    }
+    STORE_SEQ(sleeps, 0);
+}
+
+static void wake_up(uint32_t *sleeps)
+{
+    if (LOAD_SEQ(sleeps) && __atomic_exchange_n(sleeps, 0, __ATOMIC_SEQ_CST)) {
+        (void) syscall(SYS_futex, sleeps, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+static ssize_t inproc_read(struct transport *transport, uint8_t *buf, size_t len)
+{
+    struct inproc_ring *ring = ((struct inproc_transport *)transport)->in;
+    uint64_t head = ring->head;
+    unsigned int spins = 0;
+    size_t n, first;
+
+    /* the producer's tail is only read when the bytes seen so far are used up */
+    while (ring->seen_tail == head) {
+        ring->seen_tail = LOAD_ACQUIRE(&ring->tail);
+        if (ring->seen_tail != head) {
+            break;
+        }
+        if (LOAD_ACQUIRE(&ring->closed)) {
+            /* the last bytes may have come in before the close */
+            ring->seen_tail = LOAD_ACQUIRE(&ring->tail);
+            if (ring->seen_tail == head) {
+                return 0;
+            }
+            break;
+        }
+        if (++spins == INPROC_SPINS) {
+            sleep_on(&ring->consumer_sleeps, &ring->tail, head, &ring->closed);
+            spins = 0;
+        }
+    }
+    n = (size_t)(ring->seen_tail - head);
+    if (n > len) {
+        n = len;
+    }
+    first = INPROC_RING_BYTES - (size_t)(head % INPROC_RING_BYTES);
+    if (first > n) {
+        first = n;
+    }
+    (void) memcpy(buf, &ring->data[head % INPROC_RING_BYTES], first);
+    (void) memcpy(buf + first, ring->data, n - first);
+    STORE_SEQ(&ring->head, head + n);
+    wake_up(&ring->producer_sleeps);
+    return (ssize_t)n;
+}
+
+static int inproc_write(struct transport *transport, const uint8_t *buf, size_t len)
+{
+    struct inproc_ring *ring = ((struct inproc_transport *)transport)->out;
+    uint64_t tail = ring->tail;
+
+    while (len > 0) {
+        unsigned int spins = 0;
+        size_t n, first;
+
+        /* the consumer's head is only read when the ring looks full */
+        while (tail - ring->seen_head == INPROC_RING_BYTES) {
+            ring->seen_head = LOAD_ACQUIRE(&ring->head);
+            if (tail - ring->seen_head < INPROC_RING_BYTES) {
+                break;
+            }
+            if (++spins == INPROC_SPINS) {
+                sleep_on(&ring->producer_sleeps, &ring->head, ring->seen_head, NULL);
+                spins = 0;
+            }
+        }
+        n = INPROC_RING_BYTES - (size_t)(tail - ring->seen_head);
+        if (n > len) {
+            n = len;
+        }
+        first = INPROC_RING_BYTES - (size_t)(tail % INPROC_RING_BYTES);
+        if (first > n) {
+            first = n;
+        }
+        (void) memcpy(&ring->data[tail % INPROC_RING_BYTES], buf, first);
+        (void) memcpy(ring->data, buf + first, n - first);
+        tail += n;
+        STORE_SEQ(&ring->tail, tail);
+        wake_up(&ring->consumer_sleeps);
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+void open_inproc_channel(struct inproc_channel *channel, struct inproc_transport *a, struct inproc_transport *b)
+{
+    (void) memset(channel, 0, sizeof *channel);
+    a->transport.read = b->transport.read = inproc_read;
+    a->transport.write = b->transport.write = inproc_write;
+    a->in = b->out = &channel->rings[0];
+    a->out = b->in = &channel->rings[1];
+}
+
+void close_inproc_transport(struct inproc_transport *transport)
+{
+    STORE_SEQ(&transport->out->closed, true);
+    wake_up(&transport->out->consumer_sleeps);
+}
+
+int read_exactly(struct transport *transport, uint8_t *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t r = transport->read(transport, buf, len);
+
+        if (r <= 0) {
+            if (r == 0) {
+                errno = 0;
+            }
+            return -1;
+        }
+        buf += r;
+        len -= (size_t)r;
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file transport.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief The byte streams a game is played over.
+ * @details A transport carries the bytes of one end of a game in both directions, so the players do not
+ * depend on how they are connected. The socket transport wraps a connected stream socket. The in-process
+ * transport connects two threads of the same process: each direction is a lock-free ring with a single
+ * producer and a single consumer, so a client and a server in one process pay neither system calls nor
+ * the network and only the game itself is measured.
+ *
+ * A ring holds INPROC_RING_BYTES. Its producer and its consumer each have a cache line of their own, in which
+ * they also keep the last position of the other side they have seen, so the line of the other side is only
+ * read when the ring looks full or empty. A side waiting for the other spins INPROC_SPINS tries and then sleeps
+ * on a futex until the other side wakes it, so two threads sharing a processor do not take its time from each
+ * other while one of them waits.
+ */
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* === Constants === */
+
+/** @brief Bytes of a ring of the in-process transport, a power of two */
+#define INPROC_RING_BYTES (4096)
+
+/** @brief Tries of a waiting side before it sleeps */
+#define INPROC_SPINS (256)
+
+/** @brief Size of a cache line */
+#define INPROC_LINE (64)
+
+
+/* === Type Definitions === */
+
+/** @brief One end of a byte stream */
+struct transport {
+    /**
+     * @brief Reads at least one byte, waiting until there is one
+     * @return The number of bytes read, 0 if the other end is closed, -1 on error (errno is set)
+     */
+    ssize_t (*read)(struct transport *transport, uint8_t *buf, size_t len);
+    /**
+     * @brief Writes all bytes
+     * @return 0 on success, -1 on error (errno is set)
+     */
+    int (*write)(struct transport *transport, const uint8_t *buf, size_t len);
+};
+
+/** @brief A transport over a connected stream socket */
+struct socket_transport {
+    struct transport transport;     /**< the operations, first member */
+    int fd;                         /**< the socket */
+};
+
+/** @brief One direction of the in-process transport */
+struct inproc_ring {
+    /* the producer's line */
+    uint64_t tail __attribute__((aligned(INPROC_LINE)));   /**< bytes written so far */
+    uint64_t seen_head;             /**< head as last read by the producer */
+    uint32_t producer_sleeps;       /**< futex, 1 while the producer sleeps or is about to */
+    bool closed;                    /**< the producer wrote its last byte */
+    /* the consumer's line */
+    uint64_t head __attribute__((aligned(INPROC_LINE)));   /**< bytes read so far */
+    uint64_t seen_tail;             /**< tail as last read by the consumer */
+    uint32_t consumer_sleeps;       /**< futex, 1 while the consumer sleeps or is about to */
+    uint8_t data[INPROC_RING_BYTES] __attribute__((aligned(INPROC_LINE)));
+};
+
+/** @brief The two directions between two threads */
+struct inproc_channel {
+    struct inproc_ring rings[2];
+};
+
+/** @brief One end of the in-process transport */
+struct inproc_transport {
+    struct transport transport;     /**< the operations, first member */
+    struct inproc_ring *in;         /**< the ring read from */
+    struct inproc_ring *out;        /**< the ring written to */
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Initializes a transport over a connected stream socket
+ */
+void open_socket_transport(struct socket_transport *transport, int fd);
+
+/**
+ * @brief Initializes a channel and its two ends, each end may be used by another thread
+ */
+void open_inproc_channel(struct inproc_channel *channel, struct inproc_transport *a, struct inproc_transport *b);
+
+/**
+ * @brief Closes the writing side of an in-process end, the other end reads 0 once it has read everything
+ */
+void close_inproc_transport(struct inproc_transport *transport);
+
+/**
+ * @brief Reads exactly len bytes
+ * @return 0 on success, -1 if the other end closed before (errno is 0) or on error (errno is set)
+ */
+int read_exactly(struct transport *transport, uint8_t *buf, size_t len);
+
+#endif /* TRANSPORT_H */
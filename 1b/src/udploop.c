@@ -0,0 +1,487 @@
+/**
+ * @file udploop.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the udploop module
+ */
+
+#define _GNU_SOURCE	/* recvmmsg, sendmmsg */
+#include "udploop.h"
+#include "answers.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+
+
+/* === Constants === */
+
+/** @brief Datagrams per recvmmsg/sendmmsg */
+#define UDP_BATCH (64)
+
+/** @brief Initial number of slots of the game table, a power of two */
+#define INITIAL_SLOTS (4096)
+/** @brief The game table does not grow beyond this, new games are dropped until a sweep makes room */
+#define MAX_SLOTS (1 << 20)
+/** @brief A sweep shrinks the game table while less than 1/SHRINK_LOAD of its slots are used */
+#define SHRINK_LOAD (8)
+
+/** @brief Milliseconds between two sweeps of the game table */
+#define SWEEP_INTERVAL (1000)
+
+
+/* === Macros === */
+
+#ifdef _ENDEBUG
+#define DEBUG(...) do { fprintf(stderr, __VA_ARGS__); } while(0)
+#else
+#define DEBUG(...)
+#endif
+
+
+/* === Type Definitions === */
+
+/** @brief A game played over UDP */
+struct udp_game {
+    bool used;                      /**< the slot holds a game */
+    uint32_t id;                    /**< the game id chosen by the client */
+    uint32_t addr;                  /**< address of the client, network byte order */
+    uint16_t port;                  /**< port of the client, network byte order */
+    time_t last_seen;               /**< time of the last request */
+    struct game game;               /**< the game */
+    mm_response_t responses[MAX_TRIES]; /**< the responses of the rounds played, for retransmissions */
+    uint32_t capture_game;          /**< number of the game in the capture */
+};
+
+/** @brief The state of a UDP loop */
+struct udp_loop {
+    int fd;                             /**< the socket */
+    const struct loop_config *config;   /**< the game configuration */
+    struct secret_picker secrets;       /**< hands out the secrets of this loop */
+    struct answer_cache *answers;       /**< tables of the secrets played often, NULL if out of memory */
+    struct game_stats *stats;           /**< results of the games dropped from the table */
+    struct loop_metrics *metrics;       /**< the live counters of this loop, NULL for none */
+    struct capture_writer *capture;     /**< records the rounds of this loop, NULL for none */
+    unsigned int played;                /**< rounds played in the current batch of datagrams */
+    struct udp_game *games;             /**< hash table with linear probing */
+    size_t slots;                       /**< number of slots of games, a power of two */
+    size_t count;                       /**< number of used slots */
+    time_t now;                         /**< the time of the current batch of datagrams */
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Hashes the key of a game
+ */
+static size_t hash_game(uint32_t id, uint32_t addr, uint16_t port);
+
+/**
+ * @brief Records a game in the statistics and releases its table
+ */
+static void finish_game(struct udp_loop *loop, struct udp_game *game);
+
+/**
+ * @brief Moves the games into a new table with the given number of slots
+ * @return 0 on success, -1 if out of memory (the table is unchanged then)
+ */
+static int resize_games(struct udp_loop *loop, size_t slots);
+
+/**
+ * @brief Empties a slot of the game table, moving the games after it back to keep their probe sequences intact
+ * @param hole The slot, its game is already finished
+ */
+static void remove_game(struct udp_loop *loop, size_t hole);
+
+/**
+ * @brief Drops the games which are done from the table, in place, and shrinks it if it got too empty
+ * @param all Drop all games, for the end of the loop
+ */
+static void sweep_games(struct udp_loop *loop, bool all);
+
+/**
+ * @brief Looks up the game of a request, a request for round 1 of an unknown game starts it
+ * @return The game, NULL if there is none
+ */
+static struct udp_game *find_game(struct udp_loop *loop, uint32_t id, const struct sockaddr_in *peer,
+    uint16_t round);
+
+/**
+ * @brief Answers one datagram
+ * @param in The datagram
+ * @param len Its length
+ * @param peer The sender
+ * @param out Buffer for the response of UDP_RESPONSE_BYTES
+ * @return true if out is to be sent
+ */
+static bool handle_datagram(struct udp_loop *loop, const uint8_t *in, size_t len, const struct sockaddr_in *peer,
+    uint8_t *out);
+
+/**
+ * @brief Receives and answers datagrams until none is left
+ * @return 0 on success, -1 on a fatal error
+ */
+static int serve_datagrams(struct udp_loop *loop);
+
+
+/* === Implementations === */
+
+static size_t hash_game(uint32_t id, uint32_t addr, uint16_t port)
+{
+    uint64_t h = ((uint64_t)addr << 32 | id) ^ ((uint64_t)port << 16);
+
+    h *= 0x9e3779b97f4a7c15ULL;
+    return (size_t)(h ^ (h >> 29));
+}
+
+static void finish_game(struct udp_loop *loop, struct udp_game *game)
+{
+    DEBUG("UDP game %u ends after %d rounds, result %d\n", game->id, game->game.round, game->game.result);
+    record_game(loop->stats, &game->game);
+    if (loop->metrics != NULL) {
+        count_game(loop->metrics, &game->game);
+    }
+    if (game->game.answers != NULL) {
+        release_answer_table(loop->answers, game->game.answers);
+    }
+    game->used = false;
+}
+
+static int resize_games(struct udp_loop *loop, size_t slots)
+{
+    struct udp_game *games;
+
+    if ( (games = calloc(slots, sizeof *games)) == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < loop->slots; i++) {
+        struct udp_game *game = &loop->games[i];
+
+        if (!game->used) {
+            continue;
+        }
+        size_t pos = hash_game(game->id, game->addr, game->port) & (slots - 1);
+        while (games[pos].used) {
+            pos = (pos + 1) & (slots - 1);
+        }
+        games[pos] = *game;
+    }
+    free(loop->games);
+    loop->games = games;
+    loop->slots = slots;
+    return 0;
+}
+
+static void remove_game(struct udp_loop *loop, size_t hole)
+{
+    size_t mask = loop->slots - 1;
+
+    for (size_t pos = (hole + 1) & mask; loop->games[pos].used; pos = (pos + 1) & mask) {
+        struct udp_game *game = &loop->games[pos];
+        size_t home = hash_game(game->id, game->addr, game->port) & mask;
+
+        /* the game may fill the hole if the hole is on its probe sequence, from its home slot to pos */
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            loop->games[hole] = *game;
+            hole = pos;
+        }
+    }
+    loop->games[hole].used = false;
+    loop->count--;
+}
+
+static void sweep_games(struct udp_loop *loop, bool all)
+{
+    size_t mask = loop->slots - 1, start = 0, slots = loop->slots;
+
+    /* the table is at most half full; starting behind a free slot, remove_game only moves games which are
+     * not yet visited into the slot visited, which is then visited again */
+    while (loop->games[start].used) {
+        start++;
+    }
+    for (size_t n = 0; n < loop->slots; ) {
+        size_t i = (start + n) & mask;
+        struct udp_game *game = &loop->games[i];
+
+        if (!game->used) {
+            n++;
+            continue;
+        }
+        bool over = game->game.result != GAME_RUNNING;
+        if (all || (over && loop->now - game->last_seen >= UDP_LINGER) ||
+            loop->now - game->last_seen >= UDP_IDLE_TIMEOUT) {
+            finish_game(loop, game);
+            remove_game(loop, i);
+        } else {
+            n++;
+        }
+    }
+
+    /* a burst of games must not leave a huge table behind, which every sweep has to go through */
+    while (!all && slots > INITIAL_SLOTS && loop->count < slots / SHRINK_LOAD) {
+        slots /= 2;
+    }
+    if (slots != loop->slots) {
+        (void) resize_games(loop, slots);   /* the larger table does as well */
+    }
+}
+
+static struct udp_game *find_game(struct udp_loop *loop, uint32_t id, const struct sockaddr_in *peer,
+    uint16_t round)
+{
+    uint32_t addr = peer->sin_addr.s_addr;
+    uint16_t port = peer->sin_port;
+    size_t pos = hash_game(id, addr, port) & (loop->slots - 1);
+    uint8_t secret[SLOTS];
+
+    while (loop->games[pos].used) {
+        struct udp_game *game = &loop->games[pos];
+
+        if (game->id == id && game->addr == addr && game->port == port) {
+            return game;
+        }
+        pos = (pos + 1) & (loop->slots - 1);
+    }
+    if (round != 1) {
+        return NULL;
+    }
+
+    /* keep the table at most half full, so that the probe sequences stay short; finished games are only
+     * dropped by the sweep, so a flood of new ids costs at most one copy of the table per doubling */
+    if (2 * (loop->count + 1) > loop->slots) {
+        if (2 * loop->slots > MAX_SLOTS || resize_games(loop, 2 * loop->slots) < 0) {
+            return NULL;
+        }
+        pos = hash_game(id, addr, port) & (loop->slots - 1);
+        while (loop->games[pos].used) {
+            pos = (pos + 1) & (loop->slots - 1);
+        }
+    }
+
+    struct udp_game *game = &loop->games[pos];
+    (void) memset(game, 0, sizeof *game);
+    game->used = true;
+    game->id = id;
+    game->addr = addr;
+    game->port = port;
+    next_secret(&loop->secrets, secret);
+    start_game(&game->game, secret);
+    if (loop->answers != NULL) {
+        game->game.answers = acquire_answer_table(loop->answers, secret);
+    }
+    if (loop->capture != NULL) {
+        game->capture_game = capture_game(loop->capture);
+    }
+    loop->count++;
+    if (loop->metrics != NULL) {
+        METRIC_ADD(loop->metrics->games_started, 1);
+    }
+    DEBUG("UDP game %u started\n", id);
+    return game;
+}
+
+static bool handle_datagram(struct udp_loop *loop, const uint8_t *in, size_t len, const struct sockaddr_in *peer,
+    uint8_t *out)
+{
+    struct udp_game *game;
+    uint32_t id;
+    const uint8_t *header = &in[WIRE_HELLO_BYTES];
+    mm_request_t request;
+    uint16_t round;
+
+    if (len != UDP_REQUEST_BYTES || !wire_hello_ok(in)) {
+        return false;
+    }
+    id = (uint32_t)header[0] | (uint32_t)header[1] << 8 | (uint32_t)header[2] << 16 | (uint32_t)header[3] << 24;
+    round = header[4] | header[5] << 8;
+    request = get_request(&in[UDP_HEADER_BYTES]);
+    if (round == 0 || round > MAX_TRIES || (game = find_game(loop, id, peer, round)) == NULL) {
+        return false;
+    }
+    game->last_seen = loop->now;
+
+    if (round == game->game.round + 1 && game->game.result == GAME_RUNNING) {
+        (void) play_round(&game->game, request, &game->responses[round - 1]);
+        loop->played++;
+        if (loop->capture != NULL) {
+            capture_round(loop->capture, capture_clock(loop->capture), game->capture_game, request,
+                game->responses[round - 1], round);
+        }
+    } else if (round > game->game.round) {
+        return false;   /* an earlier round is missing, or the game is over */
+    }
+    /* the response of a round played before is sent again unchanged */
+    (void) memcpy(out, in, UDP_HEADER_BYTES);
+    put_response(&out[UDP_HEADER_BYTES], game->responses[round - 1]);
+    return true;
+}
+
+static int serve_datagrams(struct udp_loop *loop)
+{
+    uint8_t in[UDP_BATCH][UDP_REQUEST_BYTES + 1];
+    uint8_t out[UDP_BATCH][UDP_RESPONSE_BYTES];
+    struct sockaddr_in peers[UDP_BATCH];
+    struct mmsghdr in_msgs[UDP_BATCH], out_msgs[UDP_BATCH];
+    struct iovec in_iov[UDP_BATCH], out_iov[UDP_BATCH];
+
+    for (;;) {
+        for (int i = 0; i < UDP_BATCH; i++) {
+            in_iov[i].iov_base = in[i];
+            in_iov[i].iov_len = sizeof in[i];   /* one byte more, to notice longer datagrams */
+            (void) memset(&in_msgs[i].msg_hdr, 0, sizeof in_msgs[i].msg_hdr);
+            in_msgs[i].msg_hdr.msg_name = &peers[i];
+            in_msgs[i].msg_hdr.msg_namelen = sizeof peers[i];
+            in_msgs[i].msg_hdr.msg_iov = &in_iov[i];
+            in_msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = recvmmsg(loop->fd, in_msgs, UDP_BATCH, MSG_DONTWAIT, NULL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+
+        uint64_t received = (loop->metrics != NULL) ? metrics_clock() : 0;
+        int replies = 0;
+        loop->played = 0;
+        for (int i = 0; i < n; i++) {
+            if (in_msgs[i].msg_hdr.msg_namelen != sizeof peers[i] ||
+                !handle_datagram(loop, in[i], in_msgs[i].msg_len, &peers[i], out[replies])) {
+                continue;
+            }
+            out_iov[replies].iov_base = out[replies];
+            out_iov[replies].iov_len = UDP_RESPONSE_BYTES;
+            (void) memset(&out_msgs[replies].msg_hdr, 0, sizeof out_msgs[replies].msg_hdr);
+            out_msgs[replies].msg_hdr.msg_name = &peers[i];
+            out_msgs[replies].msg_hdr.msg_namelen = sizeof peers[i];
+            out_msgs[replies].msg_hdr.msg_iov = &out_iov[replies];
+            out_msgs[replies].msg_hdr.msg_iovlen = 1;
+            replies++;
+        }
+
+        /* a response which cannot be sent is lost like any datagram, the client asks again */
+        for (int sent = 0; sent < replies; ) {
+            int m = sendmmsg(loop->fd, &out_msgs[sent], (unsigned int)(replies - sent), 0);
+            if (m < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            sent += m;
+        }
+        if (loop->metrics != NULL) {
+            uint64_t bytes = 0;
+            for (int i = 0; i < n; i++) {
+                bytes += in_msgs[i].msg_len;
+            }
+            METRIC_ADD(loop->metrics->bytes_in, bytes);
+            METRIC_ADD(loop->metrics->bytes_out, (uint64_t)replies * UDP_RESPONSE_BYTES);
+            if (loop->played > 0) {
+                count_rounds(loop->metrics, loop->played, metrics_clock() - received);
+            }
+        }
+        if (n < UDP_BATCH) {
+            return 0;
+        }
+    }
+}
+
+int run_udp_loop(int fd, const struct loop_config *config, unsigned int id, struct game_stats *stats,
+    volatile sig_atomic_t *quit)
+{
+    struct epoll_event ev;
+    struct udp_loop loop;
+    struct timespec ts;
+    time_t last_sweep;
+    int epfd;
+    int ret = 0;
+
+    (void) memset(&loop, 0, sizeof loop);
+    loop.fd = fd;
+    loop.config = config;
+    loop.stats = stats;
+    loop.metrics = (config->metrics != NULL) ? loop_metrics(config->metrics, id) : NULL;
+    init_picker(&loop.secrets, config->secrets, id);
+    if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0 ||
+        (epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        return -1;
+    }
+    if ( (loop.games = calloc(INITIAL_SLOTS, sizeof *loop.games)) == NULL) {
+        (void) close(epfd);
+        return -1;
+    }
+    loop.slots = INITIAL_SLOTS;
+    loop.answers = create_answer_cache();   /* only an optimization, fine without */
+    if (config->capture != NULL && (loop.capture = open_capture_writer(config->capture)) == NULL) {
+        errno = ENOMEM;
+        ret = -1;
+        goto cleanup;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        ret = -1;
+        goto cleanup;
+    }
+    if (config->wake_fd >= 0) {
+        ev.events = EPOLLIN;
+        ev.data.fd = config->wake_fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, config->wake_fd, &ev) < 0) {
+            ret = -1;
+            goto cleanup;
+        }
+    }
+
+    (void) clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    last_sweep = loop.now = ts.tv_sec;
+    while (!*quit) {
+        struct epoll_event events[2];
+        int n = epoll_wait(epfd, events, 2, SWEEP_INTERVAL);
+
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ret = -1;
+            break;
+        }
+        (void) clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        loop.now = ts.tv_sec;
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.fd != fd) {
+                goto cleanup;
+            }
+            if (serve_datagrams(&loop) < 0) {
+                ret = -1;
+                goto cleanup;
+            }
+        }
+        /* finished games are recorded once they are dropped from the table */
+        if (loop.now - last_sweep >= SWEEP_INTERVAL / 1000) {
+            sweep_games(&loop, false);
+            last_sweep = loop.now;
+        }
+    }
+
+cleanup:
+    if (ret < 0) {
+        ret = -errno;   /* keep errno across the cleanup */
+    }
+    sweep_games(&loop, true);
+    free(loop.games);
+    destroy_answer_cache(loop.answers);
+    close_capture_writer(loop.capture);
+    (void) close(epfd);
+    if (ret < 0) {
+        errno = -ret;
+        return -1;
+    }
+    return 0;
+}
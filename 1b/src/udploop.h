@@ -0,0 +1,53 @@
+/**
+ * @file udploop.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief UDP transport of the mastermind server for many short games.
+ * @details There is no connection per game: every datagram names its game and round, so a game costs no
+ * connection setup and many datagrams are received and sent per system call (recvmmsg/sendmmsg).
+ *
+ * A request has UDP_REQUEST_BYTES (see mastermind.h): the greeting of WIRE_VERSION 2, the game id (4 bytes),
+ * the round (2 bytes, starting at 1) and the guess as usual, all least significant byte first. The response
+ * has UDP_RESPONSE_BYTES: the same header and the response. Datagrams with another greeting are dropped. A game starts with the first request of round 1 for a new id
+ * from a client address. Clients retransmit requests which were not answered in time; a request for a
+ * round already played is answered again with the stored response, without playing it again, and a request
+ * for a later round than the next one is dropped.
+ *
+ * The games live in a hash table keyed by the client address and the game id. Finished games are kept for
+ * UDP_LINGER seconds to answer retransmissions, games without requests for UDP_IDLE_TIMEOUT seconds are
+ * dropped and count as aborted.
+ */
+
+#ifndef UDPLOOP_H
+#define UDPLOOP_H
+
+#include <signal.h>
+#include "game.h"
+#include "eventloop.h"
+
+/* === Constants === */
+
+/** @brief Seconds a finished game is kept for retransmissions */
+#define UDP_LINGER (2)
+/** @brief Seconds after which a game without requests is dropped */
+#define UDP_IDLE_TIMEOUT (30)
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Plays the games arriving on a UDP socket until *quit is set or config->wake_fd is readable
+ * @details Like run_event_loop every loop keeps its state to itself. If several loops share a port with
+ * SO_REUSEPORT, the kernel hands all datagrams of a client address to the same loop.
+ * @param fd The bound UDP socket, it is made non-blocking
+ * @param config The configuration of the games
+ * @param id Number of the loop, unique among the loops sharing config
+ * @param stats Receives the results of all games played by the loop, including those aborted at the end
+ * @param quit Flag set by a signal handler to stop the loop
+ * @return 0 if the loop was stopped, -1 on error (errno is set)
+ */
+int run_udp_loop(int fd, const struct loop_config *config, unsigned int id, struct game_stats *stats,
+    volatile sig_atomic_t *quit);
+
+#endif /* UDPLOOP_H */
@@ -0,0 +1,875 @@
+/**
+ * @file uringloop.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the uringloop module
+ */
+
+#define _GNU_SOURCE	/* syscall, MAP_ANONYMOUS */
+#include "uringloop.h"
+#include "answers.h"
+#include "session.h"
+#include "slab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <linux/io_uring.h>
+
+
+/* === Constants === */
+
+/** @brief Submission queue entries, the completion queue is larger since multishot requests complete often */
+#define RING_ENTRIES (256)
+#define RING_CQ_ENTRIES (4096)
+
+/** @brief Receive buffers in the provided buffer ring, a power of two */
+#define BUFFER_COUNT (512)
+/** @brief Size of a receive buffer, a full batch fits */
+#define BUFFER_BYTES (256)
+/** @brief The id of the buffer group */
+#define BUFFER_GROUP (0)
+
+/** @brief Operations, kept in the low bits of the user data next to the connection */
+enum op {
+    OP_ACCEPT = 1,
+    OP_WAKE,
+    OP_RECV,
+    OP_SEND,
+    OP_SHUTDOWN,
+    OP_CANCEL,
+    OP_TICK,
+};
+#define OP_MASK ((uint64_t)7)
+
+
+/* === Macros === */
+
+#ifdef _ENDEBUG
+#define DEBUG(...) do { fprintf(stderr, __VA_ARGS__); } while(0)
+#else
+#define DEBUG(...)
+#endif
+
+/* Reads and writes of the memory shared with the kernel */
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+
+/* === Type Definitions === */
+
+/** @brief The queues of an io_uring as mapped from the kernel */
+struct ring {
+    int fd;
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int sq_mask;
+    unsigned int sq_entries;
+    unsigned int *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_map;
+    size_t sq_map_size;
+    void *cq_map;               /**< equal to sq_map if the kernel maps both queues at once */
+    size_t cq_map_size;
+    size_t sqes_size;
+    unsigned int to_submit;     /**< entries queued since the last io_uring_enter */
+};
+
+/** @brief A session with the operations in flight on its connection */
+struct connection {
+    struct session session;     /**< the protocol state, first member */
+    unsigned int inflight;      /**< operations not completed yet, the connection is freed at 0 */
+    bool receiving;             /**< the multishot receive is armed */
+    bool sending;               /**< a send is in flight */
+    bool shut;                  /**< the shutdown of the sending side is queued or done */
+    bool closing;               /**< the game is recorded, the connection waits for its operations */
+};
+
+/** @brief The state of an io_uring loop */
+struct loop {
+    struct ring ring;                   /**< the io_uring */
+    int listenfd;                       /**< the listening socket */
+    const struct loop_config *config;   /**< the game configuration */
+    struct secret_picker secrets;       /**< hands out the secrets of this loop */
+    struct answer_cache *answers;       /**< tables of the secrets played often, NULL if out of memory */
+    struct game_stats *stats;           /**< results of the games played */
+    struct loop_metrics *metrics;       /**< the live counters of this loop, NULL for none */
+    struct session_context sessions;    /**< the capture writer and the pending input of the sessions */
+    struct io_uring_buf_ring *buffers;  /**< the provided buffer ring */
+    uint8_t *buffer_data;               /**< the memory of the receive buffers */
+    uint16_t buffer_tail;               /**< next entry of the buffer ring to fill */
+    bool accepting;                     /**< the multishot accept is armed */
+    bool waiting;                       /**< the poll of the wake descriptor is armed */
+    unsigned int cancels;               /**< cancellations of the accept and the poll not completed */
+    bool stopping;                      /**< the loop shuts down, nothing new is started */
+    struct slab connections;            /**< the connections not freed yet, found by their file descriptor */
+    struct timer_wheel timers;          /**< deadlines of the connections, in ticks of SESSION_TICK_MS */
+    uint64_t now;                       /**< the time after the last wait, see session_clock */
+    struct __kernel_timespec tick;      /**< the interval of the tick timeout */
+    bool ticking;                       /**< the tick timeout is queued */
+    int error;                          /**< errno of a fatal error, 0 if none */
+};
+
+
+/* === Prototypes === */
+
+/**
+ * @brief Creates an io_uring and maps its queues
+ * @return 0 on success, -1 otherwise (errno is set)
+ */
+static int open_ring(struct ring *ring, unsigned int entries, unsigned int cq_entries);
+
+/**
+ * @brief Unmaps and closes an io_uring
+ */
+static void close_ring(struct ring *ring);
+
+/**
+ * @brief Returns a cleared submission queue entry, submits the queued ones first if fewer than n are free
+ */
+static struct io_uring_sqe *get_sqe(struct ring *ring, unsigned int n);
+
+/**
+ * @brief Submits the queued entries and waits for at least wait completions
+ * @return 0 on success, -1 otherwise (errno is set)
+ */
+static int submit_and_wait(struct ring *ring, unsigned int wait);
+
+/**
+ * @brief Registers the provided buffer ring and fills it with all receive buffers
+ * @return 0 on success, -1 otherwise (errno is set)
+ */
+static int setup_buffers(struct loop *loop);
+
+/**
+ * @brief Hands a receive buffer back to the kernel
+ */
+static void return_buffer(struct loop *loop, uint16_t bid);
+
+/**
+ * @brief Queues the multishot accept
+ */
+static void arm_accept(struct loop *loop);
+
+/**
+ * @brief Queues the multishot receive of a connection
+ */
+static void arm_recv(struct loop *loop, struct connection *conn);
+
+/**
+ * @brief Creates the session of a freshly accepted connection
+ */
+static void open_connection(struct loop *loop, int fd);
+
+/**
+ * @brief Records the game of a connection and cancels its operations, release_connection frees it once they
+ * completed
+ */
+static void close_connection(struct loop *loop, struct connection *conn);
+
+/**
+ * @brief Closes and frees a connection once nothing is in flight anymore
+ */
+static void release_connection(struct loop *loop, struct connection *conn);
+
+/**
+ * @brief Sends the pending responses, the last ones of a game linked to a shutdown
+ */
+static void flush_responses(struct loop *loop, struct connection *conn);
+
+/**
+ * @brief Closes a connection which ran out of time, its game is lost
+ * @param timer The timer of the session
+ * @param arg The loop
+ */
+static void expire_session(struct timer *timer, void *arg);
+
+/**
+ * @brief Queues a timeout of one tick if there are deadlines and none is queued yet
+ */
+static void arm_tick(struct loop *loop);
+
+/**
+ * @brief Handles one completion
+ */
+static void handle_completion(struct loop *loop, const struct io_uring_cqe *cqe);
+
+
+/* === Implementations === */
+
+static int sys_io_uring_setup(unsigned int entries, struct io_uring_params *params)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int sys_io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_io_uring_register(int fd, unsigned int opcode, void *arg, unsigned int nr_args)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static int open_ring(struct ring *ring, unsigned int entries, unsigned int cq_entries)
+{
+    struct io_uring_params params;
+
+    (void) memset(ring, 0, sizeof *ring);
+    (void) memset(&params, 0, sizeof params);
+    /* only the loop's own thread submits, and completions are only needed when it waits for them */
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    params.cq_entries = cq_entries;
+    if ( (ring->fd = sys_io_uring_setup(entries, &params)) < 0 && errno == EINVAL) {
+        (void) memset(&params, 0, sizeof params);
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = cq_entries;
+        ring->fd = sys_io_uring_setup(entries, &params);
+    }
+    if (ring->fd < 0) {
+        return -1;
+    }
+
+    ring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof (unsigned int);
+    ring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof (struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_map_size > ring->sq_map_size) {
+            ring->sq_map_size = ring->cq_map_size;
+        }
+        ring->cq_map_size = ring->sq_map_size;
+    }
+    ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+        IORING_OFF_SQ_RING);
+    if (ring->sq_map == MAP_FAILED) {
+        ring->sq_map = NULL;
+        close_ring(ring);
+        return -1;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_map = ring->sq_map;
+    } else {
+        ring->cq_map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_map == MAP_FAILED) {
+            ring->cq_map = NULL;
+            close_ring(ring);
+            return -1;
+        }
+    }
+    ring->sqes_size = params.sq_entries * sizeof (struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+        IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        close_ring(ring);
+        return -1;
+    }
+
+    uint8_t *sq = ring->sq_map;
+    uint8_t *cq = ring->cq_map;
+    ring->sq_head = (unsigned int *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned int *)(sq + params.sq_off.tail);
+    ring->sq_mask = *(unsigned int *)(sq + params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+    ring->sq_array = (unsigned int *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned int *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned int *)(cq + params.cq_off.tail);
+    ring->cq_mask = *(unsigned int *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    return 0;
+}
+
+static void close_ring(struct ring *ring)
+{
+    if (ring->sqes != NULL) {
+        (void) munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_map != NULL && ring->cq_map != ring->sq_map) {
+        (void) munmap(ring->cq_map, ring->cq_map_size);
+    }
+    if (ring->sq_map != NULL) {
+        (void) munmap(ring->sq_map, ring->sq_map_size);
+    }
+    if (ring->fd >= 0) {
+        (void) close(ring->fd);
+    }
+}
+
+static int submit_and_wait(struct ring *ring, unsigned int wait)
+{
+    int r = sys_io_uring_enter(ring->fd, ring->to_submit, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0);
+
+    if (r < 0) {
+        return -1;
+    }
+    ring->to_submit -= ((unsigned int)r < ring->to_submit) ? (unsigned int)r : ring->to_submit;
+    return 0;
+}
+
+static struct io_uring_sqe *get_sqe(struct ring *ring, unsigned int n)
+{
+    unsigned int tail = *ring->sq_tail;
+    struct io_uring_sqe *sqe;
+
+    /* linked entries must not be split over two submissions, so make room for all of them at once */
+    while (ring->sq_entries - (tail - LOAD_ACQUIRE(ring->sq_head)) < n) {
+        if (submit_and_wait(ring, 0) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            return NULL;
+        }
+    }
+    sqe = &ring->sqes[tail & ring->sq_mask];
+    (void) memset(sqe, 0, sizeof *sqe);
+    ring->sq_array[tail & ring->sq_mask] = tail & ring->sq_mask;
+    STORE_RELEASE(ring->sq_tail, tail + 1);
+    ring->to_submit++;
+    return sqe;
+}
+
+static uint64_t tag(struct connection *conn, enum op op)
+{
+    return (uint64_t)(uintptr_t)conn | (uint64_t)op;
+}
+
+bool uring_supported(void)
+{
+    static const uint8_t needed[] = {
+        IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_SHUTDOWN, IORING_OP_ASYNC_CANCEL,
+        IORING_OP_POLL_ADD, IORING_OP_TIMEOUT,
+        IORING_OP_SEND_ZC,  /* not used, but came with multishot receive in Linux 6.0 */
+    };
+    struct ring ring;
+    struct io_uring_probe *probe;
+    size_t probe_size = sizeof *probe + 256 * sizeof probe->ops[0];
+    bool supported = true;
+
+    if (open_ring(&ring, 4, 8) < 0) {
+        return false;
+    }
+    if ( (probe = calloc(1, probe_size)) == NULL ||
+        sys_io_uring_register(ring.fd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+        supported = false;
+    }
+    for (size_t i = 0; supported && i < sizeof needed; i++) {
+        if (needed[i] > probe->last_op || !(probe->ops[needed[i]].flags & IO_URING_OP_SUPPORTED)) {
+            errno = ENOSYS;
+            supported = false;
+        }
+    }
+    free(probe);
+    close_ring(&ring);
+    return supported;
+}
+
+static int setup_buffers(struct loop *loop)
+{
+    struct io_uring_buf_reg reg;
+    size_t ring_size = BUFFER_COUNT * sizeof (struct io_uring_buf);
+
+    loop->buffers = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (loop->buffers == MAP_FAILED) {
+        loop->buffers = NULL;
+        return -1;
+    }
+    if ( (loop->buffer_data = malloc(BUFFER_COUNT * BUFFER_BYTES)) == NULL) {
+        return -1;
+    }
+    (void) memset(&reg, 0, sizeof reg);
+    reg.ring_addr = (uint64_t)(uintptr_t)loop->buffers;
+    reg.ring_entries = BUFFER_COUNT;
+    reg.bgid = BUFFER_GROUP;
+    if (sys_io_uring_register(loop->ring.fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        return -1;
+    }
+    for (uint16_t bid = 0; bid < BUFFER_COUNT; bid++) {
+        return_buffer(loop, bid);
+    }
+    return 0;
+}
+
+static void return_buffer(struct loop *loop, uint16_t bid)
+{
+    struct io_uring_buf *buf = &loop->buffers->bufs[loop->buffer_tail & (BUFFER_COUNT - 1)];
+
+    buf->addr = (uint64_t)(uintptr_t)&loop->buffer_data[(size_t)bid * BUFFER_BYTES];
+    buf->len = BUFFER_BYTES;
+    buf->bid = bid;
+    loop->buffer_tail++;
+    STORE_RELEASE(&loop->buffers->tail, loop->buffer_tail);
+}
+
+static void arm_accept(struct loop *loop)
+{
+    struct io_uring_sqe *sqe = get_sqe(&loop->ring, 1);
+
+    if (sqe == NULL) {
+        loop->error = errno;
+        return;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = loop->listenfd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = tag(NULL, OP_ACCEPT);
+    loop->accepting = true;
+}
+
+static void arm_recv(struct loop *loop, struct connection *conn)
+{
+    struct io_uring_sqe *sqe = get_sqe(&loop->ring, 1);
+
+    if (sqe == NULL) {
+        loop->error = errno;
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn->session.fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = tag(conn, OP_RECV);
+    conn->inflight++;
+    conn->receiving = true;
+}
+
+static void open_connection(struct loop *loop, int fd)
+{
+    struct connection *conn;
+    uint8_t secret[SLOTS];
+    int optval = 1;
+
+    /* the records are aligned to cache lines, so the low bits of the address are free for the operation */
+    if ( (conn = slab_alloc(&loop->connections, fd)) == NULL) {
+        (void) close(fd);
+        return;
+    }
+    next_secret(&loop->secrets, secret);
+    start_session(&conn->session, &loop->sessions, fd, secret, loop->now);
+    conn->inflight = 0;
+    conn->receiving = conn->sending = conn->shut = conn->closing = false;
+    if (loop->answers != NULL) {
+        conn->session.game.answers = acquire_answer_table(loop->answers, secret);
+    }
+
+    /* the responses are single bytes which must not wait for anything */
+    (void) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof optval);
+
+    if (loop->metrics != NULL) {
+        METRIC_ADD(loop->metrics->games_started, 1);
+    }
+    update_session_timer(&loop->timers, &conn->session, &loop->sessions, &loop->config->limits, loop->now);
+    arm_recv(loop, conn);
+    DEBUG("Accepted client on %d\n", fd);
+}
+
+static void close_connection(struct loop *loop, struct connection *conn)
+{
+    struct session *session = &conn->session;
+
+    if (conn->closing) {
+        return;
+    }
+    DEBUG("Closing client on %d after %d rounds, result %d\n", session->fd, session->game.round,
+        session->game.result);
+    conn->closing = true;
+    record_game(loop->stats, &session->game);
+    if (loop->metrics != NULL) {
+        count_game(loop->metrics, &session->game);
+    }
+    if (session->game.answers != NULL) {
+        release_answer_table(loop->answers, session->game.answers);
+        session->game.answers = NULL;
+    }
+    end_session(session, &loop->sessions);
+    cancel_timer(&loop->timers, &session->timer);
+    if (conn->inflight > 0) {
+        struct io_uring_sqe *sqe = get_sqe(&loop->ring, 1);
+
+        if (sqe == NULL) {
+            loop->error = errno;
+            return;
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = session->fd;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        sqe->user_data = tag(conn, OP_CANCEL);
+        conn->inflight++;
+    }
+}
+
+static void release_connection(struct loop *loop, struct connection *conn)
+{
+    if (!conn->closing || conn->inflight > 0) {
+        return;
+    }
+    slab_free(&loop->connections, conn->session.fd);
+    (void) close(conn->session.fd);
+    if (!loop->accepting && !loop->stopping) {
+        arm_accept(loop);   /* paused because the descriptors ran out */
+    }
+}
+
+static void flush_responses(struct loop *loop, struct connection *conn)
+{
+    struct session *session = &conn->session;
+    struct io_uring_sqe *sqe;
+    bool last = SESSION_OVER(session) && !conn->shut;
+
+    if (conn->closing || conn->sending) {
+        return;
+    }
+    if (session->out_sent < session->out_len) {
+        if ( (sqe = get_sqe(&loop->ring, last ? 2 : 1)) == NULL) {
+            loop->error = errno;
+            return;
+        }
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = session->fd;
+        sqe->addr = (uint64_t)(uintptr_t)&session->out[session->out_sent];
+        sqe->len = (uint32_t)(session->out_len - session->out_sent);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = tag(conn, OP_SEND);
+        conn->inflight++;
+        conn->sending = true;
+        if (!last) {
+            return;
+        }
+        /* the shutdown only runs after the last responses went out completely */
+        sqe->flags |= IOSQE_IO_LINK;
+    } else if (!last) {
+        return;
+    }
+    if ( (sqe = get_sqe(&loop->ring, 1)) == NULL) {
+        loop->error = errno;
+        return;
+    }
+    sqe->opcode = IORING_OP_SHUTDOWN;
+    sqe->fd = session->fd;
+    sqe->len = SHUT_WR;
+    sqe->user_data = tag(conn, OP_SHUTDOWN);
+    conn->inflight++;
+    conn->shut = true;
+}
+
+static void handle_recv(struct loop *loop, struct connection *conn, int res, uint32_t flags)
+{
+    if (!(flags & IORING_CQE_F_MORE)) {
+        conn->receiving = false;
+        conn->inflight--;
+    }
+    if (res > 0) {
+        uint16_t bid = (uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT);
+        int round = conn->session.game.round;
+        uint64_t received = (loop->metrics != NULL) ? metrics_clock() : 0;
+        int played = 0;
+
+        if (!conn->closing) {
+            played = feed_session(&conn->session, &loop->sessions, &loop->buffer_data[(size_t)bid * BUFFER_BYTES],
+                (size_t)res);
+            update_session_timer(&loop->timers, &conn->session, &loop->sessions, &loop->config->limits, loop->now);
+        }
+        return_buffer(loop, bid);
+        if (played < 0) {
+            close_connection(loop, conn);
+        } else {
+            flush_responses(loop, conn);
+        }
+        if (loop->metrics != NULL) {
+            METRIC_ADD(loop->metrics->bytes_in, (uint64_t)res);
+            if (conn->session.game.round != round) {
+                count_rounds(loop->metrics, (unsigned int)(conn->session.game.round - round),
+                    metrics_clock() - received);
+            }
+        }
+    } else if (res == 0) {
+        close_connection(loop, conn);   /* the client went away */
+    } else if (res != -ENOBUFS && res != -ECANCELED) {
+        close_connection(loop, conn);
+    }
+    /* the receive also ends when the buffers ran out for a moment, they are all back by now */
+    if (!conn->receiving && !conn->closing) {
+        arm_recv(loop, conn);
+    }
+    release_connection(loop, conn);
+}
+
+static void expire_session(struct timer *timer, void *arg)
+{
+    struct loop *loop = arg;
+    struct connection *conn = (struct connection *)SESSION_OF_TIMER(timer);
+
+    DEBUG("Client %d ran out of time\n", conn->session.fd);
+    expire_game(&conn->session.game);
+    close_connection(loop, conn);
+    release_connection(loop, conn);
+}
+
+static void arm_tick(struct loop *loop)
+{
+    struct io_uring_sqe *sqe;
+
+    if (loop->ticking || loop->timers.count == 0 || loop->stopping) {
+        return;
+    }
+    if ( (sqe = get_sqe(&loop->ring, 1)) == NULL) {
+        loop->error = errno;
+        return;
+    }
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = (uint64_t)(uintptr_t)&loop->tick;
+    sqe->len = 1;
+    sqe->user_data = tag(NULL, OP_TICK);
+    loop->ticking = true;
+}
+
+static void handle_completion(struct loop *loop, const struct io_uring_cqe *cqe)
+{
+    struct connection *conn = (struct connection *)(uintptr_t)(cqe->user_data & ~OP_MASK);
+
+    switch ((enum op)(cqe->user_data & OP_MASK)) {
+    case OP_ACCEPT:
+        if (!(cqe->flags & IORING_CQE_F_MORE)) {
+            loop->accepting = false;
+        }
+        if (cqe->res >= 0) {
+            if (loop->stopping) {
+                (void) close(cqe->res);
+            } else {
+                open_connection(loop, cqe->res);
+            }
+        } else if (cqe->res == -EMFILE || cqe->res == -ENFILE) {
+            /* out of descriptors: the accept is armed again once a connection is closed */
+            (void) fprintf(stderr, "server: too many open files, waiting for clients to leave\n");
+            return;
+        } else if (cqe->res != -EINTR && cqe->res != -ECONNABORTED && cqe->res != -EPROTO &&
+            cqe->res != -ECANCELED) {
+            loop->error = -cqe->res;
+            return;
+        }
+        if (!loop->accepting && !loop->stopping) {
+            arm_accept(loop);
+        }
+        break;
+    case OP_WAKE:
+        loop->waiting = false;
+        loop->stopping = true;
+        break;
+    case OP_RECV:
+        handle_recv(loop, conn, cqe->res, cqe->flags);
+        break;
+    case OP_SEND:
+        conn->inflight--;
+        conn->sending = false;
+        if (cqe->res < 0) {
+            close_connection(loop, conn);
+        } else {
+            int round = conn->session.game.round;
+            uint64_t sent = (loop->metrics != NULL) ? metrics_clock() : 0;
+
+            if (loop->metrics != NULL) {
+                METRIC_ADD(loop->metrics->bytes_out, (uint64_t)cqe->res);
+            }
+            if (!conn->closing && responses_sent(&conn->session, &loop->sessions, (size_t)cqe->res) < 0) {
+                close_connection(loop, conn);
+            } else if (conn->session.game.round != round) {
+                /* requests waiting for the buffer were played, a client reading is not idle either */
+                update_session_timer(&loop->timers, &conn->session, &loop->sessions, &loop->config->limits,
+                    loop->now);
+                if (loop->metrics != NULL) {
+                    count_rounds(loop->metrics, (unsigned int)(conn->session.game.round - round),
+                        metrics_clock() - sent);
+                }
+            }
+            flush_responses(loop, conn);
+        }
+        release_connection(loop, conn);
+        break;
+    case OP_SHUTDOWN:
+        conn->inflight--;
+        if (cqe->res == -ECANCELED) {
+            conn->shut = false;     /* the linked send was short, try again after the rest */
+            flush_responses(loop, conn);
+        } else if (cqe->res < 0) {
+            close_connection(loop, conn);
+        }
+        release_connection(loop, conn);
+        break;
+    case OP_CANCEL:
+        if (conn == NULL) {
+            loop->cancels--;    /* of the accept or the poll, see cancel_loop_operation */
+            break;
+        }
+        conn->inflight--;
+        release_connection(loop, conn);
+        break;
+    case OP_TICK:
+        loop->ticking = false;  /* the timers are advanced after every wait anyway */
+        break;
+    }
+}
+
+/**
+ * @brief Cancels the accept or the poll of the wake descriptor, which are not bound to a connection
+ * @details Until it has completed, the kernel holds a reference to the listening socket, also after the
+ * ring is closed, so a new server could not bind to the port yet.
+ * @param loop The loop
+ * @param op OP_ACCEPT or OP_WAKE
+ */
+static void cancel_loop_operation(struct loop *loop, enum op op)
+{
+    struct io_uring_sqe *sqe = get_sqe(&loop->ring, 1);
+
+    if (sqe == NULL) {
+        loop->error = errno;
+        return;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = tag(NULL, op);
+    sqe->user_data = tag(NULL, OP_CANCEL);
+    loop->cancels++;
+}
+
+/**
+ * @brief Handles all completions which have arrived
+ */
+static void reap_completions(struct loop *loop)
+{
+    struct ring *ring = &loop->ring;
+    unsigned int head = *ring->cq_head;
+    unsigned int tail = LOAD_ACQUIRE(ring->cq_tail);
+
+    while (head != tail) {
+        handle_completion(loop, &ring->cqes[head & ring->cq_mask]);
+        head++;
+        if (head == tail) {
+            STORE_RELEASE(ring->cq_head, head);
+            tail = LOAD_ACQUIRE(ring->cq_tail);
+        }
+    }
+}
+
+int run_uring_loop(int listenfd, const struct loop_config *config, unsigned int id, struct game_stats *stats,
+    volatile sig_atomic_t *quit)
+{
+    struct loop loop;
+    int ret = 0;
+
+    (void) memset(&loop, 0, sizeof loop);
+    loop.listenfd = listenfd;
+    loop.config = config;
+    loop.stats = stats;
+    loop.metrics = (config->metrics != NULL) ? loop_metrics(config->metrics, id) : NULL;
+    init_picker(&loop.secrets, config->secrets, id);
+    loop.now = session_clock();
+    init_timer_wheel(&loop.timers, loop.now / SESSION_TICK_MS);
+    loop.tick.tv_sec = 0;
+    loop.tick.tv_nsec = SESSION_TICK_MS * 1000000L;
+
+    if (open_ring(&loop.ring, RING_ENTRIES, RING_CQ_ENTRIES) < 0) {
+        return -1;
+    }
+    if (setup_buffers(&loop) < 0) {
+        ret = -1;
+        goto cleanup;
+    }
+    if (create_slab(&loop.connections, sizeof (struct connection)) < 0) {
+        ret = -1;
+        goto cleanup;
+    }
+    loop.answers = create_answer_cache();   /* only an optimization, fine without */
+    init_session_context(&loop.sessions, NULL, loop.now);
+    if (config->capture != NULL && (loop.sessions.capture = open_capture_writer(config->capture)) == NULL) {
+        errno = ENOMEM;
+        ret = -1;
+        goto cleanup;
+    }
+    arm_accept(&loop);
+    if (config->wake_fd >= 0) {
+        struct io_uring_sqe *sqe = get_sqe(&loop.ring, 1);
+
+        if (sqe == NULL) {
+            ret = -1;
+            goto cleanup;
+        }
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = config->wake_fd;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = tag(NULL, OP_WAKE);
+        loop.waiting = true;
+    }
+
+    while (!*quit && !loop.stopping && loop.error == 0) {
+        /* while there are deadlines a timeout wakes the loop up every tick */
+        arm_tick(&loop);
+        if (submit_and_wait(&loop.ring, 1) < 0) {
+            if (errno == EINTR) continue;
+            loop.error = errno;
+            break;
+        }
+        loop.now = session_clock();
+        reap_completions(&loop);
+        (void) advance_timer_wheel(&loop.timers, loop.now / SESSION_TICK_MS, expire_session, &loop);
+    }
+
+    /* the sessions are in use by the kernel until their operations are cancelled, and so is the listening
+     * socket until the accept is */
+    loop.stopping = true;
+    if (loop.accepting) {
+        cancel_loop_operation(&loop, OP_ACCEPT);
+    }
+    if (loop.waiting) {
+        cancel_loop_operation(&loop, OP_WAKE);
+    }
+    for (size_t fd = 0; fd < loop.connections.fd_high; fd++) {
+        struct connection *conn = slab_find(&loop.connections, (int)fd);
+
+        if (conn != NULL) {
+            close_connection(&loop, conn);
+            release_connection(&loop, conn);
+        }
+    }
+    while (loop.connections.used > 0 || loop.accepting || loop.waiting || loop.cancels > 0) {
+        if (submit_and_wait(&loop.ring, 1) < 0) {
+            if (errno == EINTR) continue;
+            break;  /* the ring is broken, closing it cancels the rest */
+        }
+        reap_completions(&loop);
+    }
+    if (loop.error != 0) {
+        errno = loop.error;
+        ret = -1;
+    }
+
+cleanup:
+    if (ret < 0) {
+        ret = -errno;   /* keep errno across the cleanup */
+    }
+    close_ring(&loop.ring);
+    destroy_slab(&loop.connections);
+    destroy_answer_cache(loop.answers);
+    destroy_session_context(&loop.sessions);
+    close_capture_writer(loop.sessions.capture);
+    free(loop.buffer_data);
+    if (loop.buffers != NULL) {
+        (void) munmap(loop.buffers, BUFFER_COUNT * sizeof (struct io_uring_buf));
+    }
+    if (ret < 0) {
+        errno = -ret;
+        return -1;
+    }
+    return 0;
+}
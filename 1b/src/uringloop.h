@@ -0,0 +1,47 @@
+/**
+ * @file uringloop.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief io_uring backend of the multi-client mode of the mastermind server.
+ * @details Plays the same games as run_event_loop, but instead of one system call per accept, read and write
+ * every operation is queued in an io_uring and many of them are submitted and completed with one
+ * io_uring_enter: a single multishot accept delivers all new connections, a multishot receive per connection
+ * fills buffers the kernel picks from a provided buffer ring, and the responses are sent with one send per
+ * burst. The last send of a game is linked to a shutdown of the sending side, the connection is closed when
+ * the client hangs up.
+ *
+ * The backend uses the system calls directly and needs Linux 6.0 or later; uring_supported tells whether the
+ * running kernel allows it, otherwise the epoll loop has to be used.
+ */
+
+#ifndef URINGLOOP_H
+#define URINGLOOP_H
+
+#include <signal.h>
+#include <stdbool.h>
+#include "game.h"
+#include "eventloop.h"
+
+/* === Prototypes === */
+
+/**
+ * @brief Tells whether the kernel offers everything run_uring_loop needs
+ * @return true if so, false otherwise (errno is set, ENOSYS if an operation is missing)
+ */
+bool uring_supported(void);
+
+/**
+ * @brief Accepts clients on listenfd and plays their games until *quit is set or config->wake_fd is readable
+ * @details Like run_event_loop every loop keeps its state, including its ring, to itself.
+ * @param listenfd The listening socket
+ * @param config The configuration of the games
+ * @param id Number of the loop, unique among the loops sharing config
+ * @param stats Receives the results of all games played by the loop, including those aborted at the end
+ * @param quit Flag set by a signal handler to stop the loop
+ * @return 0 if the loop was stopped, -1 on error (errno is set)
+ */
+int run_uring_loop(int listenfd, const struct loop_config *config, unsigned int id, struct game_stats *stats,
+    volatile sig_atomic_t *quit);
+
+#endif /* URINGLOOP_H */
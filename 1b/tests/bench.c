@@ -0,0 +1,472 @@
+/**
+ * @file bench.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Measures the throughput of a mastermind server in multi-client mode.
+ * @details Several client threads connect to the server over and over again. Every connection plays a game
+ * of a fixed number of rounds: wrong guesses first and the secret in the last round. At the end the number
+ * of games and rounds per second and the mean round-trip time of a request are printed. With -b the games
+ * use the batch protocol, so a game is a single round trip. With -u the games are played over UDP against a
+ * server started with --udp, every client thread using one socket for all its games. The server may be
+ * given as unix:<path> instead of a hostname and port.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include "../src/mastermind.h"
+
+/* === Constants === */
+
+#define UDP_TIMEOUT_MS (200)
+#define MAX_THREADS (256)
+
+#define USAGE "Usage: %s [-b|-u] [-c <clients>] [-d <seconds>] [-r <rounds>] " \
+    "<server-hostname> <server-port>|unix:<path> <secret-sequence>"
+
+#define UNIX_PREFIX "unix:"
+
+
+/* === Type Definitions === */
+
+/** @brief The state of one client thread */
+struct client {
+    pthread_t thread;
+    unsigned long games;    /**< games won */
+    unsigned long errors;   /**< games which went wrong */
+    uint64_t rtt_ns;        /**< sum of the round-trip times */
+    unsigned long rtts;     /**< number of round trips */
+    unsigned long retransmissions;  /**< UDP requests sent again */
+    uint32_t game_id;       /**< id of the current UDP game */
+};
+
+
+/* === Global Variables === */
+
+/* Name of the program with default value */
+static const char *progname = "bench";
+
+/* The address of the server */
+static struct sockaddr_storage server_addr;
+static socklen_t server_addrlen;
+
+/* The guesses of every game, the last one is the secret */
+static uint8_t game_requests[MAX_TRIES * REQUEST_BYTES];
+static size_t rounds = 10;
+
+/* The whole game in the batch protocol: the greeting, the hello, the number of guesses and the guesses */
+static uint8_t batch_request[WIRE_HELLO_BYTES + REQUEST_BYTES + 1 + MAX_TRIES * REQUEST_BYTES];
+static bool batched = false;
+static bool udp = false;
+
+/* Set by the main thread once the time is up */
+static volatile bool stop = false;
+
+
+/* === Implementations === */
+
+/**
+ * @brief terminate program on program error
+ * @param exitcode exit code
+ * @param fmt format string
+ */
+static void bail_out(int exitcode, const char *fmt, ...)
+{
+    va_list ap;
+
+    (void) fprintf(stderr, "%s: ", progname);
+    if (fmt != NULL) {
+        va_start(ap, fmt);
+        (void) vfprintf(stderr, fmt, ap);
+        va_end(ap);
+    }
+    if (errno != 0) {
+        (void) fprintf(stderr, ": %s", strerror(errno));
+    }
+    (void) fprintf(stderr, "\n");
+
+    exit(exitcode);
+}
+
+/**
+ * @brief Parses the secret just like the server does
+ */
+static void parse_secret(const char *arg, uint8_t *secret)
+{
+    static const char colors[] = COLOR_LETTERS;
+
+    if (strlen(arg) != SLOTS) {
+        bail_out(EXIT_FAILURE, "<secret-sequence> has to be %d chars long", SLOTS);
+    }
+    for (int i = 0; i < SLOTS; ++i) {
+        const char *c = strchr(colors, arg[i]);
+        if (c == NULL || arg[i] == '\0' || c - colors >= COLORS) {
+            bail_out(EXIT_FAILURE, "Bad Color '%c' in <secret-sequence>", arg[i]);
+        }
+        secret[i] = (uint8_t)(c - colors);
+    }
+}
+
+/**
+ * @brief Returns the time in nanoseconds
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Connects to the server
+ * @return The socket, -1 on error
+ */
+static int connect_server(void)
+{
+    int optval = 1;
+    int fd = socket(server_addr.ss_family, udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+    if (server_addr.ss_family == AF_INET && !udp) {
+        (void) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof optval);
+    }
+    if (connect(fd, (struct sockaddr *)&server_addr, server_addrlen) < 0) {
+        (void) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Receives exactly n bytes
+ * @return true on success
+ */
+static bool recv_all(int fd, uint8_t *buffer, size_t n)
+{
+    size_t received = 0;
+
+    while (received < n) {
+        ssize_t r = recv(fd, &buffer[received], n - received, 0);
+        if (r <= 0) {
+            return false;
+        }
+        received += (size_t)r;
+    }
+    return true;
+}
+
+/**
+ * @brief Sends the greeting of the variant and receives its echo, nothing to do for WIRE_VERSION 1
+ * @return true on success
+ */
+static bool greet(int fd)
+{
+    uint8_t hello[WIRE_HELLO_BYTES + 1];
+
+    if (WIRE_HELLO_BYTES == 0) {
+        return true;
+    }
+    put_wire_hello(hello);
+    return send(fd, hello, WIRE_HELLO_BYTES, MSG_NOSIGNAL) == WIRE_HELLO_BYTES &&
+        recv_all(fd, hello, WIRE_HELLO_BYTES) && wire_hello_ok(hello);
+}
+
+/**
+ * @brief Plays one game on a fresh connection
+ * @return true if the game was won in the expected round
+ */
+static bool play_game(struct client *client)
+{
+    uint8_t responses[MAX_TRIES * RESPONSE_BYTES];
+    size_t received = 0;
+    int fd = connect_server();
+
+    if (fd < 0) {
+        return false;
+    }
+    if (!greet(fd)) {
+        (void) close(fd);
+        return false;
+    }
+    /* one round trip per guess, like the real client */
+    for (size_t round = 0; round < rounds; ++round) {
+        uint64_t sent = now_ns();
+
+        if (send(fd, &game_requests[REQUEST_BYTES * round], REQUEST_BYTES, MSG_NOSIGNAL) != REQUEST_BYTES) {
+            break;
+        }
+        if (!recv_all(fd, &responses[RESPONSE_BYTES * received], RESPONSE_BYTES)) {
+            break;
+        }
+        client->rtt_ns += now_ns() - sent;
+        client->rtts++;
+        received++;
+    }
+    (void) close(fd);
+    return received == rounds && RED_OF(get_response(&responses[RESPONSE_BYTES * (rounds - 1)])) == SLOTS;
+}
+
+/**
+ * @brief Plays one game as a single batch on a fresh connection
+ * @return true if the game was won in the expected round
+ */
+static bool play_batch_game(struct client *client)
+{
+    /* the greeting, the acknowledgement, the number of responses and the responses */
+    uint8_t reply[WIRE_HELLO_BYTES + RESPONSE_BYTES + 1 + MAX_TRIES * RESPONSE_BYTES];
+    const uint8_t *ack = &reply[WIRE_HELLO_BYTES];
+    size_t request_len = WIRE_HELLO_BYTES + REQUEST_BYTES + 1 + REQUEST_BYTES * rounds;
+    size_t reply_len = WIRE_HELLO_BYTES + RESPONSE_BYTES + 1 + RESPONSE_BYTES * rounds;
+    bool won = false;
+    int fd = connect_server();
+
+    if (fd < 0) {
+        return false;
+    }
+    /* the batch is sent right behind the hello, a server without the extension fails the game */
+    uint64_t sent = now_ns();
+    if (send(fd, batch_request, request_len, MSG_NOSIGNAL) == (ssize_t)request_len &&
+        recv_all(fd, reply, reply_len)) {
+        client->rtt_ns += now_ns() - sent;
+        client->rtts++;
+        won = wire_hello_ok(reply) && get_response(ack) == BATCH_ACK && ack[RESPONSE_BYTES] == rounds &&
+            RED_OF(get_response(&ack[RESPONSE_BYTES + 1 + RESPONSE_BYTES * (rounds - 1)])) == SLOTS;
+    }
+    (void) close(fd);
+    return won;
+}
+
+/**
+ * @brief Plays one game over UDP
+ * @param client The client thread
+ * @param fd Its connected UDP socket
+ * @return true if the game was won in the expected round
+ */
+static bool play_udp_game(struct client *client, int fd)
+{
+    uint8_t request[UDP_REQUEST_BYTES];
+    uint8_t response[UDP_RESPONSE_BYTES + 1];
+    uint8_t *header = &request[WIRE_HELLO_BYTES];
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    mm_response_t last = 0;
+
+    client->game_id++;
+    put_wire_hello(request);
+    for (int i = 0; i < 4; i++) {
+        header[i] = (client->game_id >> (8 * i)) & 0xff;
+    }
+    for (size_t round = 1; round <= rounds; ++round) {
+        bool answered = false;
+
+        header[4] = round & 0xff;
+        header[5] = round >> 8;
+        (void) memcpy(&request[UDP_HEADER_BYTES], &game_requests[REQUEST_BYTES * (round - 1)], REQUEST_BYTES);
+        uint64_t sent = now_ns();
+        while (!answered && !stop) {
+            if (send(fd, request, sizeof request, 0) != sizeof request) {
+                return false;
+            }
+            while (!answered && poll(&pfd, 1, UDP_TIMEOUT_MS) > 0) {
+                ssize_t r = recv(fd, response, sizeof response, 0);
+                answered = r == UDP_RESPONSE_BYTES && memcmp(response, request, UDP_HEADER_BYTES) == 0;
+            }
+            if (!answered) {
+                client->retransmissions++;
+            }
+        }
+        if (!answered) {
+            return false;
+        }
+        client->rtt_ns += now_ns() - sent;
+        client->rtts++;
+        last = get_response(&response[UDP_HEADER_BYTES]);
+    }
+    return RED_OF(last) == SLOTS;
+}
+
+/**
+ * @brief Thread start routine playing games until stop is set
+ */
+static void *run_client(void *arg)
+{
+    struct client *client = arg;
+    int fd = -1;
+
+    if (udp && (fd = connect_server()) < 0) {
+        client->errors++;
+        return arg;
+    }
+    while (!stop) {
+        bool won;
+
+        if (udp) {
+            won = play_udp_game(client, fd);
+        } else {
+            won = batched ? play_batch_game(client) : play_game(client);
+        }
+        if (won) {
+            client->games++;
+        } else if (!stop) {
+            client->errors++;
+        }
+    }
+    if (fd >= 0) {
+        (void) close(fd);
+    }
+    return arg;
+}
+
+/**
+ * @brief Parses a positive number or bails out
+ */
+static long parse_number(const char *arg, const char *name, long max)
+{
+    char *endptr;
+    long value;
+
+    errno = 0;
+    value = strtol(arg, &endptr, 10);
+    if (errno != 0 || endptr == arg || *endptr != '\0' || value < 1 || value > max) {
+        errno = 0;
+        bail_out(EXIT_FAILURE, "<%s> has to be between 1 and %ld", name, max);
+    }
+    return value;
+}
+
+/**
+ * @brief Program entry point
+ * @param argc The argument counter
+ * @param argv The argument vector
+ * @return EXIT_SUCCESS if no game went wrong, EXIT_FAILURE otherwise
+ */
+int main(int argc, char **argv)
+{
+    static struct client clients[MAX_THREADS];
+    uint8_t secret[SLOTS];
+    long nclients = 4, seconds = 5;
+    int c;
+
+    if (argc > 0) {
+        progname = argv[0];
+    }
+    while ( (c = getopt(argc, argv, "bc:d:r:u")) != -1 ) {
+        switch (c) {
+        case 'b': /* Batch-Protokoll verwenden */
+            batched = true;
+            break;
+        case 'u': /* ueber UDP spielen */
+            udp = true;
+            break;
+        case 'c': /* Anzahl der Clients */
+            nclients = parse_number(optarg, "clients", MAX_THREADS);
+            break;
+        case 'd': /* Dauer der Messung */
+            seconds = parse_number(optarg, "seconds", 3600);
+            break;
+        case 'r': /* Runden pro Spiel */
+            rounds = (size_t)parse_number(optarg, "rounds", MAX_TRIES);
+            break;
+        default:  /* ungueltiges Argument */
+            bail_out(EXIT_FAILURE, USAGE, progname);
+        }
+    }
+    if (udp && batched) {
+        bail_out(EXIT_FAILURE, USAGE, progname);
+    }
+    if (argc - optind == 2 && !udp && strncmp(argv[optind], UNIX_PREFIX, strlen(UNIX_PREFIX)) == 0) {
+        struct sockaddr_un *addr = (struct sockaddr_un *)&server_addr;
+        const char *path = argv[optind] + strlen(UNIX_PREFIX);
+
+        if (strlen(path) >= sizeof addr->sun_path) {
+            bail_out(EXIT_FAILURE, "Invalid unix domain socket path: %s", path);
+        }
+        addr->sun_family = AF_UNIX;
+        (void) strcpy(addr->sun_path, path);
+        server_addrlen = sizeof *addr;
+        parse_secret(argv[optind + 1], secret);
+    } else if (argc - optind == 3) {
+        struct addrinfo hints, *ai;
+
+        (void) memset(&hints, 0, sizeof hints);
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        int err = getaddrinfo(argv[optind], argv[optind + 1], &hints, &ai);
+        if (err != 0) {
+            bail_out(EXIT_FAILURE, "getaddrinfo: %s", gai_strerror(err));
+        }
+        (void) memcpy(&server_addr, ai->ai_addr, ai->ai_addrlen);
+        server_addrlen = ai->ai_addrlen;
+        freeaddrinfo(ai);
+        parse_secret(argv[optind + 2], secret);
+    } else {
+        bail_out(EXIT_FAILURE, USAGE, progname);
+    }
+
+    /* every wrong guess differs from the secret in the first slot */
+    for (size_t round = 0; round < rounds; ++round) {
+        uint8_t colors[SLOTS];
+        (void) memcpy(colors, secret, SLOTS);
+        if (round + 1 < rounds) {
+            colors[0] = (secret[0] + 1 + round % (COLORS - 1)) % COLORS;
+        }
+        put_request(&game_requests[REQUEST_BYTES * round], make_request(encode_code(colors)));
+    }
+    put_wire_hello(batch_request);
+    put_request(&batch_request[WIRE_HELLO_BYTES], BATCH_HELLO);
+    batch_request[WIRE_HELLO_BYTES + REQUEST_BYTES] = (uint8_t)rounds;
+    (void) memcpy(&batch_request[WIRE_HELLO_BYTES + REQUEST_BYTES + 1], game_requests, REQUEST_BYTES * rounds);
+
+    struct timespec start, end;
+    (void) clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < nclients; ++i) {
+        errno = pthread_create(&clients[i].thread, NULL, run_client, &clients[i]);
+        if (errno != 0) {
+            bail_out(EXIT_FAILURE, "pthread_create");
+        }
+    }
+    (void) sleep((unsigned int)seconds);
+    stop = true;
+
+    unsigned long games = 0, errors = 0, rtts = 0, retransmissions = 0;
+    uint64_t rtt_ns = 0;
+    for (long i = 0; i < nclients; ++i) {
+        (void) pthread_join(clients[i].thread, NULL);
+        games += clients[i].games;
+        errors += clients[i].errors;
+        rtt_ns += clients[i].rtt_ns;
+        rtts += clients[i].rtts;
+        retransmissions += clients[i].retransmissions;
+    }
+    (void) clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    (void) printf("%lu games, %lu errors in %.2f s: %.0f games/s, %.0f rounds/s\n",
+        games, errors, elapsed, games / elapsed, games * rounds / elapsed);
+    if (rtts > 0) {
+        (void) printf("mean round trip: %.1f us\n", rtt_ns / 1e3 / rtts);
+    }
+    if (udp) {
+        (void) printf("retransmissions: %lu\n", retransmissions);
+    }
+
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
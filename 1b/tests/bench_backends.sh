@@ -0,0 +1,26 @@
+#!/bin/sh
+# Runs the throughput benchmark against the server with the epoll and with the io_uring event loop.
+# Usage: tests/bench_backends.sh [threads] [clients] [seconds] [bench options...]
+
+THREADS=${1:-1}
+CLIENTS=${2:-16}
+SECONDS_PER_RUN=${3:-5}
+[ $# -gt 3 ] && shift 3 || shift $#
+PORT=${PORT:-12345}
+SECRET=rgbvw
+
+cd "$(dirname "$0")/.." || exit 1
+
+for backend in epoll io_uring; do
+    if [ "$backend" = io_uring ]; then
+        build/server --io-uring --threads "$THREADS" "$PORT" "$SECRET" &
+    else
+        build/server --threads "$THREADS" "$PORT" "$SECRET" &
+    fi
+    pid=$!
+    sleep 0.2
+    printf '%-8s: ' "$backend"
+    tests/bench -c "$CLIENTS" -d "$SECONDS_PER_RUN" "$@" localhost "$PORT" "$SECRET"
+    kill -INT "$pid"
+    wait "$pid"
+done
@@ -0,0 +1,23 @@
+#!/bin/sh
+# Runs the throughput benchmark against the server with 1 up to N event loop threads.
+# Usage: tests/bench_threads.sh [max-threads] [clients] [seconds]
+
+MAX_THREADS=${1:-$(nproc)}
+CLIENTS=${2:-16}
+SECONDS_PER_RUN=${3:-5}
+PORT=${PORT:-12345}
+SECRET=rgbvw
+
+cd "$(dirname "$0")/.." || exit 1
+
+threads=1
+while [ "$threads" -le "$MAX_THREADS" ]; do
+    build/server --threads "$threads" "$PORT" "$SECRET" &
+    pid=$!
+    sleep 0.2
+    printf '%2d threads: ' "$threads"
+    tests/bench -c "$CLIENTS" -d "$SECONDS_PER_RUN" localhost "$PORT" "$SECRET"
+    kill -INT "$pid"
+    wait "$pid"
+    threads=$((threads * 2))
+done
@@ -0,0 +1,700 @@
+/**
+ * @file loadgen.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Load generator for a mastermind server in multi-client mode.
+ * @details Every thread keeps its share of the connections busy with an epoll loop on non-blocking sockets,
+ * so a few threads drive thousands of concurrent games. A game is one connection: the generator connects,
+ * plays until the game is over and waits for the server to close, so the TIME_WAIT state stays on the
+ * server's side.
+ *
+ * Workloads (-w):
+ * - solver: plays like the client, always guessing the first secret consistent with all responses so far.
+ *   The guesses only depend on the responses, so the whole decision tree is built once at the start and a
+ *   round costs one lookup; the server may use any secrets.
+ * - random: random guesses with a valid parity until the game is over, mostly MAX_TRIES rounds.
+ *
+ * Without -R every connection starts its next game right away (closed loop). With -R the games are started
+ * at the given total rate (open loop) as long as there are free connections; starts which could not keep
+ * the schedule are reported as missed.
+ *
+ * At the end the throughput and the percentiles of the round latency, from sending a guess to receiving
+ * its response, are printed. The latency histogram has 32 linear buckets per power of two, so the
+ * percentiles are upper bounds at most about 3% too high.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "../src/mastermind.h"
+
+/* === Constants === */
+
+/** @brief Most possible secrets the solver builds its decision tree for */
+#define MAX_SOLVER_CODES (1 << 16)
+/** @brief Number of possible marks, red in the low MARK_WIDTH bits and white in the next MARK_WIDTH */
+#define MARKS (1 << (2 * MARK_WIDTH))
+
+#define MAX_THREADS (64)
+#define MAX_CONNECTIONS (100000)
+#define MAX_EVENTS (256)
+
+/** @brief Latency histogram: HIST_SUB linear buckets per power of two */
+#define HIST_SUB_BITS (5)
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+/** @brief An open-loop schedule which falls behind further than this gives up the missed starts */
+#define MAX_LAG_NS (1000000000ULL)
+
+#define USAGE "Usage: %s [-w solver|random] [-c <connections>] [-t <threads>] [-d <seconds>] [-R <games/s>] " \
+    "<server-hostname> <server-port> | unix:<path>"
+
+#define UNIX_PREFIX "unix:"
+
+
+/* === Type Definitions === */
+
+/** @brief The workloads */
+enum workload {
+    WORKLOAD_SOLVER,
+    WORKLOAD_RANDOM,
+};
+
+/** @brief A position of the solver: its guess and the positions after every possible response */
+struct node {
+    mm_code_t guess;            /**< the secret guessed in this position */
+    int32_t child[MARKS];       /**< index of the next position by the marks of the response, -1 if impossible */
+};
+
+/** @brief The states of a connection */
+enum conn_state {
+    CONN_IDLE,                  /**< no game */
+    CONN_CONNECTING,            /**< waiting for the connection */
+    CONN_PLAYING,               /**< waiting for a response */
+    CONN_DRAINING,              /**< the game is over, waiting for the server to close */
+};
+
+/** @brief A connection playing one game after the other */
+struct conn {
+    int fd;
+    enum conn_state state;
+    int32_t node;               /**< position of the solver */
+    int round;                  /**< rounds played in the current game */
+    uint64_t sent;              /**< time the last guess was sent */
+    uint8_t in[WIRE_HELLO_BYTES + RESPONSE_BYTES];  /**< the response received so far */
+    size_t in_len;
+};
+
+/** @brief The state of one generator thread */
+struct worker {
+    pthread_t thread;
+    struct conn *conns;
+    size_t nconns;
+    size_t *idle;               /**< indices of the idle connections */
+    size_t nidle;
+    uint64_t rng;               /**< state of the random guesses */
+    unsigned long games;        /**< games over */
+    unsigned long won;
+    unsigned long lost;
+    unsigned long errors;       /**< games which failed: connection errors or unexpected responses */
+    unsigned long rounds;
+    unsigned long missed;       /**< starts the open-loop schedule had to give up */
+    uint64_t hist[HIST_BUCKETS];    /**< round latencies */
+};
+
+
+/* === Global Variables === */
+
+/* Name of the program with default value */
+static const char *progname = "loadgen";
+
+/* The address of the server */
+static struct sockaddr_storage server_addr;
+static socklen_t server_addrlen;
+
+/* The workload */
+static enum workload workload = WORKLOAD_SOLVER;
+
+/* The decision tree of the solver, the root is node 0 */
+static struct node *nodes;
+static size_t nodes_size;
+static size_t nodes_used;
+
+/* Nanoseconds between the starts of one thread, 0 for a closed loop */
+static uint64_t start_interval;
+
+/* Set by the main thread once the time is up */
+static volatile bool stop = false;
+
+
+/* === Implementations === */
+
+/**
+ * @brief terminate program on program error
+ * @param exitcode exit code
+ * @param fmt format string
+ */
+static void bail_out(int exitcode, const char *fmt, ...)
+{
+    va_list ap;
+
+    (void) fprintf(stderr, "%s: ", progname);
+    if (fmt != NULL) {
+        va_start(ap, fmt);
+        (void) vfprintf(stderr, fmt, ap);
+        va_end(ap);
+    }
+    if (errno != 0) {
+        (void) fprintf(stderr, ": %s", strerror(errno));
+    }
+    (void) fprintf(stderr, "\n");
+
+    exit(exitcode);
+}
+
+/**
+ * @brief Returns the time in nanoseconds
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Builds the position of the solver for the secrets still possible
+ * @param candidates The possible secrets in ascending order, at least one
+ * @param n Their number
+ * @return Index of the new node
+ */
+static int32_t build_node(const mm_code_t *candidates, size_t n)
+{
+    size_t counts[MARKS] = {0}, starts[MARKS];
+    mm_code_t *sorted;
+    uint8_t *mark;
+    int32_t index;
+
+    if (nodes_used == nodes_size) {
+        nodes_size = (nodes_size == 0) ? 4096 : 2 * nodes_size;
+        if ( (nodes = realloc(nodes, nodes_size * sizeof *nodes)) == NULL) {
+            bail_out(EXIT_FAILURE, "realloc");
+        }
+    }
+    index = (int32_t)nodes_used++;
+    nodes[index].guess = candidates[0];     /* the first possible secret, like the client */
+    for (int m = 0; m < MARKS; ++m) {
+        nodes[index].child[m] = -1;
+    }
+
+    /* split the candidates by their marks against the guess, keeping their order */
+    if ( (sorted = malloc(n * sizeof *sorted)) == NULL || (mark = malloc(n)) == NULL) {
+        bail_out(EXIT_FAILURE, "malloc");
+    }
+    for (size_t i = 0; i < n; ++i) {
+        mark[i] = (uint8_t)mm_marks(candidates[0], candidates[i]);
+        counts[mark[i]]++;
+    }
+    starts[0] = 0;
+    for (int m = 1; m < MARKS; ++m) {
+        starts[m] = starts[m - 1] + counts[m - 1];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        sorted[starts[mark[i]]++] = candidates[i];
+    }
+    free(mark);
+
+    size_t begin = 0;
+    for (int m = 0; m < MARKS; ++m) {
+        /* SLOTS red marks win, there is nothing to follow */
+        if (counts[m] > 0 && RED_OF(m) != SLOTS) {
+            int32_t child = build_node(&sorted[begin], counts[m]);
+            nodes[index].child[m] = child;
+        }
+        begin += counts[m];
+    }
+    free(sorted);
+    return index;
+}
+
+/**
+ * @brief Builds the decision tree of the solver
+ */
+static void build_tree(void)
+{
+    static mm_code_t all[MAX_SOLVER_CODES];
+    uint8_t colors[SLOTS] = {0};
+    size_t n = 0;
+
+    /* all secrets in ascending order, counting in base COLORS from the first slot, the lowest bits */
+    for (int j = 0; j < SLOTS; ) {
+        if (n == MAX_SOLVER_CODES) {
+            errno = 0;
+            bail_out(EXIT_FAILURE, "%d slots of %d colors are too many secrets for the solver workload",
+                SLOTS, COLORS);
+        }
+        all[n++] = encode_code(colors);
+        for (j = 0; j < SLOTS && ++colors[j] == COLORS; ++j) {
+            colors[j] = 0;
+        }
+    }
+    (void) build_node(all, n);
+}
+
+/**
+ * @brief Returns the next random number of a thread (xorshift64*)
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545f4914f6cdd1dULL;
+}
+
+/**
+ * @brief Index of the histogram bucket of a latency
+ */
+static unsigned int hist_index(uint64_t ns)
+{
+    if (ns < HIST_SUB) {
+        return (unsigned int)ns;
+    }
+    unsigned int e = 63 - (unsigned int)__builtin_clzll(ns);
+    return (e - HIST_SUB_BITS + 1) * HIST_SUB + (unsigned int)((ns >> (e - HIST_SUB_BITS)) & (HIST_SUB - 1));
+}
+
+/**
+ * @brief Largest latency of a histogram bucket
+ */
+static uint64_t hist_value(unsigned int index)
+{
+    if (index < HIST_SUB) {
+        return index;
+    }
+    unsigned int e = index / HIST_SUB + HIST_SUB_BITS - 1;
+    return ((uint64_t)(HIST_SUB + index % HIST_SUB + 1) << (e - HIST_SUB_BITS)) - 1;
+}
+
+/**
+ * @brief Returns the latency below which the given fraction of the rounds lies
+ */
+static uint64_t percentile(const uint64_t *hist, uint64_t total, double fraction)
+{
+    uint64_t seen = 0;
+
+    for (unsigned int i = 0; i < HIST_BUCKETS; ++i) {
+        seen += hist[i];
+        if (seen > 0 && seen >= fraction * total) {
+            return hist_value(i);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Closes the connection of a game and makes it idle
+ */
+static void finish_conn(struct worker *worker, struct conn *conn)
+{
+    (void) close(conn->fd);     /* also removes it from the epoll set */
+    conn->fd = -1;
+    conn->state = CONN_IDLE;
+    worker->idle[worker->nidle++] = (size_t)(conn - worker->conns);
+}
+
+/**
+ * @brief Ends a game which went wrong
+ */
+static void fail_game(struct worker *worker, struct conn *conn)
+{
+    worker->errors++;
+    worker->games++;
+    finish_conn(worker, conn);
+}
+
+/**
+ * @brief Sends the next guess of a game
+ * @return 0 on success, -1 if the connection failed
+ */
+static int send_guess(struct worker *worker, struct conn *conn)
+{
+    mm_code_t code = 0;
+    uint8_t request[WIRE_HELLO_BYTES + REQUEST_BYTES];
+    size_t len = 0;
+
+    if (workload == WORKLOAD_SOLVER) {
+        code = nodes[conn->node].guess;
+    } else {
+        uint64_t r = next_random(&worker->rng);
+
+        for (int j = 0; j < SLOTS; ++j) {
+            code |= (mm_code_t)(r % COLORS) << (j * SHIFT_WIDTH);
+            r /= COLORS;
+        }
+    }
+    /* the greeting goes in front of the first guess */
+    if (conn->round == 0) {
+        put_wire_hello(request);
+        len = WIRE_HELLO_BYTES;
+    }
+    put_request(&request[len], make_request(code));
+    len += REQUEST_BYTES;
+    conn->in_len = 0;
+    conn->sent = now_ns();
+    /* a request always fits into the empty send buffer of a connection waiting for its response */
+    if (send(conn->fd, request, len, MSG_NOSIGNAL) != (ssize_t)len) {
+        return -1;
+    }
+    conn->round++;
+    return 0;
+}
+
+/**
+ * @brief Starts a game on an idle connection
+ */
+static void start_game(struct worker *worker, int epfd, struct conn *conn)
+{
+    struct epoll_event ev;
+    int optval = 1;
+
+    conn->node = 0;
+    conn->round = 0;
+    conn->fd = socket(server_addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (conn->fd < 0) {
+        worker->errors++;
+        worker->idle[worker->nidle++] = (size_t)(conn - worker->conns);
+        return;
+    }
+    if (server_addr.ss_family == AF_INET) {
+        (void) setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof optval);
+    }
+    ev.data.ptr = conn;
+    if (connect(conn->fd, (struct sockaddr *)&server_addr, server_addrlen) == 0) {
+        conn->state = CONN_PLAYING;
+        ev.events = EPOLLIN;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, conn->fd, &ev) < 0 || send_guess(worker, conn) < 0) {
+            fail_game(worker, conn);
+        }
+    } else if (errno == EINPROGRESS) {
+        conn->state = CONN_CONNECTING;
+        ev.events = EPOLLOUT;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, conn->fd, &ev) < 0) {
+            fail_game(worker, conn);
+        }
+    } else {
+        fail_game(worker, conn);
+    }
+}
+
+/**
+ * @brief Handles an event of a connection
+ */
+static void handle_conn(struct worker *worker, int epfd, struct conn *conn, uint32_t events)
+{
+    uint8_t buffer[16];
+    size_t expected = (conn->round == 1 ? WIRE_HELLO_BYTES : 0) + RESPONSE_BYTES;
+    ssize_t r;
+
+    if (conn->state == CONN_CONNECTING) {
+        struct epoll_event ev;
+        int error = 0;
+        socklen_t len = sizeof error;
+
+        if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0) {
+            fail_game(worker, conn);
+            return;
+        }
+        conn->state = CONN_PLAYING;
+        ev.events = EPOLLIN;
+        ev.data.ptr = conn;
+        if (epoll_ctl(epfd, EPOLL_CTL_MOD, conn->fd, &ev) < 0 || send_guess(worker, conn) < 0) {
+            fail_game(worker, conn);
+        }
+        return;
+    }
+
+    if (conn->state == CONN_DRAINING) {
+        r = recv(conn->fd, buffer, sizeof buffer, 0);
+        if (r <= 0 && !(r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))) {
+            finish_conn(worker, conn);  /* the server closed, the game is done */
+        }
+        return;
+    }
+    r = recv(conn->fd, &conn->in[conn->in_len], expected - conn->in_len, 0);
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return;
+    }
+    if (r <= 0) {
+        fail_game(worker, conn);    /* closed early */
+        return;
+    }
+    conn->in_len += (size_t)r;
+    if (conn->in_len < expected) {
+        return;
+    }
+    if (expected > RESPONSE_BYTES && !wire_hello_ok(conn->in)) {
+        fail_game(worker, conn);    /* a server of another variant */
+        return;
+    }
+
+    mm_response_t response = get_response(&conn->in[expected - RESPONSE_BYTES]);
+    uint64_t latency = now_ns() - conn->sent;
+    worker->hist[hist_index(latency)]++;
+    worker->rounds++;
+
+    if (response & (1 << PARITY_ERR_BIT)) {
+        fail_game(worker, conn);
+        return;
+    }
+    if (RED_OF(response) == SLOTS || (response & (1 << GAME_LOST_ERR_BIT))) {
+        if (RED_OF(response) == SLOTS) {
+            worker->won++;
+        } else {
+            worker->lost++;
+        }
+        worker->games++;
+        conn->state = CONN_DRAINING;
+        return;
+    }
+    if (workload == WORKLOAD_SOLVER) {
+        conn->node = nodes[conn->node].child[response & (MARKS - 1)];
+        if (conn->node < 0) {
+            fail_game(worker, conn);    /* no secret gives these responses */
+            return;
+        }
+    }
+    if (send_guess(worker, conn) < 0) {
+        fail_game(worker, conn);
+    }
+}
+
+/**
+ * @brief Thread start routine of a worker
+ */
+static void *run_worker(void *arg)
+{
+    struct worker *worker = arg;
+    struct epoll_event events[MAX_EVENTS];
+    uint64_t next_start = now_ns();
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (epfd < 0) {
+        worker->errors++;
+        return arg;
+    }
+    while (!stop) {
+        uint64_t now = now_ns();
+        int timeout = 100;
+
+        if (start_interval == 0) {
+            /* closed loop: every idle connection starts its next game, failed ones a bit later */
+            size_t n = worker->nidle;
+            worker->nidle = 0;
+            for (size_t i = 0; i < n && !stop; ++i) {
+                start_game(worker, epfd, &worker->conns[worker->idle[i]]);
+            }
+            if (worker->nidle > 0) {
+                timeout = 1;
+            }
+        } else {
+            if (now > next_start + MAX_LAG_NS) {
+                worker->missed += (now - next_start) / start_interval;
+                next_start = now;
+            }
+            while (next_start <= now && worker->nidle > 0) {
+                start_game(worker, epfd, &worker->conns[worker->idle[--worker->nidle]]);
+                next_start += start_interval;
+            }
+            if (worker->nidle > 0) {
+                timeout = (next_start > now) ? (int)((next_start - now + 999999) / 1000000) : 0;
+            }
+        }
+
+        int n = epoll_wait(epfd, events, MAX_EVENTS, timeout);
+        for (int i = 0; i < n; ++i) {
+            handle_conn(worker, epfd, events[i].data.ptr, events[i].events);
+        }
+    }
+    for (size_t i = 0; i < worker->nconns; ++i) {
+        if (worker->conns[i].fd >= 0) {
+            (void) close(worker->conns[i].fd);
+        }
+    }
+    (void) close(epfd);
+    return arg;
+}
+
+/**
+ * @brief Parses a positive number
+ */
+static long parse_number(const char *arg, const char *name, long max)
+{
+    char *endptr;
+    long value;
+
+    errno = 0;
+    value = strtol(arg, &endptr, 10);
+    if (errno != 0 || endptr == arg || *endptr != '\0' || value < 1 || value > max) {
+        errno = 0;
+        bail_out(EXIT_FAILURE, "<%s> has to be between 1 and %ld", name, max);
+    }
+    return value;
+}
+
+/**
+ * @brief Program entry point
+ * @param argc The argument counter
+ * @param argv The argument vector
+ * @return EXIT_SUCCESS if no game failed, EXIT_FAILURE otherwise
+ */
+int main(int argc, char **argv)
+{
+    static struct worker workers[MAX_THREADS];
+    long nconns = 64, nthreads = 1, seconds = 5, rate = 0;
+    int c;
+
+    if (argc > 0) {
+        progname = argv[0];
+    }
+    while ( (c = getopt(argc, argv, "w:c:t:d:R:")) != -1 ) {
+        switch (c) {
+        case 'w': /* Art der Last */
+            if (strcmp(optarg, "solver") == 0) {
+                workload = WORKLOAD_SOLVER;
+            } else if (strcmp(optarg, "random") == 0) {
+                workload = WORKLOAD_RANDOM;
+            } else {
+                bail_out(EXIT_FAILURE, USAGE, progname);
+            }
+            break;
+        case 'c': /* Anzahl der gleichzeitigen Verbindungen */
+            nconns = parse_number(optarg, "connections", MAX_CONNECTIONS);
+            break;
+        case 't': /* Anzahl der Threads */
+            nthreads = parse_number(optarg, "threads", MAX_THREADS);
+            break;
+        case 'd': /* Dauer der Messung */
+            seconds = parse_number(optarg, "seconds", 3600);
+            break;
+        case 'R': /* angestrebte Spiele pro Sekunde */
+            rate = parse_number(optarg, "games/s", 100000000);
+            break;
+        default:  /* ungueltiges Argument */
+            bail_out(EXIT_FAILURE, USAGE, progname);
+        }
+    }
+    if (argc - optind == 1 && strncmp(argv[optind], UNIX_PREFIX, strlen(UNIX_PREFIX)) == 0) {
+        struct sockaddr_un *addr = (struct sockaddr_un *)&server_addr;
+        const char *path = argv[optind] + strlen(UNIX_PREFIX);
+
+        if (strlen(path) >= sizeof addr->sun_path) {
+            bail_out(EXIT_FAILURE, "Invalid unix domain socket path: %s", path);
+        }
+        addr->sun_family = AF_UNIX;
+        (void) strcpy(addr->sun_path, path);
+        server_addrlen = sizeof *addr;
+    } else if (argc - optind == 2) {
+        struct addrinfo hints, *ai;
+
+        (void) memset(&hints, 0, sizeof hints);
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        int err = getaddrinfo(argv[optind], argv[optind + 1], &hints, &ai);
+        if (err != 0) {
+            bail_out(EXIT_FAILURE, "getaddrinfo: %s", gai_strerror(err));
+        }
+        (void) memcpy(&server_addr, ai->ai_addr, ai->ai_addrlen);
+        server_addrlen = ai->ai_addrlen;
+        freeaddrinfo(ai);
+    } else {
+        bail_out(EXIT_FAILURE, USAGE, progname);
+    }
+    if (nthreads > nconns) {
+        nthreads = nconns;
+    }
+    if (workload == WORKLOAD_SOLVER) {
+        build_tree();
+    }
+    start_interval = (rate > 0) ? (uint64_t)(1e9 * nthreads / rate) : 0;
+    if (rate > 0 && start_interval == 0) {
+        start_interval = 1;
+    }
+
+    struct timespec start, end;
+    (void) clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < nthreads; ++i) {
+        struct worker *worker = &workers[i];
+
+        worker->nconns = (size_t)(nconns / nthreads + (i < nconns % nthreads));
+        worker->conns = calloc(worker->nconns, sizeof *worker->conns);
+        worker->idle = calloc(worker->nconns, sizeof *worker->idle);
+        if (worker->conns == NULL || worker->idle == NULL) {
+            bail_out(EXIT_FAILURE, "calloc");
+        }
+        for (size_t j = 0; j < worker->nconns; ++j) {
+            worker->conns[j].fd = -1;
+            worker->idle[j] = worker->nconns - 1 - j;
+        }
+        worker->nidle = worker->nconns;
+        worker->rng = 0x9e3779b97f4a7c15ULL * (uint64_t)(i + 1) ^ (uint64_t)now_ns();
+        errno = pthread_create(&worker->thread, NULL, run_worker, worker);
+        if (errno != 0) {
+            bail_out(EXIT_FAILURE, "pthread_create");
+        }
+    }
+    (void) sleep((unsigned int)seconds);
+    stop = true;
+
+    static uint64_t hist[HIST_BUCKETS];
+    unsigned long games = 0, won = 0, lost = 0, errors = 0, rounds = 0, missed = 0;
+    for (long i = 0; i < nthreads; ++i) {
+        (void) pthread_join(workers[i].thread, NULL);
+        games += workers[i].games;
+        won += workers[i].won;
+        lost += workers[i].lost;
+        errors += workers[i].errors;
+        rounds += workers[i].rounds;
+        missed += workers[i].missed;
+        for (unsigned int b = 0; b < HIST_BUCKETS; ++b) {
+            hist[b] += workers[i].hist[b];
+        }
+        free(workers[i].conns);
+        free(workers[i].idle);
+    }
+    (void) clock_gettime(CLOCK_MONOTONIC, &end);
+    free(nodes);
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    (void) printf("%lu games (%lu won, %lu lost, %lu errors) in %.2f s: %.0f games/s, %.0f rounds/s\n",
+        games, won, lost, errors, elapsed, games / elapsed, rounds / elapsed);
+    if (rate > 0) {
+        (void) printf("target %ld games/s, %lu starts missed\n", rate, missed);
+    }
+    if (rounds > 0) {
+        (void) printf("%.2f rounds per game, round latency p50 %.1f us, p99 %.1f us, p999 %.1f us, max %.1f us\n",
+            games > 0 ? (double)rounds / games : 0.0,
+            percentile(hist, rounds, 0.5) / 1e3, percentile(hist, rounds, 0.99) / 1e3,
+            percentile(hist, rounds, 0.999) / 1e3, percentile(hist, rounds, 1.0) / 1e3);
+    }
+
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file marks_test.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Checks every kernel of the marks module against compute_answer of the server.
+ * @details The codes are every code of the variant, or TEST_CODES pseudo random ones if it has more. Each
+ * kernel the processor has computes the marks of TEST_GUESSES guesses against all of them, which have to be
+ * exactly the marks compute_answer gives. Then it filters the codes in place for the marks of one of them,
+ * with a count that is not a multiple of the vector width, and has to keep exactly the codes compute_answer
+ * agrees with, in their order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <errno.h>
+#include "../src/mastermind.h"
+#include "../src/marks.h"
+#include "../src/game.h"
+
+/* === Constants === */
+
+/** @brief Most codes tested */
+#define TEST_CODES (1 << 16)
+
+/** @brief Guesses tested with each kernel */
+#define TEST_GUESSES (200)
+
+
+/* === Global Variables === */
+
+/* Name of the program with default value */
+static const char *progname = "marks_test";
+
+/* State of the pseudo random numbers */
+static uint64_t random_state = 0x9e3779b97f4a7c15ULL;
+
+
+/* === Implementations === */
+
+/**
+ * @brief terminate program on program error
+ * @param exitcode exit code
+ * @param fmt format string
+ */
+static void bail_out(int exitcode, const char *fmt, ...)
+{
+    va_list ap;
+
+    (void) fprintf(stderr, "%s: ", progname);
+    if (fmt != NULL) {
+        va_start(ap, fmt);
+        (void) vfprintf(stderr, fmt, ap);
+        va_end(ap);
+    }
+    if (errno != 0) {
+        (void) fprintf(stderr, ": %s", strerror(errno));
+    }
+    (void) fprintf(stderr, "\n");
+
+    exit(exitcode);
+}
+
+/**
+ * @brief Returns the next pseudo random number (xorshift64)
+ */
+static uint64_t next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+/**
+ * @brief Copies code i out of the lanes
+ */
+static void get_code(const uint8_t *lanes, size_t stride, size_t i, uint8_t *colors)
+{
+    for (int slot = 0; slot < SLOTS; slot++) {
+        colors[slot] = lanes[slot * stride + i];
+    }
+}
+
+/**
+ * @brief Returns the response of the server to a guess for a secret
+ */
+static mm_response_t answer(const uint8_t *guess, const uint8_t *secret)
+{
+    mm_response_t resp;
+
+    (void) compute_answer(make_request(encode_code(guess)), &resp, secret);
+    return resp;
+}
+
+/**
+ * @brief Checks the kernel in use
+ * @return The number of marks compared
+ */
+static unsigned long check_kernel(const uint8_t *lanes, uint8_t *scratch, size_t stride, size_t n,
+    const char *name)
+{
+    uint8_t *red = malloc(n), *white = malloc(n);
+    unsigned long compared = 0;
+
+    if (red == NULL || white == NULL) {
+        bail_out(EXIT_FAILURE, "malloc");
+    }
+    for (int g = 0; g < TEST_GUESSES; g++) {
+        uint8_t guess_colors[SLOTS], code[SLOTS];
+        struct marks_guess guess;
+        size_t count, kept, k = 0;
+        mm_response_t wanted;
+
+        /* the first and the last code, then random ones */
+        get_code(lanes, stride, g == 0 ? 0 : g == 1 ? n - 1 : next_random() % n, guess_colors);
+        prepare_guess(&guess, guess_colors);
+
+        compute_marks(&guess, lanes, stride, n, red, white);
+        for (size_t i = 0; i < n; i++) {
+            mm_response_t resp;
+
+            get_code(lanes, stride, i, code);
+            resp = answer(guess_colors, code);
+            if (red[i] != RED_OF(resp) || white[i] != WHITE_OF(resp)) {
+                errno = 0;
+                bail_out(EXIT_FAILURE, "%s: guess %d, code %zu: %u red %u white, compute_answer %u red %u white",
+                    name, g, i, red[i], white[i], RED_OF(resp), WHITE_OF(resp));
+            }
+            compared++;
+        }
+
+        /* filtering in place, for the marks of some code, and a count with a partial last block */
+        count = n - (size_t)g % (n < MARKS_BLOCK ? n : MARKS_BLOCK);
+        get_code(lanes, stride, next_random() % count, code);
+        wanted = answer(guess_colors, code);
+        (void) memcpy(scratch, lanes, SLOTS * stride);
+        kept = filter_codes(&guess, scratch, scratch, stride, count, RED_OF(wanted), WHITE_OF(wanted));
+        for (size_t i = 0; i < count; i++) {
+            get_code(lanes, stride, i, code);
+            if (answer(guess_colors, code) != wanted) {
+                continue;
+            }
+            for (int slot = 0; slot < SLOTS; slot++) {
+                if (k >= kept || scratch[slot * stride + k] != code[slot]) {
+                    errno = 0;
+                    bail_out(EXIT_FAILURE, "%s: guess %d: code %zu kept wrong or not at all", name, g, i);
+                }
+            }
+            k++;
+        }
+        if (k != kept) {
+            errno = 0;
+            bail_out(EXIT_FAILURE, "%s: guess %d: kept %zu codes, compute_answer agrees with %zu", name, g, kept, k);
+        }
+    }
+    free(red);
+    free(white);
+    return compared;
+}
+
+/**
+ * @brief Program entry point
+ * @param argc The argument counter
+ * @param argv The argument vector
+ * @return EXIT_SUCCESS if every kernel agrees with compute_answer, EXIT_FAILURE otherwise
+ */
+int main(int argc, char **argv)
+{
+    size_t total = 1, n, stride;
+    uint8_t *lanes, *scratch;
+
+    if (argc > 0) {
+        progname = argv[0];
+    }
+    if (argc != 1) {
+        errno = 0;
+        bail_out(EXIT_FAILURE, "Usage: %s", progname);
+    }
+    for (int slot = 0; slot < SLOTS && total <= TEST_CODES; slot++) {
+        total *= COLORS;
+    }
+    n = (total <= TEST_CODES) ? total : TEST_CODES;
+    stride = marks_stride(n);
+    if ( (lanes = calloc(SLOTS * stride, 1)) == NULL || (scratch = calloc(SLOTS * stride, 1)) == NULL) {
+        bail_out(EXIT_FAILURE, "calloc");
+    }
+    for (size_t i = 0; i < n; i++) {
+        uint64_t rest = (total <= TEST_CODES) ? i : next_random();
+
+        for (int slot = 0; slot < SLOTS; slot++) {
+            lanes[slot * stride + i] = (uint8_t)(rest % COLORS);
+            rest /= COLORS;
+        }
+    }
+
+    for (int kernel = 0; kernel < MARKS_KERNELS; kernel++) {
+        const char *name = marks_kernel_name((enum marks_kernel)kernel);
+
+        if (select_marks_kernel((enum marks_kernel)kernel) < 0) {
+            (void) printf("%s: not available, skipped\n", name);
+            continue;
+        }
+        (void) printf("%s: %lu marks of %d slots and %d colors agree with compute_answer\n", name,
+            check_kernel(lanes, scratch, stride, n, name), SLOTS, COLORS);
+    }
+    free(lanes);
+    free(scratch);
+    return EXIT_SUCCESS;
+}
@@ -15,6 +15,7 @@
 #include <errno.h>
 #include <limits.h>
 #include <time.h>
+#include "../src/mastermind.h"
 
 #ifdef _ENDEBUG
 #define DEBUG(...) do { fprintf(stderr, __VA_ARGS__); } while(0)
@@ -22,12 +23,6 @@
 #define DEBUG(...)
 #endif
 
-#define SLOTS (5)
-#define COLORS (8)
-
-/* the possible colors in the game */
-enum colors {beige = 0, darkblue, green, orange, red, black, violet, white};
-
 /* Port number */
 static const char *PORT = "1234";
 
@@ -70,33 +65,7 @@ static void bail_out(int exitcode, const char *fmt, ...)
 static void print_colors(uint8_t *colors, char *dest) 
 {
 	for (int i=0; i < SLOTS; i++) {
-		switch (colors[i])
-		{
-			case beige: 
-				dest[i] = 'b';
-				break;
-			case darkblue: 
-				dest[i] = 'd';
-				break;
-			case green: 
-				dest[i] = 'g';
-				break;
-			case orange: 
-				dest[i] = 'o';
-				break;
-			case red: 
-				dest[i] = 'r';
-				break;
-			case black: 
-				dest[i] = 's';
-				break;
-			case violet: 
-				dest[i] = 'v';
-				break;
-			case white: 
-				dest[i] = 'w';
-				break;
-		}
+		dest[i] = COLOR_LETTERS[colors[i]];
 	}
 	dest[SLOTS] = '\0';
 }
@@ -116,7 +85,7 @@ static int runTest(int testno)
 	uint8_t colors[SLOTS];
 	srand(5*time(NULL) + 111*testno);
 	for (int i=0; i < SLOTS; i++) {
-		colors[i] = (rand() >> 5*i) % COLORS;
+		colors[i] = (rand() >> 5 * (i % 5)) % COLORS;
 	}
 	
 	char secret[SLOTS + 1];
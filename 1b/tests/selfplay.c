@@ -0,0 +1,297 @@
+/**
+ * @file selfplay.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Plays the solver of the client against the server within one process.
+ * @details A server thread plays the games with the session module of the multi-client server, the main
+ * thread guesses with the solver of the client, and the two are connected by the in-process transport (see
+ * transport.h) instead of sockets. Every game has a pseudo random secret, as with the --seed option of the
+ * server. Without the network and the system calls in the way, the time per game is that of the game
+ * logic: mostly the solver, plus the session parsing the requests and computing the answers.
+ *
+ * With -k the solver uses the given kernel of the marks module (see marks.h) instead of the fastest one.
+ *
+ * At the end the throughput, the mean time per game and the mean rounds per game are printed, together
+ * with the results as counted by the server.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include "../src/mastermind.h"
+#include "../src/solver.h"
+#include "../src/marks.h"
+#include "../src/transport.h"
+#include "../src/session.h"
+#include "../src/secrets.h"
+#include "../src/answers.h"
+
+/* === Constants === */
+
+#define USAGE "Usage: %s [-g <games>] [-s <seed>] [-k scalar|sse2|avx2]"
+
+
+/* === Type Definitions === */
+
+/** @brief The server thread */
+struct server {
+    pthread_t thread;
+    struct inproc_transport transport;  /**< its end of the channel */
+    struct secret_source secrets;       /**< the secrets of its games */
+    struct game_stats stats;            /**< results of the games played */
+};
+
+
+/* === Global Variables === */
+
+/* Name of the program with default value */
+static const char *progname = "selfplay";
+
+
+/* === Implementations === */
+
+/**
+ * @brief terminate program on program error
+ * @param exitcode exit code
+ * @param fmt format string
+ */
+static void bail_out(int exitcode, const char *fmt, ...)
+{
+    va_list ap;
+
+    (void) fprintf(stderr, "%s: ", progname);
+    if (fmt != NULL) {
+        va_start(ap, fmt);
+        (void) vfprintf(stderr, fmt, ap);
+        va_end(ap);
+    }
+    if (errno != 0) {
+        (void) fprintf(stderr, ": %s", strerror(errno));
+    }
+    (void) fprintf(stderr, "\n");
+
+    exit(exitcode);
+}
+
+/**
+ * @brief Returns the time in nanoseconds
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Thread start routine of the server, plays games until the client closes its end
+ */
+static void *run_server(void *arg)
+{
+    struct server *server = arg;
+    struct transport *transport = &server->transport.transport;
+    struct answer_cache *answers = create_answer_cache();   /* as in the loops, fine without */
+    struct secret_picker picker;
+    struct session_context sessions;
+    struct session session;
+    uint8_t buffer[INPROC_RING_BYTES];
+    uint8_t secret[SLOTS];
+
+    init_picker(&picker, &server->secrets, 0);
+    init_session_context(&sessions, NULL, 0);
+    for (;;) {
+        ssize_t r = 0;
+
+        next_secret(&picker, secret);
+        start_session(&session, &sessions, -1, secret, 0);
+        if (answers != NULL) {
+            session.game.answers = acquire_answer_table(answers, secret);
+        }
+        /* the client waits for the last response of a game before it starts the next one */
+        while (!SESSION_OVER(&session) && (r = transport->read(transport, buffer, sizeof buffer)) > 0) {
+            if (feed_session(&session, &sessions, buffer, (size_t)r) < 0) {
+                break;
+            }
+            /* sending may play requests which waited for the output buffer */
+            while (session.out_sent < session.out_len) {
+                size_t n = session.out_len - session.out_sent;
+
+                if (transport->write(transport, &session.out[session.out_sent], n) < 0 ||
+                    responses_sent(&session, &sessions, n) < 0) {
+                    r = -1;
+                    break;
+                }
+            }
+            if (r < 0) {
+                break;
+            }
+        }
+        end_session(&session, &sessions);
+        if (session.game.answers != NULL) {
+            release_answer_table(answers, session.game.answers);
+        }
+        if (r == 0 && session.game.round == 0) {
+            break;  /* the client is done */
+        }
+        record_game(&server->stats, &session.game);
+        if (r <= 0 && !SESSION_OVER(&session)) {
+            break;
+        }
+    }
+    close_inproc_transport(&server->transport);
+    destroy_session_context(&sessions);
+    destroy_answer_cache(answers);
+    return arg;
+}
+
+/**
+ * @brief Plays one game with the solver
+ * @param solver The solver
+ * @param transport The client's end of the channel
+ * @return The number of rounds if the game was won, 0 if it was lost, -1 if the server went away
+ */
+static int solve_game(struct solver *solver, struct transport *transport)
+{
+    uint8_t buffer[WIRE_HELLO_BYTES + REQUEST_BYTES];
+
+    start_solving(solver);
+    if (WIRE_HELLO_BYTES > 0) {
+        put_wire_hello(buffer);
+        if (transport->write(transport, buffer, WIRE_HELLO_BYTES) < 0 ||
+            read_exactly(transport, buffer, WIRE_HELLO_BYTES) < 0 || !wire_hello_ok(buffer)) {
+            return -1;
+        }
+    }
+    for (int round = 1; ; round++) {
+        const uint8_t *colors = next_guess(solver);
+        mm_response_t response;
+
+        if (colors == NULL) {
+            return 0;   /* no code gives these responses, cannot happen with a correct server */
+        }
+        put_request(buffer, make_request(encode_code(colors)));
+        if (transport->write(transport, buffer, REQUEST_BYTES) < 0 ||
+            read_exactly(transport, buffer, RESPONSE_BYTES) < 0) {
+            return -1;
+        }
+        response = get_response(buffer);
+        if (RED_OF(response) == SLOTS) {
+            return round;
+        }
+        if (response & (1 << PARITY_ERR_BIT | 1 << GAME_LOST_ERR_BIT)) {
+            return 0;
+        }
+        add_response(solver, RED_OF(response), WHITE_OF(response));
+    }
+}
+
+/**
+ * @brief Parses a positive number or bails out
+ */
+static long parse_number(const char *arg, const char *name, long max)
+{
+    char *endptr;
+    long value;
+
+    errno = 0;
+    value = strtol(arg, &endptr, 10);
+    if (errno != 0 || endptr == arg || *endptr != '\0' || value < 1 || value > max) {
+        errno = 0;
+        bail_out(EXIT_FAILURE, "<%s> has to be between 1 and %ld", name, max);
+    }
+    return value;
+}
+
+/**
+ * @brief Program entry point
+ * @param argc The argument counter
+ * @param argv The argument vector
+ * @return EXIT_SUCCESS if every game was won, EXIT_FAILURE otherwise
+ */
+int main(int argc, char **argv)
+{
+    static struct inproc_channel channel;
+    static struct server server;
+    struct inproc_transport client;
+    struct solver solver;
+    long games = 10000, seed = 1;
+    unsigned long won = 0, lost = 0, rounds = 0;
+    int c, kernel;
+
+    if (argc > 0) {
+        progname = argv[0];
+    }
+    while ( (c = getopt(argc, argv, "g:s:k:")) != -1 ) {
+        switch (c) {
+        case 'g': /* Anzahl der Spiele */
+            games = parse_number(optarg, "games", 1000000000L);
+            break;
+        case 's': /* Startwert der Geheimcodes */
+            seed = parse_number(optarg, "seed", 1000000000L);
+            break;
+        case 'k': /* Kernel fuer die Markierungen */
+            for (kernel = 0; kernel < MARKS_KERNELS; kernel++) {
+                if (strcmp(optarg, marks_kernel_name((enum marks_kernel)kernel)) == 0) {
+                    break;
+                }
+            }
+            if (select_marks_kernel((enum marks_kernel)kernel) < 0) {
+                bail_out(EXIT_FAILURE, "kernel %s", optarg);
+            }
+            break;
+        default:  /* ungueltiges Argument */
+            bail_out(EXIT_FAILURE, USAGE, progname);
+        }
+    }
+    if (optind != argc) {
+        bail_out(EXIT_FAILURE, USAGE, progname);
+    }
+    if (create_solver(&solver) < 0) {
+        bail_out(EXIT_FAILURE, "create_solver");
+    }
+    random_secrets(&server.secrets, (uint64_t)seed);
+    open_inproc_channel(&channel, &client, &server.transport);
+    errno = pthread_create(&server.thread, NULL, run_server, &server);
+    if (errno != 0) {
+        bail_out(EXIT_FAILURE, "pthread_create");
+    }
+
+    uint64_t start = now_ns();
+    for (long i = 0; i < games; i++) {
+        int result = solve_game(&solver, &client.transport);
+
+        if (result < 0) {
+            errno = 0;
+            bail_out(EXIT_FAILURE, "the server went away in game %ld", i + 1);
+        }
+        if (result > 0) {
+            won++;
+            rounds += (unsigned long)result;
+        } else {
+            lost++;
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    close_inproc_transport(&client);
+    (void) pthread_join(server.thread, NULL);
+    destroy_solver(&solver);
+    release_secrets(&server.secrets);
+
+    (void) printf("%ld games of %d slots and %d colors with the %s kernel in %.2f s: %.0f games/s, %.0f rounds/s\n",
+        games, SLOTS, COLORS, marks_kernel_name(marks_kernel()), elapsed / 1e9, games / (elapsed / 1e9), (won > 0 ? rounds : 0) / (elapsed / 1e9));
+    (void) printf("per game: %.1f us, %.2f rounds when won\n", elapsed / 1e3 / games,
+        won > 0 ? (double)rounds / won : 0.0);
+    (void) printf("client: %lu won, %lu lost; server: %lu games, %lu won, %lu lost\n", won, lost,
+        server.stats.games, server.stats.results[EXIT_SUCCESS], server.stats.games - server.stats.results[EXIT_SUCCESS]);
+    return (lost == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
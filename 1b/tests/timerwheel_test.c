@@ -0,0 +1,222 @@
+/**
+ * @file timerwheel_test.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Checks that the timers of the timer wheel fire exactly on their tick.
+ * @details TEST_TIMERS timers are spread pseudo randomly over TEST_SPREAD ticks and every seventh of them is
+ * cancelled, half of those right away and the others halfway through, after they may have moved down a
+ * level. On top of that, timers whose delays straddle the boundaries of the levels, up to TIMER_MAX_DELAY,
+ * are scheduled at the start and at several ticks which are not aligned to the levels. The wheel is then
+ * advanced tick by tick: every timer not cancelled has to fire exactly once, on its tick, and a cancelled
+ * one never.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <errno.h>
+#include "../src/timerwheel.h"
+
+/* === Constants === */
+
+/** @brief Timers spread over the ticks */
+#define TEST_TIMERS (20000)
+
+/** @brief Ticks the timers are spread over */
+#define TEST_SPREAD (3000000)
+
+/** @brief The tick the wheel starts at, not aligned to any level */
+#define TEST_START (1000003)
+
+/** @brief Ticks at which the timers at the level boundaries are scheduled again, and the distance between */
+#define TEST_POINTS (8)
+#define TEST_POINT_DISTANCE (262147)
+
+/** @brief Delays at the level boundaries, scheduled at every point */
+static const uint64_t boundary_delays[] = {
+    0, 1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 262145, TIMER_MAX_DELAY - 1, TIMER_MAX_DELAY
+};
+#define BOUNDARY_TIMERS (sizeof boundary_delays / sizeof boundary_delays[0])
+
+
+/* === Type Definitions === */
+
+/** @brief A timer of the test */
+struct test_timer {
+    struct timer timer;
+    uint64_t due;           /**< the tick it has to fire on */
+    bool cancelled;         /**< it must not fire */
+    unsigned int fired;     /**< how often it fired */
+};
+
+
+/* === Global Variables === */
+
+/* Name of the program with default value */
+static const char *progname = "timerwheel_test";
+
+/* State of the pseudo random numbers */
+static uint64_t random_state = 0x9e3779b97f4a7c15ULL;
+
+/* The timers, the spread ones first */
+static struct test_timer timers[TEST_TIMERS + TEST_POINTS * BOUNDARY_TIMERS];
+
+
+/* === Implementations === */
+
+/**
+ * @brief terminate program on program error
+ * @param exitcode exit code
+ * @param fmt format string
+ */
+static void bail_out(int exitcode, const char *fmt, ...)
+{
+    va_list ap;
+
+    (void) fprintf(stderr, "%s: ", progname);
+    if (fmt != NULL) {
+        va_start(ap, fmt);
+        (void) vfprintf(stderr, fmt, ap);
+        va_end(ap);
+    }
+    if (errno != 0) {
+        (void) fprintf(stderr, ": %s", strerror(errno));
+    }
+    (void) fprintf(stderr, "\n");
+
+    exit(exitcode);
+}
+
+/**
+ * @brief Returns the next pseudo random number (xorshift64)
+ */
+static uint64_t next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+/**
+ * @brief Handler of the wheel, checks that the timer fires on its tick
+ * @param arg The tick being advanced to
+ */
+static void fire(struct timer *timer, void *arg)
+{
+    struct test_timer *t = (struct test_timer *)((char *)timer - offsetof(struct test_timer, timer));
+    uint64_t tick = *(const uint64_t *)arg;
+
+    errno = 0;
+    if (t->cancelled) {
+        bail_out(EXIT_FAILURE, "timer %td fired on tick %llu although it was cancelled", t - timers,
+            (unsigned long long)tick);
+    }
+    if (tick != t->due) {
+        bail_out(EXIT_FAILURE, "timer %td fired on tick %llu instead of %llu", t - timers,
+            (unsigned long long)tick, (unsigned long long)t->due);
+    }
+    if (timer_pending(timer)) {
+        bail_out(EXIT_FAILURE, "timer %td is still scheduled in its handler", t - timers);
+    }
+    t->fired++;
+}
+
+/**
+ * @brief Schedules the timers at the level boundaries
+ * @param wheel The wheel
+ * @param point Number of the point
+ * @param next_tick The next tick the wheel processes, the delays count from it
+ */
+static void schedule_boundaries(struct timer_wheel *wheel, unsigned int point, uint64_t next_tick)
+{
+    for (size_t i = 0; i < BOUNDARY_TIMERS; i++) {
+        struct test_timer *t = &timers[TEST_TIMERS + point * BOUNDARY_TIMERS + i];
+
+        t->due = next_tick + boundary_delays[i];
+        init_timer(&t->timer);
+        schedule_timer(wheel, &t->timer, t->due);
+    }
+}
+
+/**
+ * @brief Program entry point
+ * @param argc The argument counter
+ * @param argv The argument vector
+ * @return EXIT_SUCCESS if every timer fired as it should, EXIT_FAILURE otherwise
+ */
+int main(int argc, char **argv)
+{
+    static struct timer_wheel wheel;
+    uint64_t middle = TEST_START + TEST_SPREAD / 2, last = 0, tick;
+    size_t expected = 0, expired = 0;
+    unsigned int point = 1;
+
+    if (argc > 0) {
+        progname = argv[0];
+    }
+    if (argc != 1) {
+        errno = 0;
+        bail_out(EXIT_FAILURE, "Usage: %s", progname);
+    }
+
+    init_timer_wheel(&wheel, TEST_START);
+    for (size_t i = 0; i < TEST_TIMERS; i++) {
+        struct test_timer *t = &timers[i];
+
+        t->due = TEST_START + next_random() % TEST_SPREAD;
+        init_timer(&t->timer);
+        schedule_timer(&wheel, &t->timer, t->due);
+    }
+    /* half of the cancelled timers go right away, the others in the middle unless they are due before */
+    for (size_t i = 0; i < TEST_TIMERS; i += 7) {
+        timers[i].cancelled = true;
+        if (i % 14 == 0 || timers[i].due <= middle) {
+            cancel_timer(&wheel, &timers[i].timer);
+        }
+    }
+    schedule_boundaries(&wheel, 0, TEST_START);
+    for (size_t i = 0; i < sizeof timers / sizeof timers[0]; i++) {
+        if (!timers[i].cancelled) {
+            expected++;
+        }
+        if (timers[i].due > last) {
+            last = timers[i].due;
+        }
+    }
+    last += (TEST_POINTS - 1) * TEST_POINT_DISTANCE + 1;   /* the later points count from the tick after */
+
+    for (tick = TEST_START; tick <= last; tick++) {
+        expired += advance_timer_wheel(&wheel, tick, fire, &tick);
+        if (tick == middle) {
+            for (size_t i = 0; i < TEST_TIMERS; i += 7) {
+                cancel_timer(&wheel, &timers[i].timer);
+            }
+        }
+        if (point < TEST_POINTS && tick == TEST_START + point * TEST_POINT_DISTANCE) {
+            schedule_boundaries(&wheel, point, tick + 1);
+            point++;
+        }
+    }
+
+    for (size_t i = 0; i < sizeof timers / sizeof timers[0]; i++) {
+        if (timers[i].fired != (timers[i].cancelled ? 0 : 1)) {
+            errno = 0;
+            bail_out(EXIT_FAILURE, "timer %zu due on tick %llu fired %u times", i,
+                (unsigned long long)timers[i].due, timers[i].fired);
+        }
+    }
+    if (expired != expected || wheel.count != 0) {
+        errno = 0;
+        bail_out(EXIT_FAILURE, "%zu timers expired, %zu expected, %zu still scheduled", expired, expected,
+            wheel.count);
+    }
+    (void) printf("%zu timers fired on their tick up to tick %llu, %zu cancelled ones did not\n", expired,
+        (unsigned long long)last, sizeof timers / sizeof timers[0] - expected);
+    return EXIT_SUCCESS;
+}
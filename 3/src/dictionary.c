@@ -0,0 +1,204 @@
+/**
+ * @file dictionary.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Implementation of the dictionary module
+ **/
+
+#include "dictionary.h"
+#include "hangman-common.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* === Prototypes === */
+
+/**
+ * @brief Sets the section pointers of dict according to the header at the beginning of dict->image.
+ * @return 0 if the header, the sections and the words are consistent with dict->size, -1 otherwise.
+ */
+static int attach_sections(struct Dictionary *dict);
+
+
+/* === Implementations === */
+
+static int attach_sections(struct Dictionary *dict)
+{
+	const struct DictHeader *header = dict->image;
+	uint64_t size = dict->size;
+
+	if (header->byte_order != DICT_BYTE_ORDER || header->version != DICT_VERSION) {
+		return -1;
+	}
+	/* the sections follow each other without gaps, see build_dictionary */
+	if (header->count > UINT32_MAX ||
+	    header->meta_offset != sizeof *header ||
+	    header->offsets_offset != header->meta_offset + header->count * sizeof(struct DictWordMeta) ||
+	    header->words_offset != header->offsets_offset + header->count * sizeof(uint32_t) ||
+	    header->words_offset > size || header->words_size != size - header->words_offset) {
+		return -1;
+	}
+	/* every offset within the words points to a terminated string if the last byte is '\0' */
+	if (header->count > 0 && (header->words_size == 0 || ((const char *)dict->image)[size - 1] != '\0')) {
+		return -1;
+	}
+
+	const struct DictWordMeta *meta = (const struct DictWordMeta *)((const char *)dict->image + header->meta_offset);
+	const uint32_t *offsets = (const uint32_t *)((const char *)dict->image + header->offsets_offset);
+	const char *words = (const char *)dict->image + header->words_offset;
+
+	/* a game copies the word into a buffer of MAX_WORD_LENGTH, so its length has to be right and short enough */
+	for (uint64_t i = 0; i < header->count; i++) {
+		const char *end;
+
+		if (meta[i].length >= MAX_WORD_LENGTH || offsets[i] >= header->words_size ||
+		    (end = memchr(words + offsets[i], '\0', header->words_size - offsets[i])) == NULL ||
+		    (size_t)(end - (words + offsets[i])) != meta[i].length) {
+			return -1;
+		}
+	}
+
+	dict->count = (size_t)header->count;
+	dict->meta = meta;
+	dict->offsets = offsets;
+	dict->words = words;
+	dict->words_size = (size_t)header->words_size;
+	return 0;
+}
+
+int build_dictionary(char **words, size_t count, struct Dictionary *dict)
+{
+	struct DictHeader header;
+	size_t words_size = 0;
+
+	(void) memset(dict, 0, sizeof *dict);
+	for (size_t i = 0; i < count; i++) {
+		size_t length = strlen(words[i]);
+		if (length >= MAX_WORD_LENGTH) {
+			errno = EINVAL;
+			return -1;
+		}
+		words_size += length + 1;
+	}
+	if (words_size > UINT32_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	(void) memset(&header, 0, sizeof header);
+	(void) memcpy(header.magic, DICT_MAGIC, DICT_MAGIC_LENGTH);
+	header.byte_order = DICT_BYTE_ORDER;
+	header.version = DICT_VERSION;
+	header.count = count;
+	header.meta_offset = sizeof header;
+	header.offsets_offset = header.meta_offset + count * sizeof(struct DictWordMeta);
+	header.words_offset = header.offsets_offset + count * sizeof(uint32_t);
+	header.words_size = words_size;
+
+	dict->size = (size_t)(header.words_offset + words_size);
+	if ( (dict->image = calloc(1, dict->size)) == NULL) {
+		return -1;
+	}
+	(void) memcpy(dict->image, &header, sizeof header);
+
+	char *base = dict->image;
+	struct DictWordMeta *meta = (struct DictWordMeta *)(base + header.meta_offset);
+	uint32_t *offsets = (uint32_t *)(base + header.offsets_offset);
+	char *packed = base + header.words_offset;
+	uint32_t pos = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		uint32_t letters = 0;
+		uint8_t distinct = 0;
+		size_t length = 0;
+
+		for (const char *c = words[i]; *c != '\0'; c++, length++) {
+			if (*c >= 'A' && *c <= 'Z') {
+				uint32_t bit = 1u << (*c - 'A');
+				distinct += (letters & bit) == 0;
+				letters |= bit;
+			} else if (*c != ' ') {
+				release_dictionary(dict);
+				errno = EINVAL;
+				return -1;
+			}
+		}
+		meta[i].letters = letters;
+		meta[i].length = (uint8_t)length;
+		meta[i].distinct = distinct;
+		offsets[i] = pos;
+		(void) memcpy(packed + pos, words[i], length + 1);
+		pos += (uint32_t)length + 1;
+	}
+	return attach_sections(dict);
+}
+
+int map_dictionary(const char *path, struct Dictionary *dict)
+{
+	struct stat st;
+	char magic[DICT_MAGIC_LENGTH];
+	int fd;
+
+	(void) memset(dict, 0, sizeof *dict);
+	if ( (fd = open(path, O_RDONLY)) == -1) {
+		return -1;
+	}
+	if (fstat(fd, &st) == -1) {
+		(void) close(fd);
+		return -1;
+	}
+	/* anything not starting with the magic is left to the text reader */
+	if (!S_ISREG(st.st_mode) || (size_t)st.st_size < sizeof(struct DictHeader) ||
+	    pread(fd, magic, sizeof magic, 0) != sizeof magic || memcmp(magic, DICT_MAGIC, DICT_MAGIC_LENGTH) != 0) {
+		(void) close(fd);
+		return 1;
+	}
+
+	dict->size = (size_t)st.st_size;
+	dict->image = mmap(NULL, dict->size, PROT_READ, MAP_SHARED, fd, 0);
+	(void) close(fd);
+	if (dict->image == MAP_FAILED) {
+		dict->image = NULL;
+		return -1;
+	}
+	dict->mapped = true;
+	if (attach_sections(dict) != 0) {
+		release_dictionary(dict);
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+int write_dictionary(const struct Dictionary *dict, FILE *out)
+{
+	if (fwrite(dict->image, 1, dict->size, out) != dict->size) {
+		return -1;
+	}
+	return 0;
+}
+
+const char *dictionary_word(const struct Dictionary *dict, size_t index)
+{
+	uint32_t offset = dict->offsets[index];
+
+	return (offset < dict->words_size) ? dict->words + offset : NULL;
+}
+
+void release_dictionary(struct Dictionary *dict)
+{
+	if (dict->image != NULL) {
+		if (dict->mapped) {
+			(void) munmap(dict->image, dict->size);
+		} else {
+			free(dict->image);
+		}
+	}
+	(void) memset(dict, 0, sizeof *dict);
+}
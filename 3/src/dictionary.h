@@ -0,0 +1,110 @@
+/**
+ * @file dictionary.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Module for the compiled binary dictionary of hangman-server.
+ * @details A compiled dictionary is produced by hangman-dictc and mapped read-only by the server, so starting
+ * the server takes constant time and all running servers share the same page-cache pages. The file consists of
+ * a struct DictHeader, a struct DictWordMeta per word, the offsets of the words and finally the packed words,
+ * each in upper case and terminated by '\0'. All numbers are stored in host byte order.
+ **/
+
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* === Constants === */
+#define DICT_MAGIC ("HANGDICT")		/**< The first bytes of a compiled dictionary */
+#define DICT_MAGIC_LENGTH (8)		/**< Length of DICT_MAGIC without the '\0' */
+#define DICT_VERSION (1)			/**< Version of the format, stored in the header */
+#define DICT_BYTE_ORDER (0x01020304)	/**< Written as is to detect files of a machine with another byte order */
+
+/* === Structures === */
+
+/**
+ * @brief Header at the beginning of a compiled dictionary. The sections follow in the order of their offsets.
+ */
+struct DictHeader {
+	char magic[DICT_MAGIC_LENGTH];	/**< DICT_MAGIC */
+	uint32_t byte_order;			/**< DICT_BYTE_ORDER */
+	uint32_t version;				/**< DICT_VERSION */
+	uint64_t count;					/**< Number of words */
+	uint64_t meta_offset;			/**< File offset of the struct DictWordMeta array */
+	uint64_t offsets_offset;		/**< File offset of the uint32_t array of word offsets */
+	uint64_t words_offset;			/**< File offset of the packed words */
+	uint64_t words_size;			/**< Size of the packed words including their '\0' */
+};
+
+/**
+ * @brief Precomputed information about a word.
+ */
+struct DictWordMeta {
+	uint32_t letters;		/**< Bit i is set if the word contains the letter 'A' + i */
+	uint8_t length;			/**< Length of the word */
+	uint8_t distinct;		/**< Number of distinct letters of the word */
+	uint16_t reserved;		/**< Always 0 */
+};
+
+/**
+ * @brief A dictionary, either mapped from a compiled file or built in memory.
+ */
+struct Dictionary {
+	void *image;						/**< The whole dictionary in the file format */
+	size_t size;						/**< Size of image */
+	bool mapped;						/**< true if image is mapped, false if it is allocated */
+	size_t count;						/**< Number of words */
+	const struct DictWordMeta *meta;	/**< Metadata of every word */
+	const uint32_t *offsets;			/**< Offset of every word within words */
+	const char *words;					/**< The packed words */
+	size_t words_size;					/**< Size of words */
+};
+
+/* === Prototypes === */
+
+/**
+ * @brief Builds a dictionary in memory from a list of words.
+ * @param **words The words, consisting of upper case letters and blanks only, shorter than MAX_WORD_LENGTH.
+ * @param count The number of words.
+ * @param *dict The dictionary to initialize.
+ * @return 0 on success, -1 if a word is invalid (errno EINVAL) or memory is exhausted.
+ */
+int build_dictionary(char **words, size_t count, struct Dictionary *dict);
+
+/**
+ * @brief Maps a compiled dictionary read-only.
+ * @details The header, the bounds of the sections and the length of every word are checked, so that each
+ * word is terminated where its metadata says and is shorter than MAX_WORD_LENGTH.
+ * @param *path The path of the file.
+ * @param *dict The dictionary to initialize.
+ * @return 0 on success, 1 if the file is no compiled dictionary (e.g. a text dictionary), -1 on error.
+ */
+int map_dictionary(const char *path, struct Dictionary *dict);
+
+/**
+ * @brief Writes a dictionary in the compiled format.
+ * @param *dict The dictionary.
+ * @param *out The stream to write to.
+ * @return 0 on success, -1 otherwise.
+ */
+int write_dictionary(const struct Dictionary *dict, FILE *out);
+
+/**
+ * @brief Returns a word of the dictionary.
+ * @param *dict The dictionary.
+ * @param index The index of the word, less than dict->count.
+ * @return The word, NULL if the file is corrupt at this place.
+ */
+const char *dictionary_word(const struct Dictionary *dict, size_t index);
+
+/**
+ * @brief Unmaps respectively frees the dictionary.
+ * @param *dict The dictionary, afterwards empty.
+ */
+void release_dictionary(struct Dictionary *dict);
+
+#endif /* DICTIONARY_H */
@@ -0,0 +1,135 @@
+/**
+ * @file hangman-dictc.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Compiles a text dictionary into the binary format hangman-server maps at startup.
+ * @details The text is read exactly like hangman-server reads a text dictionary, so a compiled dictionary
+ * contains the same words in the same order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
+#include "bufferedFileRead.h"
+#include "dictionary.h"
+#include "hangman-common.h"
+
+/* === Global Variables === */
+
+/** @brief Name of the program */
+static const char *progname = "hangman-dictc"; /* default name */
+
+/** @brief the words read */
+static struct Buffer word_buffer;
+
+/** @brief the dictionary built from word_buffer */
+static struct Dictionary dictionary;
+
+/* === Prototypes === */
+
+/**
+ * @brief terminate program on program error
+ * @details global variables: progname, word_buffer, dictionary
+ * @param exitcode exit code
+ * @param fmt format string
+ */
+static void bail_out(int exitcode, const char *fmt, ...);
+
+/**
+ * @brief prints the usage and exits
+ */
+static void usage(void);
+
+
+/* === Implementations === */
+
+static void bail_out(int exitcode, const char *fmt, ...)
+{
+	va_list ap;
+
+	(void) fprintf(stderr, "%s: ", progname);
+	if (fmt != NULL) {
+		va_start(ap, fmt);
+		(void) vfprintf(stderr, fmt, ap);
+		va_end(ap);
+	}
+	if (errno != 0) {
+		(void) fprintf(stderr, ": %s", strerror(errno));
+	}
+	(void) fprintf(stderr, "\n");
+
+	freeBuffer(&word_buffer);
+	release_dictionary(&dictionary);
+	exit(exitcode);
+}
+
+static void usage(void)
+{
+	(void) fprintf(stderr, "USAGE: %s [input_file] output_file\n", progname);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Program entry point
+ * @param argc The argument counter
+ * @param argv The argument vector
+ * @return EXIT_SUCCESS or aborts with exit(EXIT_FAILURE)
+ */
+int main(int argc, char *argv[])
+{
+	FILE *in = stdin;
+	FILE *out;
+	char *output;
+
+	if (argc > 0) {
+		progname = argv[0];
+	}
+
+	int c;
+	while ( (c = getopt(argc, argv, "")) != -1 ) {
+		switch(c) {
+			case '?': /* ungueltiges Argument */
+				usage();
+			default:  /* unmöglich */
+				assert(0);
+		}
+	}
+	if (argc - optind < 1 || argc - optind > 2) {
+		usage();
+	}
+	output = argv[argc - 1];
+
+	if (argc - optind == 2 && (in = fopen(argv[optind], "r")) == NULL) {
+		bail_out(EXIT_FAILURE, "fopen failed on file %s", argv[optind]);
+	}
+	if (readFile(in, &word_buffer, MAX_WORD_LENGTH, READ_LETTERS) != 0) {
+		bail_out(EXIT_FAILURE, "Error while reading the dictionary");
+	}
+	if (in != stdin) {
+		(void) fclose(in);
+	}
+
+	if (build_dictionary(word_buffer.content, (size_t)word_buffer.length, &dictionary) != 0) {
+		bail_out(EXIT_FAILURE, "Building the dictionary failed");
+	}
+	if ( (out = fopen(output, "w")) == NULL) {
+		bail_out(EXIT_FAILURE, "fopen failed on file %s", output);
+	}
+	if (write_dictionary(&dictionary, out) != 0) {
+		(void) fclose(out);
+		bail_out(EXIT_FAILURE, "Writing %s failed", output);
+	}
+	if (fclose(out) != 0) {
+		bail_out(EXIT_FAILURE, "fclose failed on file %s", output);
+	}
+	(void) printf("%d words written to %s\n", word_buffer.length, output);
+
+	freeBuffer(&word_buffer);
+	release_dictionary(&dictionary);
+	return EXIT_SUCCESS;
+}
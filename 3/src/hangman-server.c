@@ -5,10 +5,14 @@
  * 
  * @brief This module behaves as a server in the hangman game. Clients can connect via shared memory. Synchronization via semaphores.
  * For detailed desctiption please refer to "hangman_td.pdf"
+ * The dictionary is either a text file or a dictionary compiled by hangman-dictc, which is mapped read-only.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/mman.h>
 #include <signal.h>
@@ -20,6 +24,7 @@
 #include <semaphore.h>
 #include <time.h>
 #include "bufferedFileRead.h"
+#include "dictionary.h"
 #include "hangman-common.h"
 
 /* === Structures and Enumerations === */
@@ -28,7 +33,8 @@
  * @brief Structure representing a game
  */
 struct Game {
-	char *secret_word; 						/**< Pointer to the secret word of the game */
+	const char *secret_word; 				/**< Pointer to the secret word of the game */
+	uint32_t letters;						/**< The letters of the secret word, see struct DictWordMeta */
 	char obscured_word[MAX_WORD_LENGTH];	/**< A buffer storing the current partly unobscured version of the secret word */
 	enum GameStatus status;					/**< Indicating in which state the game is */
 	unsigned int errors;					/**< Counter for the number of errors in the game */
@@ -48,7 +54,7 @@ struct Client {
  * @brief Structure representing a linked list of words
  */
 struct WordNode {
-	char *word;					/**< A pointer to the stored string */
+	const char *word;			/**< A pointer to the stored string */
 	struct WordNode *next;		/**< The next WordNode in the linked list or NULL, if there is no such */
 };
 
@@ -57,9 +63,12 @@ struct WordNode {
 /** @brief Name of the program */
 static const char *progname = "hangman-server"; /* default name */
 
-/** @brief word buffer */
+/** @brief word buffer of a text dictionary */
 static struct Buffer word_buffer;
 
+/** @brief the words for the games */
+static struct Dictionary dictionary;
+
 /** @brief Signal indicator, gets set to 1 on SIGINT or SIGTERM */
 volatile sig_atomic_t caught_sig = 0;
 
@@ -85,7 +94,7 @@ static sem_t *ret_sem;
 
 /**
  * @brief starts a new game for a given client i.e. decides upon a new word and resets all the necessary variables
- * @details global variables: word_buffer
+ * @details global variables: dictionary
  * @param *client pointer to the struct Client who wants a new game
  */
 static void new_game(struct Client *client);
@@ -103,7 +112,7 @@ static void calculate_results(struct Client *client, char try);
  * @param *word pointer to the word that shall be tested
  * @return true, if the word is inside the list, false otherwise
  */
-static bool contains(struct WordNode *node, char *word);
+static bool contains(struct WordNode *node, const char *word);
 
 /**
  * @brief Signal handler
@@ -122,7 +131,7 @@ static void bail_out(int exitcode, const char *fmt, ...);
 
 /**
  * @brief Free allocated resources and inform clients via shared memory about shutdown
- * @details global variables: word_buffer, clients, semaphores_set, srv_sem, clt_sem, ret_sem
+ * @details global variables: word_buffer, dictionary, clients, semaphores_set, srv_sem, clt_sem, ret_sem
  */
 static void free_resources(void);
 
@@ -169,6 +178,7 @@ static void free_resources(void)
 	if (shared != NULL) {
 		shared->terminate = true;
 	    freeBuffer(&word_buffer);
+	    release_dictionary(&dictionary);
 		free_clients();
 		
 		if (munmap(shared, sizeof *shared) == -1) {
@@ -196,20 +206,27 @@ static void signal_handler(int sig)
 static void new_game(struct Client *client)
 {
 	srand(time(NULL));
-	unsigned int pos = rand() % word_buffer.length;
+	unsigned int pos = rand() % dictionary.count;
 	unsigned int i = 0;
+	const char *word;
 	
-	while (contains(client->used_words, word_buffer.content[pos])) {
-		pos = (pos + 1) % word_buffer.length;
-		if (i >= word_buffer.length) {
+	while ( (word = dictionary_word(&dictionary, pos)) != NULL && contains(client->used_words, word)) {
+		pos = (pos + 1) % dictionary.count;
+		if (i >= dictionary.count) {
 			client->current_game.status = Impossible;
 			return;
 		}
 		i++;
 	}
 	
+	if (word == NULL) {
+		errno = 0;
+		bail_out(EXIT_FAILURE, "The dictionary is corrupt at word %u", pos);
+	}
+	
 	(void) memset(&client->current_game, 0, sizeof (struct Game));
-	client->current_game.secret_word = word_buffer.content[pos];
+	client->current_game.secret_word = word;
+	client->current_game.letters = dictionary.meta[pos].letters;
 	client->current_game.status = Open;
 	
 	/* add the selected word to the client's word list so that he won't get it again */
@@ -217,7 +234,7 @@ static void new_game(struct Client *client)
 	if (used_word == NULL) {
 		bail_out(EXIT_FAILURE, "malloc while creating a WordNode");
 	}
-	used_word->word = word_buffer.content[pos];
+	used_word->word = word;
 	used_word->next = client->used_words;
 	client->used_words = used_word;
 	
@@ -230,7 +247,7 @@ static void new_game(struct Client *client)
 			client->current_game.obscured_word[i] = '_';
 		}
 	}
-	client->current_game.obscured_word[i+1] = '\0';
+	client->current_game.obscured_word[i] = '\0';
 }
 
 static void free_words(struct Client *client)
@@ -261,7 +278,7 @@ static void free_clients()
 	}
 }
 
-static bool contains(struct WordNode *node, char *word)
+static bool contains(struct WordNode *node, const char *word)
 {
 	for (; node != NULL; node = node->next) {
 		if (strncmp(node->word, word, MAX_WORD_LENGTH) == 0) {
@@ -276,6 +293,16 @@ static void calculate_results(struct Client *client, char try)
 	bool error = true;
 	bool won = true;
 	
+	/* a letter which does not occur in the word is an error without looking at the word */
+	if (try >= 'A' && try <= 'Z' && (client->current_game.letters & (1u << (try - 'A'))) == 0) {
+		client->current_game.errors++;
+		if (client->current_game.errors >= MAX_ERROR) {
+			client->current_game.status = Lost;
+			(void) strncpy(client->current_game.obscured_word, client->current_game.secret_word, MAX_WORD_LENGTH);
+		}
+		return;
+	}
+	
 	/* unobscure secret string */
 	size_t length = strlen(client->current_game.secret_word/*, MAX_WORD_LENGTH*/);
 	for (size_t i = 0; i < length; i++) {
@@ -349,23 +376,30 @@ int main(int argc, char *argv[])
 		DEBUG("Reading game dictionary ... ");
 		FILE *f;
 		char *path = argv[1];
-			
-		if( (f = fopen(path, "r")) == NULL ) {
-	   		bail_out(EXIT_FAILURE, "fopen failed on file %s", path);
+		
+		/* a compiled dictionary is only mapped, its pages are shared with other servers */
+		int mapped = map_dictionary(path, &dictionary);
+		if (mapped == -1) {
+			bail_out(EXIT_FAILURE, "Could not map the compiled dictionary %s", path);
+		}
+		if (mapped == 1) {
+			if( (f = fopen(path, "r")) == NULL ) {
+		   		bail_out(EXIT_FAILURE, "fopen failed on file %s", path);
+			}
+			if ( readFile(f, &word_buffer, MAX_WORD_LENGTH, READ_LETTERS) != 0) {
+				(void) fclose(f);
+				bail_out(EXIT_FAILURE, "Error while reading file %s", path);
+			};
+			if (fclose(f) != 0) { 
+				bail_out(EXIT_FAILURE, "fclose failed on file %s", path);
+			}
 		}
-		if ( readFile(f, &word_buffer, MAX_WORD_LENGTH, false) != 0) {
-			(void) fclose(f);
-			bail_out(EXIT_FAILURE, "Error while reading file %s", path);
-		};
-		if (fclose(f) != 0) { 
-			bail_out(EXIT_FAILURE, "fclose failed on file %s", path);
-		}	
 		DEBUG("done\n");
 		
 	} else {	/* there are no files --> read from stdin */
 		(void) printf("Please enter the game dictionary and finish the step with EOF\n");
 		
-		if ( readFile(stdin, &word_buffer, MAX_WORD_LENGTH, false) != 0) {
+		if ( readFile(stdin, &word_buffer, MAX_WORD_LENGTH, READ_LETTERS) != 0) {
 			if (caught_sig) {
 				DEBUG("Caught signal, shutting down\n");
 				free_resources();
@@ -377,6 +411,18 @@ int main(int argc, char *argv[])
 		(void) printf("Successfully read the dictionary. Ready.\n");
 	}
 	
+	/* a text dictionary is compiled in memory, so that the games always work on a struct Dictionary */
+	if (dictionary.image == NULL) {
+		if (build_dictionary(word_buffer.content, (size_t)word_buffer.length, &dictionary) != 0) {
+			bail_out(EXIT_FAILURE, "Building the dictionary failed");
+		}
+		freeBuffer(&word_buffer);
+	}
+	if (dictionary.count == 0) {
+		errno = 0;
+		bail_out(EXIT_FAILURE, "The dictionary contains no words");
+	}
+	
 	/******* Initialization of SHM *******/
 	DEBUG("SHM initialization\n");
 	
@@ -0,0 +1,361 @@
+/**
+ * @file bufferedFileRead.c
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 20.03.2015
+ *
+ * @brief Implementation of the bufferedFileRead module
+ **/
+
+#include "bufferedFileRead.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+/* === Constants === */
+
+/** @brief Character class of a byte which is removed from the line (READ_LETTERS) */
+#define CHAR_DROP (0)
+
+/** @brief Character class of a byte which terminates the line (READ_LETTERS) */
+#define CHAR_END (1)
+
+/** @brief Minimum size of an arena block */
+#define ARENA_BLOCK_SIZE (1 << 16)
+
+/** @brief Number of line pointers allocated for an empty buffer */
+#define INITIAL_CAPACITY (64)
+
+/* === Global Variables === */
+
+/**
+ * @brief Classes of the bytes in READ_LETTERS mode: CHAR_DROP, CHAR_END or the upper case character
+ * the byte is replaced with.
+ */
+static unsigned char letterTable[256];
+
+/** @brief set as soon as letterTable is filled */
+static volatile int letterTableReady = 0;
+
+/* === Prototypes === */
+
+/**
+ * @brief Fills letterTable.
+ */
+static void initLetterTable(void);
+
+/**
+ * @brief Reads the next block of the input.
+ * @return 1 if data was read, 0 at the end of the file, -1 on error.
+ */
+static int fillBlock(struct LineReader *reader);
+
+/**
+ * @brief Splits the input at '\n' like fgets(3) with a buffer of maxLineLength bytes.
+ * @return The number of lines processed, -1 on error.
+ */
+static long rawLines(struct LineReader *reader, size_t maxLines, LineCallback callback, void *arg);
+
+/**
+ * @brief Splits, filters and converts the input with letterTable.
+ * @return The number of lines processed, -1 on error.
+ */
+static long letterLines(struct LineReader *reader, size_t maxLines, LineCallback callback, void *arg);
+
+/**
+ * @brief Copies a line into the arena of the buffer and appends it to the content.
+ * @param *arg The buffer.
+ * @return 0 on success, -1 otherwise.
+ */
+static int appendLine(const char *line, size_t length, void *arg);
+
+
+/* === Implementations === */
+
+static void initLetterTable(void)
+{
+	unsigned char table[256];
+
+	/* the table is built locally and copied, so concurrent readers only ever see the final values */
+	memset(table, CHAR_DROP, sizeof table);
+	for (int c = 'A'; c <= 'Z'; c++) {
+		table[c] = (unsigned char)c;
+		table[c - 'A' + 'a'] = (unsigned char)c;
+	}
+	table[' '] = ' ';
+	table['\n'] = CHAR_END;
+	table['\r'] = CHAR_END;
+	memcpy(letterTable, table, sizeof table);
+	letterTableReady = 1;
+}
+
+int openReader(struct LineReader *reader, FILE *f, size_t maxLineLength, enum ReadMode mode)
+{
+	memset(reader, 0, sizeof *reader);
+	if (maxLineLength < 2) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (mode == READ_LETTERS && !letterTableReady) {
+		initLetterTable();
+	}
+	reader->f = f;
+	reader->mode = mode;
+	reader->maxLineLength = maxLineLength;
+	if ( (reader->block = malloc(READ_BLOCK_SIZE)) == NULL ||
+	     (reader->line = malloc(maxLineLength)) == NULL) {
+		closeReader(reader);
+		return -1;
+	}
+	return 0;
+}
+
+void closeReader(struct LineReader *reader)
+{
+	free(reader->block);
+	free(reader->line);
+	reader->block = NULL;
+	reader->line = NULL;
+}
+
+static int fillBlock(struct LineReader *reader)
+{
+	size_t n;
+
+	if (reader->eof) {
+		return 0;
+	}
+	if ( (n = fread(reader->block, 1, READ_BLOCK_SIZE, reader->f)) == 0) {
+		if (ferror(reader->f) != 0) {
+			return -1;
+		}
+		reader->eof = 1;
+		return 0;
+	}
+	reader->pos = 0;
+	reader->end = n;
+	return 1;
+}
+
+static long rawLines(struct LineReader *reader, size_t maxLines, LineCallback callback, void *arg)
+{
+	/* fgets stores at most maxLineLength - 1 bytes, the newline included */
+	size_t limit = reader->maxLineLength - 1;
+	long count = 0;
+
+	while ((size_t)count < maxLines) {
+		if (reader->pos == reader->end) {
+			int filled = fillBlock(reader);
+			if (filled < 0) {
+				return -1;
+			}
+			if (filled == 0) {
+				/* the last line has no newline */
+				if (reader->lineLength > 0) {
+					const char *nul = memchr(reader->line, '\0', reader->lineLength);
+					size_t length = (nul == NULL) ? reader->lineLength : (size_t)(nul - reader->line);
+					reader->lineLength = 0;
+					if (callback(reader->line, length, arg) != 0) {
+						return -1;
+					}
+					count++;
+				}
+				break;
+			}
+		}
+
+		const char *start = reader->block + reader->pos;
+		size_t available = reader->end - reader->pos;
+		size_t room = limit - reader->lineLength;
+		size_t scan = (available < room) ? available : room;
+		const char *nl = memchr(start, '\n', scan);
+		size_t length;
+
+		if (nl != NULL) {
+			length = (size_t)(nl - start);
+			reader->pos += length + 1;
+		} else if (scan == room) {
+			/* the line is split like fgets does */
+			length = scan;
+			reader->pos += length;
+		} else {
+			/* the line continues in the next block */
+			memcpy(reader->line + reader->lineLength, start, available);
+			reader->lineLength += available;
+			reader->pos = reader->end;
+			continue;
+		}
+
+		/* lines within the block are passed without copying them */
+		const char *line = start;
+		if (reader->lineLength > 0) {
+			memcpy(reader->line + reader->lineLength, start, length);
+			line = reader->line;
+			length += reader->lineLength;
+			reader->lineLength = 0;
+		}
+		/* like strlen(3) after fgets, a line ends at the first '\0' */
+		const char *nul = memchr(line, '\0', length);
+		if (nul != NULL) {
+			length = (size_t)(nul - line);
+		}
+		if (callback(line, length, arg) != 0) {
+			return -1;
+		}
+		count++;
+	}
+	return count;
+}
+
+static long letterLines(struct LineReader *reader, size_t maxLines, LineCallback callback, void *arg)
+{
+	char *line = reader->line;
+	size_t length = reader->lineLength;
+	long count = 0;
+
+	while ((size_t)count < maxLines) {
+		if (reader->pos == reader->end) {
+			int filled = fillBlock(reader);
+			if (filled < 0) {
+				return -1;
+			}
+			if (filled == 0) {
+				if (length > 0) {
+					reader->lineLength = 0;
+					if (callback(line, length, arg) != 0) {
+						return -1;
+					}
+					count++;
+				}
+				return count;
+			}
+		}
+
+		const unsigned char *p = (const unsigned char *)reader->block + reader->pos;
+		const unsigned char *stop = (const unsigned char *)reader->block + reader->end;
+
+		while (p < stop) {
+			unsigned char c = letterTable[*p++];
+
+			if (c > CHAR_END) {
+				/* one byte for the '\0' and one for the terminator have to remain */
+				if (length + 2 >= reader->maxLineLength) {
+					errno = ERANGE;
+					return -1;
+				}
+				line[length++] = (char)c;
+			} else if (c == CHAR_END && length > 0) {
+				if (callback(line, length, arg) != 0) {
+					return -1;
+				}
+				length = 0;
+				if ((size_t)++count == maxLines) {
+					break;
+				}
+			}
+		}
+		reader->pos = (size_t)(p - (const unsigned char *)reader->block);
+		reader->lineLength = length;
+	}
+	return count;
+}
+
+long forEachLine(struct LineReader *reader, size_t maxLines, LineCallback callback, void *arg)
+{
+	if (reader->mode == READ_LETTERS) {
+		return letterLines(reader, maxLines, callback, arg);
+	}
+	return rawLines(reader, maxLines, callback, arg);
+}
+
+static int appendLine(const char *line, size_t length, void *arg)
+{
+	struct Buffer *buffer = arg;
+	struct ArenaBlock *block = buffer->arena;
+
+	/* grow the array of line pointers geometrically */
+	if ((size_t)buffer->length == buffer->capacity) {
+		size_t capacity = (buffer->capacity == 0) ? INITIAL_CAPACITY : 2 * buffer->capacity;
+		char **grown = realloc(buffer->content, capacity * sizeof(char *));
+		if (grown == NULL) {
+			return -1;
+		}
+		buffer->content = grown;
+		buffer->capacity = capacity;
+	}
+	if (block == NULL || block->size - block->used < length + 1) {
+		size_t size = (length + 1 > ARENA_BLOCK_SIZE) ? length + 1 : ARENA_BLOCK_SIZE;
+		if ( (block = malloc(sizeof(struct ArenaBlock) + size)) == NULL) {
+			return -1;
+		}
+		block->next = buffer->arena;
+		block->size = size;
+		block->used = 0;
+		buffer->arena = block;
+	}
+
+	char *dest = block->data + block->used;
+	memcpy(dest, line, length);
+	dest[length] = '\0';
+	block->used += length + 1;
+	buffer->content[buffer->length++] = dest;
+	return 0;
+}
+
+int readLines(struct LineReader *reader, struct Buffer *buffer, size_t maxLines)
+{
+	return (forEachLine(reader, maxLines, appendLine, buffer) < 0) ? -1 : 0;
+}
+
+int readFile(FILE *f, struct Buffer *buffer, size_t maxLineLength, enum ReadMode mode)
+{
+	struct LineReader reader;
+	int ret;
+
+	if (openReader(&reader, f, maxLineLength, mode) != 0) {
+		return -1;
+	}
+	ret = readLines(&reader, buffer, SIZE_MAX);
+	closeReader(&reader);
+	return ret;
+}
+
+
+void printBuffer(struct Buffer *buffer, FILE *stream)
+{
+	for(int i=0; i < buffer->length; i++) {
+		(void) fprintf(stream, "%s\n", buffer->content[i]);
+	}
+}
+
+void clearBuffer(struct Buffer *buffer)
+{
+	struct ArenaBlock *block;
+
+	/* the first block is kept for the next lines */
+	if (buffer->arena != NULL) {
+		while ( (block = buffer->arena->next) != NULL) {
+			buffer->arena->next = block->next;
+			free(block);
+		}
+		buffer->arena->used = 0;
+	}
+	buffer->length = 0;
+}
+
+void freeBuffer(struct Buffer *buffer) {
+	struct ArenaBlock *block;
+
+	if (buffer != NULL) {
+		while ( (block = buffer->arena) != NULL) {
+			buffer->arena = block->next;
+			free(block);
+		}
+		free(buffer->content);
+		buffer->content = NULL;
+		buffer->length = 0;
+		buffer->capacity = 0;
+	}
+	return;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file bufferedFileRead.h
+ * @author Johannes Vass <e1327476@student.tuwien.ac.at>
+ * @date 20.03.2015
+ *
+ * @brief Module for reading the content of a file into a struct buffer defined in this header.
+ * @details This module is shared by mysort (1a) and hangman (3). The input is read in large blocks and split
+ * into lines with memchr respectively a character table which filters and transforms every byte in the same
+ * pass. The lines are either handed to a callback straight out of the block or copied into an arena owned by
+ * the buffer, so there is no allocation per line.
+ **/
+
+#ifndef BUFFEREDFILEREAD_H
+#define BUFFEREDFILEREAD_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/** @brief Size of the blocks the input is read in */
+#define READ_BLOCK_SIZE (1 << 16)
+
+/**
+ * @brief How the characters of the input are treated.
+ */
+enum ReadMode
+{
+	READ_RAW,	/**< Lines end at '\n' and are taken as they are, like with fgets(3). */
+	READ_LETTERS	/**< Lines end at '\n' or '\r', only letters and blanks are kept and
+			     converted to upper case, empty lines are skipped. */
+};
+
+/**
+ * @brief A block of the arena the lines of a buffer are stored in.
+ */
+struct ArenaBlock
+{
+	struct ArenaBlock *next;	/**< The previously filled block. */
+	size_t size;			/**< Usable size of data. */
+	size_t used;			/**< Number of bytes of data in use. */
+	char data[];			/**< The stored lines, each terminated by '\0'. */
+};
+
+/**
+ * @brief A structure to store lines of strings.
+ * @details A buffer initialized with {NULL, 0} is empty and ready to use.
+ */
+struct Buffer
+{
+	char **content;	/**< Pointer to the String array. */
+	int length;	/**< Can be used to keep track of the number of currently stored strings. */
+	size_t capacity;	/**< Number of entries allocated for content. */
+	struct ArenaBlock *arena;	/**< The storage of the lines, the current block first. */
+};
+
+/**
+ * @brief State of reading the lines of a file piece by piece.
+ */
+struct LineReader
+{
+	FILE *f;		/**< The file to read from. */
+	enum ReadMode mode;	/**< How the characters are treated. */
+	size_t maxLineLength;	/**< The maximum length of a line including the terminating '\0'. */
+	char *block;		/**< The block currently read. */
+	size_t pos;		/**< Position of the first unprocessed byte in block. */
+	size_t end;		/**< Number of valid bytes in block. */
+	char *line;		/**< A line which spans more than one block. */
+	size_t lineLength;	/**< Number of bytes in line. */
+	int eof;		/**< Set as soon as the end of the file is reached. */
+};
+
+/**
+ * @brief Called for every line read.
+ * @param *line The line, not terminated by '\0' and only valid during the call.
+ * @param length The length of the line.
+ * @param *arg The argument passed to forEachLine.
+ * @return 0 to continue, a value different from 0 to stop reading with an error.
+ */
+typedef int (*LineCallback)(const char *line, size_t length, void *arg);
+
+/**
+ * @brief Prepares reading the lines of f.
+ * @param *reader The reader to initialize.
+ * @param *f The already opened file to read from.
+ * @param maxLineLength The maximum length of a line including the terminating '\0'. In READ_RAW mode
+ * longer lines are split like fgets(3) does, in READ_LETTERS mode they are an error.
+ * @param mode How the characters are treated.
+ * @return A value different from 0 if an error occurs, 0 otherwise.
+ */
+int openReader(struct LineReader *reader, FILE *f, size_t maxLineLength, enum ReadMode mode);
+
+/**
+ * @brief Calls callback for at most maxLines lines of the reader.
+ * @param *reader The reader, see openReader.
+ * @param maxLines The maximum number of lines to process.
+ * @param callback The function to call for every line.
+ * @param *arg Passed on to callback.
+ * @return The number of lines processed (less than maxLines at the end of the file), -1 on error.
+ */
+long forEachLine(struct LineReader *reader, size_t maxLines, LineCallback callback, void *arg);
+
+/**
+ * @brief Reads at most maxLines lines of the reader into a struct buffer.
+ * @details Works like readFile, but stops after maxLines lines have been appended to the buffer, so that
+ * a file can be processed in pieces. The end of the file is reached when no line is appended anymore.
+ * @param *reader The reader, see openReader.
+ * @param *buffer A struct of type Buffer to store the data in.
+ * @param maxLines The maximum number of lines to read.
+ * @return A value different from 0 if an error occurs, 0 otherwise.
+ */
+int readLines(struct LineReader *reader, struct Buffer *buffer, size_t maxLines);
+
+/**
+ * @brief Frees the memory of a reader, the file itself is not closed.
+ * @param *reader The reader.
+ */
+void closeReader(struct LineReader *reader);
+
+/**
+ * @brief Reads the content of a FILE* into a struct buffer.
+ * @details The content of FILE* is read line by line and appended to the specified Buffer *,
+ * buffer->length gets incremented for every line.
+ * @param *f The already opened file to read from.
+ * @param *buffer A struct of type Buffer to store the data in.
+ * @param maxLineLength The maximum length of a line that can be read from the file
+ * @param mode How the characters are treated.
+ * @return A value different from 0 if an error (such as memory allocation or too long lines) occurs, 0 otherwise.
+ */
+int readFile(FILE *f, struct Buffer *buffer, size_t maxLineLength, enum ReadMode mode);
+
+/**
+ * @brief Removes all lines of a buffer, but keeps its memory for the next lines.
+ * @param *buffer The buffer to empty.
+ */
+void clearBuffer(struct Buffer *buffer);
+
+/**
+ * @brief Frees the allocated space of the content of a buffer, the struct itself is not freed.
+ * @details Afterwards the buffer is empty and may be used again.
+ * @param *buffer A pointer to the buffer, may be NULL.
+ * @return nothing
+ */
+void freeBuffer(struct Buffer *buffer);
+
+/**
+ * @brief Prints the given Buffer to the given stream. Lines are separated by '\n'
+ * @param *buffer the buffer
+ * @param *stream the stream to print to
+ */
+void printBuffer(struct Buffer *buffer, FILE *stream);
+
+#endif /* BUFFEREDFILEREAD_H */